@@ -0,0 +1,392 @@
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "audio_mixer.h"
+#include "trace.h"
+
+using namespace std;
+
+// Disparos aguardando a próxima mixagem (potência de 2)
+static const uint64_t AUDIO_TRIGGER_QUEUE = 64;
+
+// Frames somados por vez; pedidos maiores do dispositivo são mixados em partes, sem realocar na thread de áudio
+static const size_t AUDIO_MIX_CHUNK_FRAMES = 4096;
+
+/**
+ * Posição da fila de disparos. `sequence` indica de quem é a vez: igual à posição quando livre para
+ * escrita, posição + 1 quando preenchida (fila limitada de Vyukov, com um único consumidor).
+ */
+struct audio_trigger_slot {
+    atomic<uint64_t> sequence;
+    const audio_clip* clip;
+    int32_t gain;
+    int64_t trigger_ns;
+};
+
+struct audio_voice {
+    const audio_clip* clip = nullptr;
+    size_t position = 0;        // Próximo frame a tocar
+    int32_t gain = 0;           // Ganho em Q15
+    int64_t trigger_ns = 0;
+    uint64_t order = 0;         // Ordem de início, para escolher a voz mais antiga
+    bool reported = false;      // Latência já informada
+};
+
+struct audio_mixer {
+    int sample_rate;
+    int channels;
+    audio_voice* voices;
+    int max_voices;
+    uint64_t next_order = 0;
+    atomic<int> active{0};
+
+    audio_trigger_slot triggers[AUDIO_TRIGGER_QUEUE];
+    atomic<uint64_t> enqueue_position{0};
+    uint64_t dequeue_position = 0;
+
+    vector<int32_t> accumulator;
+    audio_latency_fn latency_hook = nullptr;
+    void* latency_user = nullptr;
+};
+
+
+static int64_t steady_now_ns() {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+static uint16_t read_u16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+
+static uint32_t read_u32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) |
+           (static_cast<uint32_t>(p[3]) << 24);
+}
+
+
+/**
+ * Lê uma amostra do WAV como float em [-1, 1).
+ */
+static float read_sample(const uint8_t* p, int bits, bool is_float) {
+    if (is_float) {
+        float value;
+        memcpy(&value, p, sizeof(value));
+        return value;
+    }
+    switch (bits) {
+        case 8:
+            return (static_cast<int>(p[0]) - 128) / 128.0f;
+        case 16:
+            return static_cast<int16_t>(read_u16(p)) / 32768.0f;
+        case 24:
+            return static_cast<int32_t>((static_cast<uint32_t>(p[0]) << 8) | (static_cast<uint32_t>(p[1]) << 16) |
+                                        (static_cast<uint32_t>(p[2]) << 24)) /
+                   2147483648.0f;
+        default:
+            return static_cast<int32_t>(read_u32(p)) / 2147483648.0f;
+    }
+}
+
+
+bool audio_clip_decode_wav(const uint8_t* data, size_t length, int sample_rate, int channels, audio_clip* clip) {
+    memset(clip, 0, sizeof(*clip));
+    if (length < 12 || memcmp(data, "RIFF", 4) != 0 || memcmp(data + 8, "WAVE", 4) != 0 || sample_rate <= 0 ||
+        channels < 1 || channels > 2) {
+        cerr << "Arquivo WAV inválido" << endl;
+        return false;
+    }
+
+    // Percorre os chunks (fmt, data e outros, como bext, que são ignorados)
+    const uint8_t* format = nullptr;
+    size_t format_size = 0;
+    const uint8_t* pcm = nullptr;
+    size_t pcm_size = 0;
+    size_t offset = 12;
+    while (offset + 8 <= length) {
+        const uint8_t* chunk = data + offset;
+        size_t size = read_u32(chunk + 4);
+        size_t available = length - offset - 8;
+        if (memcmp(chunk, "fmt ", 4) == 0 && size <= available) {
+            format = chunk + 8;
+            format_size = size;
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            // Gravadores interrompidos deixam o tamanho do chunk maior que o arquivo
+            pcm = chunk + 8;
+            pcm_size = size < available ? size : available;
+        }
+        offset += 8 + size + (size & 1);
+    }
+    if (!format || format_size < 16 || !pcm) {
+        cerr << "Arquivo WAV sem os chunks fmt/data" << endl;
+        return false;
+    }
+
+    unsigned tag = read_u16(format);
+    if (tag == 0xfffe && format_size >= 26) {
+        // WAVE_FORMAT_EXTENSIBLE: o formato real está no início do GUID do subformato
+        tag = read_u16(format + 24);
+    }
+    int source_channels = read_u16(format + 2);
+    int source_rate = static_cast<int>(read_u32(format + 4));
+    int bits = read_u16(format + 14);
+    bool is_float = tag == 3;
+    if (!((tag == 1 && (bits == 8 || bits == 16 || bits == 24 || bits == 32)) || (is_float && bits == 32)) ||
+        source_channels < 1 || source_rate <= 0) {
+        cerr << "Formato WAV não suportado (formato " << tag << ", " << bits << " bits)" << endl;
+        return false;
+    }
+
+    size_t bytes_per_sample = static_cast<size_t>(bits / 8);
+    size_t source_stride = bytes_per_sample * static_cast<size_t>(source_channels);
+    size_t source_frames = pcm_size / source_stride;
+    if (source_frames == 0) {
+        cerr << "Arquivo WAV sem amostras" << endl;
+        return false;
+    }
+
+    size_t frames = static_cast<size_t>(static_cast<double>(source_frames) * sample_rate / source_rate);
+    if (frames == 0) {
+        frames = 1;
+    }
+    int16_t* samples = static_cast<int16_t*>(malloc(frames * static_cast<size_t>(channels) * sizeof(int16_t)));
+    if (!samples) {
+        cerr << "Erro de alocação ao decodificar WAV" << endl;
+        return false;
+    }
+
+    // Valor de um canal de saída em um frame de origem (duplicando mono ou somando estéreo)
+    auto source_value = [&](size_t frame, int channel) {
+        const uint8_t* base = pcm + frame * source_stride;
+        if (channels == 1 && source_channels > 1) {
+            float sum = 0.0f;
+            for (int c = 0; c < source_channels; c++) {
+                sum += read_sample(base + c * bytes_per_sample, bits, is_float);
+            }
+            return sum / source_channels;
+        }
+        int source_channel = channel < source_channels ? channel : source_channels - 1;
+        return read_sample(base + source_channel * bytes_per_sample, bits, is_float);
+    };
+
+    double step = static_cast<double>(source_rate) / sample_rate;
+    for (size_t i = 0; i < frames; i++) {
+        double position = i * step;
+        size_t index = static_cast<size_t>(position);
+        if (index >= source_frames) {
+            index = source_frames - 1;
+        }
+        size_t next = index + 1 < source_frames ? index + 1 : index;
+        float fraction = static_cast<float>(position - static_cast<double>(index));
+        for (int c = 0; c < channels; c++) {
+            float value = source_value(index, c);
+            if (next != index) {
+                value += (source_value(next, c) - value) * fraction;
+            }
+            long scaled = lrintf(value * 32767.0f);
+            samples[i * channels + c] = static_cast<int16_t>(scaled > 32767 ? 32767 : scaled < -32768 ? -32768 : scaled);
+        }
+    }
+
+    clip->samples = samples;
+    clip->frames = frames;
+    clip->channels = channels;
+    clip->sample_rate = sample_rate;
+    return true;
+}
+
+
+bool audio_clip_from_pcm(const int16_t* samples, size_t frames, int sample_rate, int channels, audio_clip* clip) {
+    memset(clip, 0, sizeof(*clip));
+    size_t count = frames * static_cast<size_t>(channels);
+    int16_t* copy = static_cast<int16_t*>(malloc((count ? count : 1) * sizeof(int16_t)));
+    if (!copy) {
+        return false;
+    }
+    memcpy(copy, samples, count * sizeof(int16_t));
+    clip->samples = copy;
+    clip->frames = frames;
+    clip->channels = channels;
+    clip->sample_rate = sample_rate;
+    return true;
+}
+
+
+void audio_clip_free(audio_clip* clip) {
+    free(clip->samples);
+    memset(clip, 0, sizeof(*clip));
+}
+
+
+audio_mixer* audio_mixer_create(int sample_rate, int channels, int max_voices) {
+    if (sample_rate <= 0 || channels < 1 || max_voices < 1) {
+        return nullptr;
+    }
+    audio_mixer* mixer = new audio_mixer;
+    mixer->sample_rate = sample_rate;
+    mixer->channels = channels;
+    mixer->max_voices = max_voices;
+    mixer->voices = new audio_voice[max_voices];
+    for (uint64_t i = 0; i < AUDIO_TRIGGER_QUEUE; i++) {
+        mixer->triggers[i].sequence.store(i, memory_order_relaxed);
+    }
+    mixer->accumulator.resize(AUDIO_MIX_CHUNK_FRAMES * static_cast<size_t>(channels));
+    return mixer;
+}
+
+
+void audio_mixer_destroy(audio_mixer* mixer) {
+    if (mixer) {
+        delete[] mixer->voices;
+        delete mixer;
+    }
+}
+
+
+void audio_mixer_set_latency_hook(audio_mixer* mixer, audio_latency_fn hook, void* user) {
+    mixer->latency_hook = hook;
+    mixer->latency_user = user;
+}
+
+
+bool audio_mixer_trigger(audio_mixer* mixer, const audio_clip* clip, float gain) {
+    if (!clip || !clip->samples || clip->channels != mixer->channels || clip->sample_rate != mixer->sample_rate) {
+        return false;
+    }
+    TRACE_INSTANT("audio_cue_trigger");
+    int64_t now = steady_now_ns();
+
+    uint64_t position = mixer->enqueue_position.load(memory_order_relaxed);
+    audio_trigger_slot* slot;
+    for (;;) {
+        slot = &mixer->triggers[position & (AUDIO_TRIGGER_QUEUE - 1)];
+        uint64_t sequence = slot->sequence.load(memory_order_acquire);
+        int64_t diff = static_cast<int64_t>(sequence - position);
+        if (diff == 0) {
+            if (mixer->enqueue_position.compare_exchange_weak(position, position + 1, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;
+        } else {
+            position = mixer->enqueue_position.load(memory_order_relaxed);
+        }
+    }
+
+    float clamped = gain < 0.0f ? 0.0f : gain > 1.0f ? 1.0f : gain;
+    slot->clip = clip;
+    slot->gain = static_cast<int32_t>(clamped * 32768.0f);
+    slot->trigger_ns = now;
+    slot->sequence.store(position + 1, memory_order_release);
+    return true;
+}
+
+
+/**
+ * Move os disparos pendentes para vozes livres; sem voz livre, interrompe a mais antiga.
+ */
+static void start_pending_voices(audio_mixer* mixer) {
+    for (;;) {
+        audio_trigger_slot* slot = &mixer->triggers[mixer->dequeue_position & (AUDIO_TRIGGER_QUEUE - 1)];
+        if (slot->sequence.load(memory_order_acquire) != mixer->dequeue_position + 1) {
+            return;
+        }
+
+        audio_voice* target = nullptr;
+        for (int i = 0; i < mixer->max_voices; i++) {
+            audio_voice* voice = &mixer->voices[i];
+            if (!voice->clip) {
+                target = voice;
+                break;
+            }
+            if (!target || voice->order < target->order) {
+                target = voice;
+            }
+        }
+        target->clip = slot->clip;
+        target->position = 0;
+        target->gain = slot->gain;
+        target->trigger_ns = slot->trigger_ns;
+        target->order = mixer->next_order++;
+        target->reported = false;
+
+        slot->sequence.store(mixer->dequeue_position + AUDIO_TRIGGER_QUEUE, memory_order_release);
+        mixer->dequeue_position++;
+    }
+}
+
+
+/**
+ * Mixa até AUDIO_MIX_CHUNK_FRAMES frames em `out` e avança as vozes.
+ */
+static void render_chunk(audio_mixer* mixer, int16_t* out, size_t frames, int64_t output_delay_ns) {
+    int channels = mixer->channels;
+    size_t count = frames * static_cast<size_t>(channels);
+    int32_t* mix = mixer->accumulator.data();
+    memset(mix, 0, count * sizeof(int32_t));
+
+    int64_t now = 0;
+    int active = 0;
+    for (int v = 0; v < mixer->max_voices; v++) {
+        audio_voice* voice = &mixer->voices[v];
+        if (!voice->clip) {
+            continue;
+        }
+        if (!voice->reported) {
+            voice->reported = true;
+            if (mixer->latency_hook) {
+                if (now == 0) {
+                    now = steady_now_ns();
+                }
+                audio_cue_latency latency{voice->clip, now - voice->trigger_ns, output_delay_ns};
+                mixer->latency_hook(mixer->latency_user, &latency);
+            }
+        }
+
+        size_t remaining = voice->clip->frames - voice->position;
+        size_t n = (remaining < frames ? remaining : frames) * static_cast<size_t>(channels);
+        const int16_t* samples = voice->clip->samples + voice->position * static_cast<size_t>(channels);
+        int32_t gain = voice->gain;
+        for (size_t i = 0; i < n; i++) {
+            mix[i] += (samples[i] * gain) >> 15;
+        }
+
+        voice->position += n / static_cast<size_t>(channels);
+        if (voice->position >= voice->clip->frames) {
+            voice->clip = nullptr;
+        } else {
+            active++;
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        int32_t value = mix[i];
+        out[i] = static_cast<int16_t>(value > 32767 ? 32767 : value < -32768 ? -32768 : value);
+    }
+    mixer->active.store(active, memory_order_relaxed);
+}
+
+
+void audio_mixer_render(audio_mixer* mixer, int16_t* out, size_t frames, int64_t output_delay_ns) {
+    start_pending_voices(mixer);
+
+    // As vozes novas começam no primeiro pedaço, onde a latência delas é informada
+    size_t channels = static_cast<size_t>(mixer->channels);
+    do {
+        size_t chunk = frames < AUDIO_MIX_CHUNK_FRAMES ? frames : AUDIO_MIX_CHUNK_FRAMES;
+        render_chunk(mixer, out, chunk, output_delay_ns);
+        out += chunk * channels;
+        frames -= chunk;
+    } while (frames > 0);
+}
+
+
+int audio_mixer_active_voices(const audio_mixer* mixer) {
+    return mixer->active.load(memory_order_relaxed);
+}
@@ -0,0 +1,97 @@
+#ifndef AUDIO_MIXER_H
+#define AUDIO_MIXER_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Mixer de efeitos sonoros curtos (cues) pré-carregados.
+ *
+ * Os sons são decodificados uma única vez para PCM de 16 bits intercalado, no formato do mixer
+ * (audio_clip). Disparar um som só enfileira uma referência ao clip; a thread de áudio soma as
+ * vozes ativas diretamente no buffer de saída em audio_mixer_render(). Vários disparos seguidos
+ * tocam sobrepostos, sem reabrir nem reposicionar nenhum arquivo.
+ *
+ * audio_mixer_trigger() pode ser chamada de qualquer thread, sem locks nem alocação;
+ * audio_mixer_render() deve ser chamada por uma única thread (a do dispositivo de saída).
+ */
+struct audio_mixer;
+
+/**
+ * Som decodificado: frames * channels amostras intercaladas, na taxa e no número de canais do mixer.
+ */
+struct audio_clip {
+    int16_t* samples;
+    size_t frames;
+    int channels;
+    int sample_rate;
+};
+
+/**
+ * Latência de um disparo, informada quando a primeira amostra da voz é escrita na saída.
+ * trigger_to_render_ns: do disparo até a mixagem da primeira amostra.
+ * output_delay_ns: tempo estimado até essa amostra ser tocada (áudio já entregue ao dispositivo
+ * e ainda não reproduzido, mais a posição da amostra no bloco).
+ */
+struct audio_cue_latency {
+    const audio_clip* clip;
+    int64_t trigger_to_render_ns;
+    int64_t output_delay_ns;
+};
+
+/**
+ * Chamado na thread de áudio; deve ser rápido e não bloquear.
+ */
+using audio_latency_fn = void (*)(void* user, const audio_cue_latency* latency);
+
+/**
+ * Decodifica um arquivo WAV PCM (8, 16, 24 ou 32 bits inteiros, ou 32 bits float; mono ou estéreo)
+ * para o formato pedido. Canais são duplicados ou somados, e a taxa é convertida por interpolação linear.
+ *
+ * @param data Conteúdo do arquivo
+ * @param length Tamanho do conteúdo
+ * @param clip Destino (liberar com audio_clip_free)
+ * @return true em caso de sucesso
+ */
+bool audio_clip_decode_wav(const uint8_t* data, size_t length, int sample_rate, int channels, audio_clip* clip);
+
+/**
+ * Cria um clip a partir de PCM de 16 bits já no formato de destino (copiado).
+ */
+bool audio_clip_from_pcm(const int16_t* samples, size_t frames, int sample_rate, int channels, audio_clip* clip);
+
+void audio_clip_free(audio_clip* clip);
+
+/**
+ * Cria um mixer com até `max_voices` sons simultâneos (o mais antigo é interrompido quando falta voz).
+ */
+audio_mixer* audio_mixer_create(int sample_rate, int channels, int max_voices);
+
+void audio_mixer_destroy(audio_mixer* mixer);
+
+/**
+ * Define o callback de latência (nullptr desativa). Chamar antes de iniciar a saída.
+ */
+void audio_mixer_set_latency_hook(audio_mixer* mixer, audio_latency_fn hook, void* user);
+
+/**
+ * Dispara um clip. O clip deve continuar vivo enquanto o mixer existir.
+ *
+ * @param gain Volume de 0 a 1
+ * @return false se a fila de disparos estiver cheia ou o clip tiver outro formato
+ */
+bool audio_mixer_trigger(audio_mixer* mixer, const audio_clip* clip, float gain);
+
+/**
+ * Gera `frames` frames de saída (soma das vozes ativas, com saturação) e avança as vozes.
+ *
+ * @param output_delay_ns Áudio já entregue ao dispositivo e ainda não tocado, usado na medição de latência
+ */
+void audio_mixer_render(audio_mixer* mixer, int16_t* out, size_t frames, int64_t output_delay_ns);
+
+/**
+ * Quantidade de vozes tocando após o último render.
+ */
+int audio_mixer_active_voices(const audio_mixer* mixer);
+
+#endif
@@ -1,80 +1,247 @@
 #include <iostream>
-#include <dlfcn.h>
+#include <atomic>
+#include <mutex>
+#include <string>
 #include <cstring>
 #include <ctime>
-#include <curl/curl.h>
+
+#include "lib_gentexts.h"
+#include "lib_prng.h"
+#include "backend.h"
+#include "corpus_snapshot.h"
+#include "corpus_file.h"
+#include "plugin_registry.h"
+#include "packed_corpus.h"
+#include "http_client.h"
+#include "fetch_engine.h"
+#include "time_service.h"
+#include "trace.h"
+#include "scheduler.h"
+#include "metrics.h"
 
 using namespace std;
 
-static time_t start_time = 0;
+static int64_t start_ns = 0;      // Relógio monotônico: não anda para trás com ajustes de data
+
+// Semente base do backend. Cada thread deriva o seu próprio gerador a partir dela;
+// a geração é incrementada a cada nova semente para que as threads reinicializem seus estados.
+static atomic<uint64_t> base_seed{0};
+static atomic<uint64_t> seed_generation{0};
+static uint64_t thread_counter = 0;     // Próximo fluxo de sorteio (protegido por seed_mutex)
+static atomic<bool> seed_explicit{false};
+static mutex seed_mutex;                // Serializa a troca da semente e a inicialização dos geradores das threads
+
+// Os fluxos de sorteio das threads ficam na metade alta dos identificadores de prng_seed_stream(): a
+// libgentexts usa a semente diretamente e os fluxos baixos (blocos de geração, versões do corpus), e
+// os sorteios não devem repetir nenhuma dessas sequências
+static const uint64_t SAMPLING_STREAM_BASE = 1ULL << 63;
+
+// Gerador da thread e a geração de semente com a qual foi inicializado
+static thread_local prng_state thread_rng;
+static thread_local uint64_t thread_rng_generation = 0;
 
 /**
- * Função de callback utilizada pela libcurl para escrever dados recebidos de uma requisição HTTP.
- *
- * Parâmetros:
- * - contents: ponteiro para os dados recebidos
- * - size: tamanho de cada bloco de dados
- * - nmemb: número de blocos
- * - userp: ponteiro para o buffer de destino (passado via CURLOPT_WRITEDATA)
- *
- * Retorno:
- * - Retorna o total de bytes processados (size * nmemb), como esperado pela libcurl.
+ * Inicializa o gerador da thread chamadora com o próximo fluxo de sorteio da semente atual. Exige seed_mutex.
+ */
+static void seed_thread_rng_locked() {
+    prng_seed_stream(&thread_rng, base_seed.load(memory_order_relaxed), SAMPLING_STREAM_BASE + thread_counter++);
+    thread_rng_generation = seed_generation.load(memory_order_relaxed);
+}
+
+/**
+ * Publica uma nova semente base e invalida os geradores já inicializados nas threads.
+ * A thread chamadora recebe o primeiro fluxo de sorteio; as demais, os seguintes, na ordem em que sortearem.
+ * Exige seed_mutex.
  *
- * Observação: Aqui, os dados recebidos são concatenados ao buffer de destino usando strncat.
- * O buffer deve ser grande o suficiente para armazenar toda a resposta.
+ * @param seed Semente de 64 bits
  */
-size_t write_callback(void* contents, size_t size, size_t nmemb, void* userp) {
-    size_t total = size * nmemb;
-    strncat((char*)userp, (char*)contents, total);
-    return total;
+static void apply_seed_locked(uint64_t seed) {
+    base_seed.store(seed, memory_order_relaxed);
+    thread_counter = 0;
+    seed_generation.fetch_add(1, memory_order_release);
+    seed_thread_rng_locked();
 }
 
+// Métricas exportadas pelo backend (metrics.h). Nos sorteios, só contadores: a gravação fica no bloco da
+// thread e não lê o relógio
+static const metric_counter metric_sampled_copy =
+    metrics_counter("gentexts_texts_sampled_total{api=\"copy\"}", "Textos sorteados, por função de sorteio");
+static const metric_counter metric_sampled_into = metrics_counter("gentexts_texts_sampled_total{api=\"into\"}", nullptr);
+static const metric_counter metric_sampled_view = metrics_counter("gentexts_texts_sampled_total{api=\"view\"}", nullptr);
+static const metric_counter metric_sampled_batch = metrics_counter("gentexts_texts_sampled_total{api=\"batch\"}", nullptr);
+static const metric_counter metric_sampled_indices =
+    metrics_counter("gentexts_texts_sampled_total{api=\"indices\"}", nullptr);
+static const metric_counter metric_sample_failures =
+    metrics_counter("gentexts_sample_failures_total", "Sorteios sem resultado (corpus indisponível ou compactado)");
+static const metric_counter metric_text_allocations =
+    metrics_counter("gentexts_text_allocations_total", "Alocações de get_random_text()");
+static const metric_counter metric_text_allocated_bytes =
+    metrics_counter("gentexts_text_allocated_bytes_total", "Bytes alocados por get_random_text()");
+static const metric_histogram metric_text_allocation_size =
+    metrics_histogram("gentexts_text_allocation_bytes", "Tamanho das alocações de get_random_text()");
+
+static const metric_histogram metric_worldtime_sync = metrics_histogram(
+    "gentexts_worldtime_request_seconds{mode=\"sync\"}", "Duração das requisições à WorldTimeAPI", 1e-9);
+static const metric_histogram metric_worldtime_async =
+    metrics_histogram("gentexts_worldtime_request_seconds{mode=\"async\"}", nullptr, 1e-9);
+static const metric_counter metric_worldtime_ok =
+    metrics_counter("gentexts_worldtime_requests_total{result=\"ok\"}", "Requisições à WorldTimeAPI, por resultado");
+static const metric_counter metric_worldtime_error =
+    metrics_counter("gentexts_worldtime_requests_total{result=\"error\"}", nullptr);
+
+static const metric_histogram metric_corpus_build =
+    metrics_histogram("gentexts_corpus_build_seconds", "Duração da geração (e compactação) de cada corpus", 1e-9);
+static const metric_counter metric_corpus_builds_ok =
+    metrics_counter("gentexts_corpus_builds_total{result=\"ok\"}", "Gerações de corpus, por resultado");
+static const metric_counter metric_corpus_builds_error =
+    metrics_counter("gentexts_corpus_builds_total{result=\"error\"}", nullptr);
+static const metric_counter metric_corpus_allocations = metrics_counter(
+    "gentexts_corpus_allocations_total", "Blocos alocados para os corpora gerados (tabelas e arena ou bitstream)");
+static const metric_counter metric_corpus_allocated_bytes =
+    metrics_counter("gentexts_corpus_allocated_bytes_total", "Bytes alocados para os corpora gerados");
+static const metric_gauge metric_corpus_bytes =
+    metrics_gauge("gentexts_corpus_bytes", "Memória ocupada pelo corpus publicado (estrutura, tabelas e textos)");
+static const metric_gauge metric_corpus_texts = metrics_gauge("gentexts_corpus_texts", "Textos no corpus publicado");
+static const metric_gauge metric_corpus_version = metrics_gauge("gentexts_corpus_version", "Versão do corpus publicado");
+static const metric_histogram metric_cleanup =
+    metrics_histogram("gentexts_cleanup_seconds", "Duração de backend_cleanup(), incluindo a espera pelos leitores", 1e-9);
+
+// URL consultada por get_worldtime_json() (configurável para apontar para um servidor local)
+static mutex worldtime_mutex;
+static string worldtime_url = "http://worldtimeapi.org/api/timezone/America/Manaus";
+
+// Tempo máximo de uma consulta à API de horário: sem rede, a chamada falha em vez de esperar indefinidamente
+static const long WORLDTIME_TIMEOUT_MS = 5000;
+
 
 /**
  * Realiza uma requisição HTTP GET para obter o horário atual de Manaus em formato JSON.
- * Utiliza a biblioteca libcurl para realizar a comunicação.
+ * Utiliza o cliente HTTP do backend (http_client.h), baseado na libcurl.
  *
  * Passos:
- * 1. Inicializa o objeto CURL com curl_easy_init().
- * 2. Define a URL de destino usando CURLOPT_URL.
- * 3. Define a função de callback para escrita dos dados recebidos (CURLOPT_WRITEFUNCTION).
- * 4. Define o buffer de destino para os dados recebidos (CURLOPT_WRITEDATA).
- * 5. Adiciona cabeçalhos HTTP (Accept e User-Agent) usando curl_slist_append e CURLOPT_HTTPHEADER.
- * 6. Executa a requisição com curl_easy_perform().
- * 7. Em caso de erro, exibe mensagem e retorna nullptr.
- * 8. Libera recursos e retorna uma cópia da resposta recebida.
+ * 1. Obtém o handle CURL da thread chamadora, criado uma única vez e reutilizado (keep-alive).
+ * 2. Recebe a resposta em um buffer crescente, sem limite fixo de tamanho.
+ * 3. Em caso de erro (inclusive sem resposta em WORLDTIME_TIMEOUT_MS), exibe mensagem e retorna nullptr.
+ * 4. Retorna o próprio buffer da resposta, terminado por '\0'.
  *
  * Retorno:
  * - Ponteiro para string alocada dinamicamente contendo o JSON recebido (deve ser liberado pelo usuário)
  * - nullptr em caso de erro
  */
 char * get_worldtime_json() {
-    CURL* curl = curl_easy_init();
-    if (!curl) return nullptr;
-
-    // Buffer estático para armazenar a resposta JSON
-    static char buffer[8192] = {0};
-    curl_easy_setopt(curl, CURLOPT_URL, "http://worldtimeapi.org/api/timezone/America/Manaus");
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, buffer);
-
-    // Adiciona cabeçalhos HTTP
-    struct curl_slist* headers = nullptr;
-    headers = curl_slist_append(headers, "Accept: application/json");
-    headers = curl_slist_append(headers, "User-Agent: Mozilla/5.0");
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-
-    // Executa a requisição HTTP
-    CURLcode res = curl_easy_perform(curl);
-    if (res != CURLE_OK) {
-        cerr << "[CURL ERROR] " << curl_easy_strerror(res) << " (code: " << res << ")" << endl;
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
+    TRACE_SCOPE("get_worldtime_json");
+    metrics_timer timer(metric_worldtime_sync);
+    string url;
+    {
+        lock_guard<mutex> lock(worldtime_mutex);
+        url = worldtime_url;
+    }
+
+    // O buffer da resposta é entregue ao chamador, sem cópia
+    http_buffer response;
+    if (!http_get(url.c_str(), &response, nullptr, WORLDTIME_TIMEOUT_MS)) {
+        metrics_add(metric_worldtime_error);
+        http_buffer_free(&response);
         return nullptr;
     }
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
-    return strdup(buffer);
+    metrics_add(metric_worldtime_ok);
+    return response.data ? response.data : strdup("");
+}
+
+
+/**
+ * Versão assíncrona de get_worldtime_json(): inicia a requisição no motor informado e retorna imediatamente.
+ * O callback recebe o JSON em uma string alocada dinamicamente (a ser liberada pelo callback), ou nullptr
+ * em caso de erro (inclusive sem resposta em WORLDTIME_TIMEOUT_MS), e executa na thread do laço de eventos do motor.
+ *
+ * @param engine Motor de requisições assíncronas (fetch_engine.h)
+ * @param done Callback de conclusão; se a requisição não pôde ser iniciada, é chamado imediatamente com nullptr
+ * @return true se a requisição foi iniciada
+ */
+bool get_worldtime_json_async(fetch_engine* engine, std::function<void(char* json)> done) {
+    string url;
+    {
+        lock_guard<mutex> lock(worldtime_mutex);
+        url = worldtime_url;
+    }
+
+    int64_t start = metrics_now_ns();
+    // Com timeout explícito: sem rede, o callback recebe o erro em vez de a requisição ficar pendente para sempre
+    bool started = fetch_engine_get(engine, url.c_str(), [done, start](const fetch_result& result) {
+        metrics_observe(metric_worldtime_async, static_cast<uint64_t>(metrics_now_ns() - start));
+        metrics_add(result.ok ? metric_worldtime_ok : metric_worldtime_error);
+        if (!result.ok) {
+            cerr << "[CURL ERROR] " << result.error << endl;
+            done(nullptr);
+            return;
+        }
+        char* json = static_cast<char*>(malloc(result.length + 1));
+        if (json) {
+            memcpy(json, result.body, result.length + 1);
+        }
+        done(json);
+    }, WORLDTIME_TIMEOUT_MS);
+    if (!started) {
+        metrics_add(metric_worldtime_error);
+        done(nullptr);
+    }
+    return started;
+}
+
+
+/**
+ * Define a URL consultada por get_worldtime_json().
+ * Permite apontar o backend para um servidor local (testes, benchmarks) ou para um espelho da API.
+ *
+ * @param url Nova URL
+ */
+void backend_configure_worldtime_url(const char* url) {
+    lock_guard<mutex> lock(worldtime_mutex);
+    worldtime_url = url;
+}
+
+
+/**
+ * Inicia o relógio remoto extrapolado (time_service.h) sobre a URL da worldtimeapi configurada:
+ * sincroniza uma vez agora e depois a cada `ttl_ms` em segundo plano.
+ *
+ * @param ttl_ms Intervalo entre sincronizações
+ * @return true se a sincronização inicial teve sucesso (em caso de falha, o serviço continua tentando)
+ */
+bool backend_start_time_service(int64_t ttl_ms) {
+    string url;
+    {
+        lock_guard<mutex> lock(worldtime_mutex);
+        url = worldtime_url;
+    }
+    return time_service_start(url.c_str(), ttl_ms);
+}
+
+
+/**
+ * Retorna o horário atual do servidor de horário, extrapolado localmente a partir da última sincronização,
+ * sem acessar a rede.
+ *
+ * @param unix_ns Destino: nanossegundos desde a época Unix
+ * @return true em caso de sucesso; false se o serviço nunca sincronizou
+ */
+bool get_remote_time_ns(int64_t* unix_ns) {
+    return time_service_now_ns(unix_ns);
+}
+
+
+/**
+ * Define explicitamente a semente do backend.
+ * A thread chamadora recebe o primeiro fluxo de sorteio derivado da semente, e as demais threads
+ * os fluxos seguintes; nenhum deles repete a sequência do gerador de textos. A mesma semente é
+ * repassada à libgentexts na geração do corpus, o que permite reproduzir um corpus de produção.
+ *
+ * @param seed Semente de 64 bits
+ */
+void backend_set_seed(uint64_t seed) {
+    lock_guard<mutex> lock(seed_mutex);
+    seed_explicit.store(true, memory_order_relaxed);
+    apply_seed_locked(seed);
 }
 
 
@@ -82,43 +249,73 @@ char * get_worldtime_json() {
  * Inicializa o backend, configurando a semente do gerador de números aleatórios
  * e registrando o tempo de início da aplicação.
  *
- * Observação: A função srand é importante para garantir aleatoriedade nas funções que usam rand().
+ * Observação: Se backend_set_seed() já foi chamada, a semente explícita é mantida;
+ * caso contrário, a semente é derivada do relógio.
  */
 void backend_init() {
-    srand(static_cast<unsigned int>(time(nullptr)));
-    start_time = time(nullptr);
+    {
+        lock_guard<mutex> lock(seed_mutex);
+        if (!seed_explicit.load(memory_order_relaxed)) {
+            apply_seed_locked(static_cast<uint64_t>(time(nullptr)));
+        }
+    }
+    start_ns = monotonic_now_ns();
 }
 
 
 /**
- * Retorna o tempo (em segundos) decorrido desde a inicialização do backend.
- * Utiliza a função difftime para calcular a diferença entre o tempo atual e o tempo de início.
+ * Retorna o tempo (em nanossegundos) decorrido desde a inicialização do backend, pelo relógio monotônico.
+ */
+int64_t get_elapsed_ns() {
+    return monotonic_now_ns() - start_ns;
+}
+
+
+/**
+ * Retorna o tempo (em segundos, com fração) decorrido desde a inicialização do backend.
  *
  * @return Tempo decorrido em segundos
  */
 double get_elapsed_seconds() {
-    return difftime(time(nullptr), start_time);
+    return static_cast<double>(get_elapsed_ns()) / 1e9;
 }
 
 
 /**
- * Gera um número aleatório entre min e max (inclusive).
- * Utiliza a função rand() da biblioteca padrão.
+ * Retorna o gerador da thread chamadora, reinicializando-o se a semente base mudou.
+ * Cada thread usa um fluxo próprio derivado da semente base (sorteios de threads diferentes são
+ * independentes). O caminho comum é uma leitura atômica; a reinicialização, rara, fica sob seed_mutex.
  *
- * @param min Valor mínimo
- * @param max Valor máximo
- * @return Número aleatório entre min e max
+ * @return Ponteiro para o estado thread-local do gerador
  */
-int random_number(int min, int max) {
-    return min + rand() % (max - min + 1);
+static prng_state* thread_rng_get() {
+    uint64_t generation = seed_generation.load(memory_order_acquire);
+    if (__builtin_expect(thread_rng_generation != generation || generation == 0, 0)) {
+        lock_guard<mutex> lock(seed_mutex);
+        if (seed_generation.load(memory_order_relaxed) == 0) {
+            // Backend ainda não inicializado: usa uma semente derivada do relógio
+            apply_seed_locked(static_cast<uint64_t>(time(nullptr)));
+        } else if (thread_rng_generation != seed_generation.load(memory_order_relaxed)) {
+            seed_thread_rng_locked();
+        }
+    }
+    return &thread_rng;
 }
 
 
+/**
+ * Semente para um gerador auxiliar, tirada do gerador da thread (mesma sequência para a mesma semente base).
+ */
+uint64_t backend_stream_seed() {
+    return prng_next(thread_rng_get());
+}
+
 
 /**
- * Carrega dinamicamente a biblioteca compartilhada libgentexts.so usando dlopen,
- * obtém ponteiro para a função de geração de textos, gera o conjunto de textos uma única vez
- * e realiza sorteios subsequentes dentro desse conjunto já carregado.
+ * Carrega dinamicamente o gerador de textos (por padrão, ../lib/libgentexts.so) por meio do
+ * registro de plugins (plugin_registry.h), que usa dlopen/dlsym e verifica a versão do ABI
+ * anunciada por gentexts_plugin_query(). Em seguida gera o corpus e o publica como um snapshot
+ * imutável, sobre o qual os sorteios são feitos.
  *
  * Explicação sobre dlfcn:
  * - dlopen: Carrega uma biblioteca compartilhada em tempo de execução. Recebe o caminho do arquivo e flags (RTLD_LAZY para resolução preguiçosa de símbolos).
@@ -126,70 +323,572 @@ int random_number(int min, int max) {
  * - dlclose: Libera a biblioteca carregada.
  * - dlerror: Retorna uma string descrevendo o último erro ocorrido nas operações acima.
  *
- * Explicação sobre a função da libgentexts:
- * - generate_list_random_texts: Recebe ponteiro para int, retorna ponteiro para array de strings (char**), cada string é um texto gerado.
+ * Explicação sobre as funções do gerador (gentexts_plugin_api):
+ * - generate_corpus: Recebe a quantidade de textos (0 = padrão da biblioteca) e retorna um text_corpus,
+ *   com todos os textos em uma única arena e uma tabela de offsets/tamanhos.
+ * - generate_corpus_parallel: Mesmo layout, gerado por várias threads a partir de uma semente
+ *   (usada quando backend_configure_corpus() pede mais de uma thread).
+ * - free_corpus: Libera o corpus inteiro com uma única chamada.
  *
- * Passos:
- * 1. Carrega a biblioteca libgentexts.so (apenas na primeira chamada).
- * 2. Obtém ponteiro para a função de geração de textos.
- * 3. Gera e armazena o conjunto de textos em cache.
- * 4. Para cada chamada subsequente, sorteia um texto do conjunto já carregado.
- * 5. Retorna uma cópia do texto sorteado (strdup).
+ * Concorrência:
+ * - O corpus é publicado como um corpus_snapshot por meio de um ponteiro atômico (ver corpus_snapshot.h).
+ * - Os leitores (sorteios) apenas entram em uma seção de leitura e carregam o ponteiro: sem mutex.
+ * - A carga do gerador e as (re)gerações são serializadas por corpus_mutex, que os leitores só
+ *   tocam na primeira carga (inicialização única com verificação dupla).
+ * - backend_refresh_corpus() gera e publica um novo corpus; o anterior é liberado quando
+ *   nenhum leitor pode mais enxergá-lo. Cada snapshot guarda uma referência ao plugin que o gerou,
+ *   então trocar ou recarregar o gerador não descarrega uma biblioteca cujo corpus ainda é lido.
+ */
+
+// Gerador usado quando nenhum outro foi selecionado
+static const char* DEFAULT_GENERATOR_PATH = "../lib/libgentexts.so";
+
+// Parâmetros da geração do corpus (ver backend_configure_corpus)
+static int corpus_num_texts = 0;
+static int corpus_num_threads = 1;
+
+// Armazena os corpora gerados compactados em 5 bits (ver backend_configure_corpus_packing)
+static bool corpus_packing = false;
+
+// Arquivo de corpus pré-gerado, tentado antes da geração na primeira carga (ver backend_configure_corpus_file)
+static string corpus_file_path;
+
+// Gerador ativo e versão do corpus publicado (protegidos por corpus_mutex)
+static mutex corpus_mutex;
+static shared_ptr<generator_plugin> active_generator;
+static uint64_t corpus_version = 0;
+
+
+/**
+ * Carrega o gerador padrão, se nenhum gerador estiver ativo. Exige corpus_mutex.
  *
- * Retorno:
- * - Ponteiro para string alocada dinamicamente contendo o texto sorteado (deve ser liberado pelo usuário)
- * - nullptr em caso de erro
+ * @return true se há um gerador ativo
  */
+static bool load_generator_locked() {
+    if (!active_generator) {
+        active_generator = plugin_registry_add(DEFAULT_GENERATOR_PATH);
+    }
+    return active_generator != nullptr;
+}
 
-// Cache para textos gerados
-static char** cached_texts = nullptr;
-static int cached_count = 0;
-static void* gentexts_handle = nullptr;
 
-char* get_random_text() {
-    if (!cached_texts) {
-        gentexts_handle = dlopen("../lib/libgentexts.so", RTLD_LAZY);
-        if (!gentexts_handle) {
-            cerr << "Erro ao carregar libgentexts.so: " << dlerror() << endl;
-            return nullptr;
-        }
-        dlerror();
-        using generate_func = char** (*)(int*);
-        generate_func generate = (generate_func)dlsym(gentexts_handle, "generate_list_random_texts");
-        const char* error = dlerror();
-        if (error) {
-            cerr << "Erro ao localizar função: " << error << endl;
-            dlclose(gentexts_handle);
-            gentexts_handle = nullptr;
-            return nullptr;
+/**
+ * Memória de um corpus no layout do ABI: estrutura, tabelas de offsets e tamanhos e arena.
+ */
+static size_t corpus_memory_bytes(const text_corpus* corpus) {
+    return sizeof(text_corpus) + static_cast<size_t>(corpus->count) * (sizeof(uint64_t) + sizeof(uint32_t)) +
+           corpus->size;
+}
+
+
+/**
+ * Atualiza os medidores do corpus publicado.
+ */
+static void record_corpus_published(const corpus_snapshot* snapshot, size_t bytes) {
+    metrics_gauge_set(metric_corpus_bytes, static_cast<int64_t>(bytes));
+    metrics_gauge_set(metric_corpus_texts, static_cast<int64_t>(snapshot->count));
+    metrics_gauge_set(metric_corpus_version, static_cast<int64_t>(snapshot->version));
+}
+
+
+/**
+ * Gera um novo corpus com o gerador ativo e o publica como snapshot. Exige corpus_mutex.
+ * A primeira versão usa a semente base do backend; as seguintes usam fluxos derivados dela,
+ * de modo que a sequência de corpora também é reproduzível.
+ *
+ * @return true se o corpus foi gerado e publicado
+ */
+static bool publish_new_corpus_locked() {
+    TRACE_SCOPE("corpus_build");
+    if (!load_generator_locked()) {
+        metrics_add(metric_corpus_builds_error);
+        return false;
+    }
+    int64_t start = metrics_now_ns();
+
+    uint64_t version = corpus_version + 1;
+    uint64_t seed = base_seed.load(memory_order_relaxed);
+    if (version > 1) {
+        prng_state derived;
+        prng_seed_stream(&derived, seed, version);
+        seed = prng_next(&derived);
+    }
+
+    shared_ptr<generator_plugin> plugin = active_generator;
+    const gentexts_plugin_api* api = plugin->api;
+    text_corpus* corpus = nullptr;
+    if (api->capabilities & GENTEXTS_CAP_PARALLEL) {
+        // Geração em blocos mesmo com uma só thread: o corpus depende apenas da semente, não de corpus_num_threads
+        corpus = api->generate_corpus_parallel(corpus_num_texts, seed, corpus_num_threads);
+    } else {
+        // Repassa a semente do backend para o gerador (capacidade opcional)
+        if (api->capabilities & GENTEXTS_CAP_SEED) {
+            api->seed(seed);
         }
-        cached_texts = generate(&cached_count);
-        if (!cached_texts || cached_count == 0) {
-            dlclose(gentexts_handle);
-            gentexts_handle = nullptr;
-            return nullptr;
+        corpus = api->generate_corpus(corpus_num_texts);
+    }
+    if (!corpus || corpus->count == 0) {
+        if (corpus) api->free_corpus(corpus);
+        metrics_add(metric_corpus_builds_error);
+        return false;
+    }
+    // Layout do ABI: um bloco com a estrutura e as tabelas e outro com a arena
+    metrics_add(metric_corpus_allocations, 2);
+    metrics_add(metric_corpus_allocated_bytes, corpus_memory_bytes(corpus));
+
+    // Com compactação ativa, o corpus em bytes é descartado assim que a versão compactada existe
+    if (corpus_packing) {
+        packed_corpus* packed = packed_corpus_build(corpus);
+        if (packed) {
+            api->free_corpus(corpus);
+            corpus_snapshot* snapshot = new corpus_snapshot{nullptr, version, [packed](const text_corpus*) {
+                packed_corpus_free(packed);
+            }};
+            snapshot->packed = packed;
+            snapshot->count = packed->count;
+            snapshot_publish(snapshot);
+            corpus_version = version;
+            // Estrutura com a tabela e bitstream
+            metrics_add(metric_corpus_allocations, 2);
+            metrics_add(metric_corpus_allocated_bytes, packed->bytes);
+            metrics_add(metric_corpus_builds_ok);
+            metrics_observe(metric_corpus_build, static_cast<uint64_t>(metrics_now_ns() - start));
+            record_corpus_published(snapshot, packed->bytes);
+            return true;
         }
+        cerr << "Corpus não pôde ser compactado; mantendo a versão em bytes" << endl;
     }
-    int index = random_number(0, cached_count - 1);
-    return strdup(cached_texts[index]);
+
+    // O snapshot mantém o plugin carregado até que o corpus seja liberado
+    corpus_snapshot* snapshot = new corpus_snapshot{corpus, version, [plugin](const text_corpus* c) {
+        plugin->api->free_corpus(const_cast<text_corpus*>(c));
+    }};
+    snapshot->count = corpus->count;
+    snapshot_publish(snapshot);
+    corpus_version = version;
+    metrics_add(metric_corpus_builds_ok);
+    metrics_observe(metric_corpus_build, static_cast<uint64_t>(metrics_now_ns() - start));
+    record_corpus_published(snapshot, corpus_memory_bytes(corpus));
+    return true;
 }
 
+
 /**
- * Libera o conjunto de textos gerado e o handle da biblioteca dinâmica.
- * Deve ser chamada ao final do programa para evitar vazamento de memória.
+ * Mapeia um arquivo de corpus e o publica como snapshot. Exige corpus_mutex.
+ *
+ * @return true se o arquivo foi mapeado e publicado
  */
-void backend_cleanup() {
-    if (cached_texts) {
-        for (int i = 0; i < cached_count; i++) {
-            free(cached_texts[i]);
+static bool publish_corpus_file_locked(const char* path) {
+    TRACE_SCOPE("corpus_map");
+    text_corpus* corpus = corpus_file_map(path);
+    if (!corpus) {
+        return false;
+    }
+    uint64_t version = corpus_version + 1;
+    corpus_snapshot* snapshot = new corpus_snapshot{corpus, version, corpus_file_unmap};
+    snapshot->count = corpus->count;
+    snapshot_publish(snapshot);
+    corpus_version = version;
+    record_corpus_published(snapshot, corpus_memory_bytes(corpus));
+    return true;
+}
+
+
+/**
+ * Retorna o snapshot atual, carregando o primeiro corpus se necessário
+ * (do arquivo configurado, se houver; caso contrário, pela libgentexts).
+ * Deve ser chamada dentro de uma seção de leitura; o caminho comum é apenas uma leitura atômica.
+ *
+ * @return Snapshot atual ou nullptr se o corpus não pôde ser carregado
+ */
+static const corpus_snapshot* current_corpus() {
+    const corpus_snapshot* snapshot = snapshot_current();
+    if (snapshot) {
+        return snapshot;
+    }
+    lock_guard<mutex> lock(corpus_mutex);
+    snapshot = snapshot_current();
+    if (!snapshot) {
+        bool loaded = !corpus_file_path.empty() && publish_corpus_file_locked(corpus_file_path.c_str());
+        if (loaded || publish_new_corpus_locked()) {
+            snapshot = snapshot_current();
         }
-        free(cached_texts);
-        cached_texts = nullptr;
     }
-    if (gentexts_handle) {
-        dlclose(gentexts_handle);
-        gentexts_handle = nullptr;
+    return snapshot;
+}
+
+
+/**
+ * Sorteia um texto do corpus e retorna uma cópia dele.
+ * Funciona tanto com o corpus em bytes quanto com o compactado (que é decodificado na cópia).
+ *
+ * Retorno:
+ * - Ponteiro para string alocada dinamicamente contendo o texto sorteado (deve ser liberado pelo usuário)
+ * - nullptr em caso de erro
+ */
+char* get_random_text() {
+    TRACE_SCOPE("get_random_text");
+    snapshot_read_guard guard;
+    const corpus_snapshot* snapshot = current_corpus();
+    if (!snapshot) {
+        metrics_add(metric_sample_failures);
+        return nullptr;
+    }
+    metrics_add(metric_sampled_copy);
+    uint32_t index = prng_bounded(thread_rng_get(), static_cast<uint32_t>(snapshot->count));
+    size_t length = snapshot->packed ? packed_corpus_length(snapshot->packed, index) : snapshot->corpus->lengths[index];
+    char* text = static_cast<char*>(malloc(length + 1));
+    if (!text) {
+        return nullptr;
+    }
+    metrics_add(metric_text_allocations);
+    metrics_add(metric_text_allocated_bytes, length + 1);
+    metrics_observe(metric_text_allocation_size, length + 1);
+    if (snapshot->packed) {
+        packed_corpus_decode(snapshot->packed, index, text, length + 1);
+        return text;
+    }
+    memcpy(text, snapshot->corpus->arena + snapshot->corpus->offsets[index], length + 1);
+    return text;
+}
+
+
+/**
+ * Sorteia um texto e o copia (decodificando, se o corpus estiver compactado) para o buffer do chamador,
+ * sem alocação. O texto é truncado se não couber, e sempre terminado por '\0'.
+ *
+ * @param buffer Destino
+ * @param capacity Tamanho do destino
+ * @return Tamanho do texto copiado, ou 0 em caso de erro
+ */
+size_t get_random_text_into(char* buffer, size_t capacity) {
+    TRACE_SCOPE("get_random_text_into");
+    snapshot_read_guard guard;
+    const corpus_snapshot* snapshot = current_corpus();
+    if (!snapshot || capacity == 0) {
+        metrics_add(metric_sample_failures);
+        return 0;
+    }
+    metrics_add(metric_sampled_into);
+    uint32_t index = prng_bounded(thread_rng_get(), static_cast<uint32_t>(snapshot->count));
+    if (snapshot->packed) {
+        return packed_corpus_decode(snapshot->packed, index, buffer, capacity);
+    }
+    const text_corpus* corpus = snapshot->corpus;
+    size_t length = corpus->lengths[index] < capacity - 1 ? corpus->lengths[index] : capacity - 1;
+    memcpy(buffer, corpus->arena + corpus->offsets[index], length);
+    buffer[length] = '\0';
+    return length;
+}
+
+
+/**
+ * Sorteia um texto e devolve uma visão emprestada (ponteiro e tamanho) para ele, sem cópia.
+ * A visão aponta para a arena do snapshot atual. Dentro de uma seção de leitura
+ * (backend_read_begin() ou corpus_read_guard) ela permanece válida até o fim da seção;
+ * fora dela, até a próxima troca de corpus (backend_refresh_corpus() ou backend_cleanup()).
+ * Não há visão de um corpus compactado: nesse caso use get_random_text_into().
+ *
+ * @param view Destino da visão
+ * @return true em caso de sucesso; false se o corpus não pôde ser carregado ou está compactado
+ */
+bool get_random_text_view(text_view* view) {
+    TRACE_SCOPE("get_random_text_view");
+    snapshot_read_guard guard;
+    const corpus_snapshot* snapshot = current_corpus();
+    if (!snapshot || !snapshot->corpus) {
+        metrics_add(metric_sample_failures);
+        return false;
+    }
+    metrics_add(metric_sampled_view);
+    const text_corpus* corpus = snapshot->corpus;
+    uint32_t index = prng_bounded(thread_rng_get(), static_cast<uint32_t>(corpus->count));
+    view->data = corpus->arena + corpus->offsets[index];
+    view->length = corpus->lengths[index];
+    return true;
+}
+
+
+/**
+ * Sorteia n textos de uma vez, preenchendo o array de visões fornecido pelo chamador.
+ * O gerador da thread e o snapshot são obtidos uma única vez para todo o lote,
+ * então todas as visões vêm do mesmo corpus.
+ *
+ * @param n Quantidade de sorteios
+ * @param views Array com pelo menos n posições
+ * @return Quantidade de visões preenchidas (n, ou 0 se o corpus não pôde ser carregado ou está compactado)
+ */
+size_t get_random_texts(size_t n, text_view* views) {
+    snapshot_read_guard guard;
+    const corpus_snapshot* snapshot = current_corpus();
+    if (!snapshot || !snapshot->corpus) {
+        metrics_add(metric_sample_failures);
+        return 0;
+    }
+    metrics_add(metric_sampled_batch, n);
+    const text_corpus* corpus = snapshot->corpus;
+    prng_state* rng = thread_rng_get();
+    const uint32_t count = static_cast<uint32_t>(corpus->count);
+    for (size_t i = 0; i < n; i++) {
+        uint32_t index = prng_bounded(rng, count);
+        views[i].data = corpus->arena + corpus->offsets[index];
+        views[i].length = corpus->lengths[index];
+    }
+    return n;
+}
+
+
+/**
+ * Sorteia n índices de textos de uma vez. Útil quando o chamador só precisa identificar os textos
+ * (por exemplo, para enviá-los depois ou agregá-los); o texto pode ser obtido com get_text_view().
+ * Os índices se referem ao snapshot atual; após uma troca de corpus, podem apontar para outros textos.
+ *
+ * @param n Quantidade de sorteios
+ * @param indices Array com pelo menos n posições
+ * @return Quantidade de índices preenchidos (n, ou 0 se o corpus não pôde ser carregado)
+ */
+size_t get_random_text_indices(size_t n, uint32_t* indices) {
+    snapshot_read_guard guard;
+    const corpus_snapshot* snapshot = current_corpus();
+    if (!snapshot) {
+        metrics_add(metric_sample_failures);
+        return 0;
+    }
+    metrics_add(metric_sampled_indices, n);
+    prng_state* rng = thread_rng_get();
+    const uint32_t count = static_cast<uint32_t>(snapshot->count);
+    for (size_t i = 0; i < n; i++) {
+        indices[i] = prng_bounded(rng, count);
+    }
+    return n;
+}
+
+
+/**
+ * Retorna a visão do texto de índice index do corpus, sem cópia (mesma validade de get_random_text_view()).
+ *
+ * @param index Índice entre 0 e get_corpus_count() - 1
+ * @param view Destino da visão
+ * @return true em caso de sucesso; false se o índice é inválido ou o corpus não pôde ser carregado ou está compactado
+ */
+bool get_text_view(uint32_t index, text_view* view) {
+    snapshot_read_guard guard;
+    const corpus_snapshot* snapshot = current_corpus();
+    if (!snapshot || !snapshot->corpus || index >= static_cast<uint32_t>(snapshot->count)) {
+        return false;
+    }
+    view->data = snapshot->corpus->arena + snapshot->corpus->offsets[index];
+    view->length = snapshot->corpus->lengths[index];
+    return true;
+}
+
+
+/**
+ * Retorna a quantidade de textos do corpus, carregando-o se necessário (0 em caso de erro).
+ */
+size_t get_corpus_count() {
+    snapshot_read_guard guard;
+    const corpus_snapshot* snapshot = current_corpus();
+    return snapshot ? static_cast<size_t>(snapshot->count) : 0;
+}
+
+
+/**
+ * Entra/sai de uma seção de leitura do corpus. Visões obtidas dentro da seção continuam válidas
+ * até o fim dela, mesmo que backend_refresh_corpus() troque o corpus nesse meio tempo.
+ */
+void backend_read_begin() {
+    snapshot_read_begin();
+}
+
+void backend_read_end() {
+    snapshot_read_end();
+}
+
+
+/**
+ * Gera um novo corpus e o troca pelo atual sem interromper os leitores.
+ * Os sorteios em andamento continuam no corpus antigo, que é liberado quando o último
+ * leitor que podia vê-lo sai de sua seção de leitura.
+ *
+ * @return true se o novo corpus foi publicado; false em caso de erro (o corpus atual é mantido)
+ */
+bool backend_refresh_corpus() {
+    lock_guard<mutex> lock(corpus_mutex);
+    return publish_new_corpus_locked();
+}
+
+
+/**
+ * Retorna a versão do corpus publicado (1 para o primeiro, incrementada a cada troca; 0 se não há corpus).
+ */
+uint64_t get_corpus_version() {
+    snapshot_read_guard guard;
+    const corpus_snapshot* snapshot = snapshot_current();
+    return snapshot ? snapshot->version : 0;
+}
+
+
+/**
+ * Configura a geração do corpus, que ocorre na primeira chamada de get_random_text()
+ * e a cada backend_refresh_corpus().
+ *
+ * @param num_texts Quantidade de textos (0 = padrão da biblioteca)
+ * @param num_threads Threads de geração (1 = sequencial; 0 = número de processadores).
+ *        Com mais de uma thread, o corpus depende apenas da semente, e não da quantidade de threads.
+ */
+void backend_configure_corpus(int num_texts, int num_threads) {
+    lock_guard<mutex> lock(corpus_mutex);
+    corpus_num_texts = num_texts > 0 ? num_texts : 0;
+    corpus_num_threads = num_threads;
+}
+
+
+/**
+ * Ativa ou desativa a compactação em 5 bits dos corpora gerados (a partir da próxima geração).
+ * Com ela, a memória residente do corpus cai para cerca de 5/8; os sorteios passam a decodificar
+ * o texto (get_random_text() e get_random_text_into()) e as visões sem cópia deixam de estar disponíveis.
+ * Corpora mapeados de arquivo não são compactados, para continuarem compartilhados entre processos.
+ */
+void backend_configure_corpus_packing(bool enabled) {
+    lock_guard<mutex> lock(corpus_mutex);
+    corpus_packing = enabled;
+}
+
+
+/**
+ * Define um arquivo de corpus pré-gerado (ver corpus_file.h) a ser mapeado na primeira carga,
+ * no lugar da geração pela libgentexts. Se o arquivo não puder ser aberto, o corpus é gerado normalmente.
+ *
+ * @param path Caminho do arquivo, ou nullptr/"" para desativar
+ */
+void backend_configure_corpus_file(const char* path) {
+    lock_guard<mutex> lock(corpus_mutex);
+    corpus_file_path = path ? path : "";
+}
+
+
+/**
+ * Mapeia um arquivo de corpus somente para leitura e o troca pelo atual, como backend_refresh_corpus().
+ * As páginas do arquivo são compartilhadas entre todos os processos que o mapeiam.
+ *
+ * @return true se o arquivo foi carregado; false em caso de erro (o corpus atual é mantido)
+ */
+bool backend_load_corpus_file(const char* path) {
+    lock_guard<mutex> lock(corpus_mutex);
+    return publish_corpus_file_locked(path);
+}
+
+
+/**
+ * Grava o corpus atual (carregando-o se necessário) em um arquivo, para uso posterior
+ * com backend_load_corpus_file() ou backend_configure_corpus_file().
+ *
+ * @return true em caso de sucesso
+ */
+bool backend_save_corpus_file(const char* path) {
+    snapshot_read_guard guard;
+    const corpus_snapshot* snapshot = current_corpus();
+    if (snapshot && !snapshot->corpus) {
+        cerr << "Corpus compactado não pode ser gravado no formato de arquivo" << endl;
+        return false;
+    }
+    return snapshot && corpus_file_write(path, snapshot->corpus);
+}
+
+
+/**
+ * Carrega todos os geradores (.so) de um diretório no registro de plugins.
+ *
+ * @return Quantidade de geradores carregados
+ */
+size_t backend_scan_generators(const char* directory) {
+    return plugin_registry_scan(directory);
+}
+
+
+/**
+ * Torna ativo o gerador registrado com esse nome e publica um corpus gerado por ele.
+ * Os leitores continuam no corpus anterior até a troca.
+ *
+ * @return true se o gerador existe e o novo corpus foi publicado
+ */
+bool backend_select_generator(const char* name) {
+    shared_ptr<generator_plugin> plugin = plugin_registry_find(name);
+    if (!plugin) {
+        cerr << "Gerador não registrado: " << name << endl;
+        return false;
+    }
+    lock_guard<mutex> lock(corpus_mutex);
+    shared_ptr<generator_plugin> previous = active_generator;
+    active_generator = plugin;
+    if (!publish_new_corpus_locked()) {
+        active_generator = previous;
+        return false;
+    }
+    return true;
+}
+
+
+/**
+ * Recarrega do disco a biblioteca do gerador ativo (por exemplo, após recompilá-la) e publica
+ * um corpus gerado pela nova versão, sem reiniciar o processo. O corpus antigo continua sendo
+ * lido até a troca, e a biblioteca antiga só é descarregada quando ele é liberado.
+ *
+ * @param only_if_modified Se true, não faz nada quando o arquivo não mudou desde a última carga
+ * @return true se o gerador está atualizado e (quando recarregado) o novo corpus foi publicado
+ */
+bool backend_reload_generator(bool only_if_modified) {
+    lock_guard<mutex> lock(corpus_mutex);
+    if (!load_generator_locked()) {
+        return false;
+    }
+    shared_ptr<generator_plugin> previous = active_generator;
+    shared_ptr<generator_plugin> reloaded = plugin_registry_reload(previous->name, only_if_modified);
+    if (!reloaded) {
+        return false;
+    }
+    if (reloaded == previous) {
+        return true;
     }
-    cached_count = 0;
+    active_generator = reloaded;
+    if (!publish_new_corpus_locked()) {
+        active_generator = previous;
+        return false;
+    }
+    return true;
 }
 
+
+/**
+ * Retira o corpus publicado, espera os leitores em andamento e libera o corpus (com uma única chamada
+ * a free_corpus), os geradores carregados, o relógio remoto e as conexões HTTP reutilizáveis.
+ * Deve ser chamada ao final do programa, fora de qualquer seção de leitura.
+ */
+void backend_cleanup() {
+    metrics_timer timer(metric_cleanup);
+    {
+        lock_guard<mutex> lock(corpus_mutex);
+        snapshot_publish(nullptr);
+        corpus_version = 0;
+    }
+    metrics_gauge_set(metric_corpus_bytes, 0);
+    metrics_gauge_set(metric_corpus_texts, 0);
+    metrics_gauge_set(metric_corpus_version, 0);
+
+    // Espera sem segurar corpus_mutex, para não bloquear um leitor que esteja carregando o corpus
+    snapshot_synchronize();
+
+    // Os plugins são descarregados quando o último snapshot que os referencia é liberado
+    lock_guard<mutex> lock(corpus_mutex);
+    if (!snapshot_current()) {
+        active_generator.reset();
+        plugin_registry_clear();
+    }
+
+    // Para o relógio remoto antes de fechar as conexões que ele usa
+    time_service_stop();
+
+    // Fecha as conexões mantidas abertas pelo cliente HTTP
+    http_client_cleanup();
+}
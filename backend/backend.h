@@ -1,6 +1,20 @@
 #ifndef BACKEND_H
 #define BACKEND_H
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+struct fetch_engine;
+
+/**
+ * Visão emprestada de um texto do corpus: ponteiro e tamanho, sem cópia.
+ * data também é terminado por '\0'. Não deve ser liberada pelo usuário.
+ */
+struct text_view {
+    const char* data;
+    size_t length;
+};
 
 /**
  * Inicializa o backend, configurando a semente do gerador de números aleatórios
@@ -8,12 +22,50 @@
  */
 void backend_init();
 
+/**
+ * Define a semente dos geradores pseudoaleatórios do backend e da libgentexts.
+ * Com a mesma semente, o corpus gerado e a sequência de sorteios da thread chamadora se repetem.
+ * Deve ser chamada antes de backend_init() para que a semente explícita seja preservada.
+ */
+void backend_set_seed(uint64_t seed);
+
+/**
+ * Sorteia uma semente de 64 bits com o gerador da thread chamadora, para inicializar geradores
+ * auxiliares (como os dos amostradores, sampler.h) de forma reproduzível com backend_set_seed().
+ */
+uint64_t backend_stream_seed();
+
 /**
  * Realiza uma requisição HTTP GET para obter o horário atual de Manaus em formato JSON.
+ * A conexão é mantida aberta e reutilizada pelas chamadas seguintes da mesma thread.
  * Retorna uma string alocada dinamicamente (deve ser liberada pelo usuário).
  */
 char* get_worldtime_json();
 
+/**
+ * Versão assíncrona de get_worldtime_json(), sobre um motor curl_multi (fetch_engine.h).
+ * Retorna imediatamente; o callback recebe o JSON alocado dinamicamente (deve ser liberado por ele),
+ * ou nullptr em caso de erro, na thread do laço de eventos do motor.
+ */
+bool get_worldtime_json_async(fetch_engine* engine, std::function<void(char* json)> done);
+
+/**
+ * Inicia o relógio remoto: sincroniza com a worldtimeapi agora e depois a cada `ttl_ms` em segundo plano,
+ * corrigindo o RTT e a deriva do relógio local. Retorna true se a sincronização inicial teve sucesso.
+ */
+bool backend_start_time_service(int64_t ttl_ms);
+
+/**
+ * Horário atual do servidor em nanossegundos desde a época Unix, extrapolado localmente (sem rede).
+ * Retorna false se o relógio remoto nunca sincronizou.
+ */
+bool get_remote_time_ns(int64_t* unix_ns);
+
+/**
+ * Define a URL consultada por get_worldtime_json() (ex.: um servidor local em testes e benchmarks).
+ */
+void backend_configure_worldtime_url(const char* url);
+
 /**
  * Retorna uma cópia de um texto aleatório do conjunto gerado na primeira chamada.
  * O sorteio é feito localmente, sem nova chamada à biblioteca dinâmica.
@@ -22,8 +74,135 @@ char* get_worldtime_json();
 char* get_random_text();
 
 /**
- * Retorna o tempo (em segundos) decorrido desde a inicialização do backend.
+ * Sorteia um texto e o copia para o buffer do chamador (truncando se necessário), sem alocação.
+ * Funciona também com o corpus compactado. Retorna o tamanho copiado, ou 0 em caso de erro.
+ */
+size_t get_random_text_into(char* buffer, size_t capacity);
+
+/**
+ * Sorteia um texto e devolve uma visão emprestada para ele, sem alocação nem cópia.
+ * Dentro de uma seção de leitura (corpus_read_guard), a visão permanece válida até o fim da seção;
+ * fora dela, até a próxima troca de corpus (backend_refresh_corpus() ou backend_cleanup()).
+ * Retorna false se o corpus não pôde ser carregado ou está compactado (ver backend_configure_corpus_packing()).
+ */
+bool get_random_text_view(text_view* view);
+
+/**
+ * Sorteia n textos em uma única chamada, preenchendo o array de visões do chamador.
+ * Retorna a quantidade de visões preenchidas (0 em caso de erro).
+ */
+size_t get_random_texts(size_t n, text_view* views);
+
+/**
+ * Sorteia n índices de textos em uma única chamada, preenchendo o array do chamador.
+ * Retorna a quantidade de índices preenchidos (0 em caso de erro).
+ */
+size_t get_random_text_indices(size_t n, uint32_t* indices);
+
+/**
+ * Obtém a visão do texto de índice index, sem cópia. Retorna false se o índice é inválido.
+ */
+bool get_text_view(uint32_t index, text_view* view);
+
+/**
+ * Retorna a quantidade de textos do corpus (0 se ele não pôde ser carregado).
+ */
+size_t get_corpus_count();
+
+/**
+ * Retorna a versão do corpus publicado (incrementada a cada troca; 0 se não há corpus).
+ */
+uint64_t get_corpus_version();
+
+/**
+ * Gera um novo corpus e o troca pelo atual sem bloquear os leitores.
+ * O corpus anterior é liberado quando nenhum leitor pode mais enxergá-lo.
+ * Retorna false em caso de erro (o corpus atual é mantido).
+ */
+bool backend_refresh_corpus();
+
+/**
+ * Ativa a compactação em 5 bits dos corpora gerados (a partir da próxima geração).
+ * Reduz a memória do corpus; os sorteios passam a decodificar os textos e as visões sem cópia
+ * deixam de estar disponíveis (use get_random_text() ou get_random_text_into()).
+ */
+void backend_configure_corpus_packing(bool enabled);
+
+/**
+ * Define um arquivo de corpus pré-gerado a ser mapeado (mmap, somente leitura) na primeira carga,
+ * em vez de gerar o corpus. Se o arquivo não puder ser aberto, o corpus é gerado normalmente.
+ */
+void backend_configure_corpus_file(const char* path);
+
+/**
+ * Mapeia um arquivo de corpus e o troca pelo atual, como backend_refresh_corpus().
+ * Retorna false em caso de erro (o corpus atual é mantido).
+ */
+bool backend_load_corpus_file(const char* path);
+
+/**
+ * Grava o corpus atual em um arquivo no formato binário de corpus_file.h.
+ */
+bool backend_save_corpus_file(const char* path);
+
+/**
+ * Carrega no registro de plugins todos os geradores (.so) de um diretório.
+ * Retorna a quantidade de geradores carregados.
+ */
+size_t backend_scan_generators(const char* directory);
+
+/**
+ * Torna ativo o gerador registrado com esse nome e troca o corpus por um gerado por ele.
+ */
+bool backend_select_generator(const char* name);
+
+/**
+ * Recarrega do disco a biblioteca do gerador ativo e troca o corpus, sem reiniciar o processo.
+ * Com only_if_modified, só recarrega se o arquivo mudou desde a última carga.
+ */
+bool backend_reload_generator(bool only_if_modified);
+
+/**
+ * Seção de leitura do corpus: as visões obtidas dentro dela continuam válidas até o fim da seção,
+ * mesmo durante uma troca de corpus. Não usa mutex e pode ser aninhada.
+ */
+void backend_read_begin();
+void backend_read_end();
+
+/**
+ * Seção de leitura do corpus no estilo RAII.
+ */
+class corpus_read_guard {
+public:
+    corpus_read_guard() { backend_read_begin(); }
+    ~corpus_read_guard() { backend_read_end(); }
+    corpus_read_guard(const corpus_read_guard&) = delete;
+    corpus_read_guard& operator=(const corpus_read_guard&) = delete;
+};
+
+/**
+ * Configura a geração do corpus (feita na primeira chamada de get_random_text()).
+ * num_texts = 0 usa o padrão da biblioteca; num_threads = 1 gera na thread chamadora e
+ * num_threads = 0 usa todos os processadores. O corpus depende só da semente, não do número de threads.
+ */
+void backend_configure_corpus(int num_texts, int num_threads);
+
+/**
+ * Retorna o tempo (em segundos, com fração) decorrido desde a inicialização do backend.
  */
 double get_elapsed_seconds();
 
+/**
+ * Retorna o tempo decorrido desde a inicialização do backend, em nanossegundos do relógio monotônico
+ * (mesma base de monotonic_now_ns(), em scheduler.h).
+ */
+int64_t get_elapsed_ns();
+
+/**
+ * Retira o corpus, espera os leitores em andamento e libera o corpus, o handle da biblioteca dinâmica,
+ * o relógio remoto e as conexões HTTP mantidas abertas.
+ * Deve ser chamada ao final do programa, fora de qualquer seção de leitura.
+ */
+void backend_cleanup();
+
 #endif
\ No newline at end of file
@@ -0,0 +1,213 @@
+#include <iostream>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "corpus_file.h"
+
+using namespace std;
+
+static const char CORPUS_FILE_MAGIC[8] = {'G', 'E', 'N', 'T', 'X', 'T', '\0', '\1'};
+
+// Corpus mapeado: a estrutura text_corpus e os dados do mapeamento ficam em um único bloco
+struct mapped_corpus {
+    text_corpus corpus;
+    void* base;
+    size_t size;
+};
+
+
+static uint64_t align8(uint64_t value) {
+    return (value + 7) & ~static_cast<uint64_t>(7);
+}
+
+
+/**
+ * Escreve exatamente size bytes, tratando escritas parciais.
+ */
+static bool write_all(int fd, const void* data, size_t size) {
+    const char* p = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t written = write(fd, p, size);
+        if (written < 0) {
+            return false;
+        }
+        p += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+
+/**
+ * Escreve bytes nulos até a posição alinhada seguinte.
+ */
+static bool write_padding(int fd, uint64_t from, uint64_t to) {
+    static const char zeros[8] = {0};
+    return write_all(fd, zeros, static_cast<size_t>(to - from));
+}
+
+
+/**
+ * Sincroniza o diretório que contém path.
+ */
+static bool sync_parent_directory(const char* path) {
+    string dir(path);
+    size_t slash = dir.rfind('/');
+    dir = slash == string::npos ? "." : (slash == 0 ? "/" : dir.substr(0, slash));
+    int fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = fsync(fd) == 0;
+    close(fd);
+    return ok;
+}
+
+
+bool corpus_file_write(const char* path, const text_corpus* corpus) {
+    corpus_file_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CORPUS_FILE_MAGIC, sizeof(header.magic));
+    header.version = CORPUS_FILE_VERSION;
+    header.header_size = sizeof(corpus_file_header);
+    header.byte_order = CORPUS_FILE_BYTE_ORDER;
+    header.count = static_cast<uint64_t>(corpus->count);
+    header.blob_size = corpus->size;
+    header.offsets_pos = align8(sizeof(corpus_file_header));
+    header.lengths_pos = header.offsets_pos + header.count * sizeof(uint64_t);
+    header.blob_pos = align8(header.lengths_pos + header.count * sizeof(uint32_t));
+
+    // Nome único por gravação: duas gravações simultâneas no mesmo caminho não escrevem no mesmo temporário
+    string tmp_path = string(path) + ".XXXXXX";
+    int fd = mkostemp(&tmp_path[0], O_CLOEXEC);
+    if (fd < 0) {
+        cerr << "Erro ao criar " << tmp_path << ": " << strerror(errno) << endl;
+        return false;
+    }
+    // mkostemp cria com 0600; o corpus é lido por outros processos
+    fchmod(fd, 0644);
+
+    bool ok = write_all(fd, &header, sizeof(header))
+        && write_padding(fd, sizeof(header), header.offsets_pos)
+        && write_all(fd, corpus->offsets, header.count * sizeof(uint64_t))
+        && write_all(fd, corpus->lengths, header.count * sizeof(uint32_t))
+        && write_padding(fd, header.lengths_pos + header.count * sizeof(uint32_t), header.blob_pos)
+        && write_all(fd, corpus->arena, corpus->size)
+        && fsync(fd) == 0;
+
+    if (close(fd) != 0) {
+        ok = false;
+    }
+    if (!ok || rename(tmp_path.c_str(), path) != 0) {
+        cerr << "Erro ao gravar " << path << ": " << strerror(errno) << endl;
+        unlink(tmp_path.c_str());
+        return false;
+    }
+    // A renomeação só é durável depois que a entrada do diretório chega ao disco
+    if (!sync_parent_directory(path)) {
+        cerr << "Erro ao sincronizar o diretório de " << path << ": " << strerror(errno) << endl;
+        return false;
+    }
+    return true;
+}
+
+
+/**
+ * Confere a posição e o tamanho de cada texto contra o blob, e que o byte seguinte a cada texto é o
+ * '\0' prometido por text_view.
+ */
+static bool entries_valid(const uint64_t* offsets, const uint32_t* lengths, uint64_t count,
+                          const char* blob, uint64_t blob_size) {
+    for (uint64_t i = 0; i < count; i++) {
+        if (offsets[i] >= blob_size || lengths[i] >= blob_size - offsets[i] || blob[offsets[i] + lengths[i]] != '\0') {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+text_corpus* corpus_file_map(const char* path) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        cerr << "Erro ao abrir " << path << ": " << strerror(errno) << endl;
+        return nullptr;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<uint64_t>(st.st_size) < sizeof(corpus_file_header)) {
+        cerr << "Arquivo de corpus inválido: " << path << endl;
+        close(fd);
+        return nullptr;
+    }
+
+    size_t size = static_cast<size_t>(st.st_size);
+    void* base = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        cerr << "Erro ao mapear " << path << ": " << strerror(errno) << endl;
+        return nullptr;
+    }
+
+    const corpus_file_header* header = static_cast<const corpus_file_header*>(base);
+    if (memcmp(header->magic, CORPUS_FILE_MAGIC, sizeof(header->magic)) == 0 &&
+        header->byte_order == __builtin_bswap32(CORPUS_FILE_BYTE_ORDER)) {
+        cerr << "Arquivo de corpus gravado com outra ordem de bytes: " << path << endl;
+        munmap(base, size);
+        return nullptr;
+    }
+
+    // Cabeçalho e limites de cada seção; depois, cada texto contra o blob
+    bool valid = memcmp(header->magic, CORPUS_FILE_MAGIC, sizeof(header->magic)) == 0
+        && header->version == CORPUS_FILE_VERSION
+        && header->header_size == sizeof(corpus_file_header)
+        && header->byte_order == CORPUS_FILE_BYTE_ORDER
+        && header->count > 0 && header->count <= INT32_MAX
+        && header->offsets_pos <= size && header->lengths_pos <= size
+        && header->offsets_pos % 8 == 0 && header->lengths_pos % 4 == 0
+        && header->offsets_pos + header->count * sizeof(uint64_t) <= header->lengths_pos
+        && header->lengths_pos + header->count * sizeof(uint32_t) <= header->blob_pos
+        && header->blob_pos <= size && header->blob_size <= size - header->blob_pos
+        && header->blob_size > 0 && static_cast<const char*>(base)[header->blob_pos + header->blob_size - 1] == '\0';
+    const char* bytes = static_cast<const char*>(base);
+    valid = valid && entries_valid(reinterpret_cast<const uint64_t*>(bytes + header->offsets_pos),
+                                   reinterpret_cast<const uint32_t*>(bytes + header->lengths_pos),
+                                   header->count, bytes + header->blob_pos, header->blob_size);
+    if (!valid) {
+        cerr << "Arquivo de corpus inválido: " << path << endl;
+        munmap(base, size);
+        return nullptr;
+    }
+
+    // Acesso aleatório: evita leitura antecipada desnecessária durante os sorteios
+    madvise(base, size, MADV_RANDOM);
+
+    mapped_corpus* mapped = new mapped_corpus;
+    char* data = static_cast<char*>(base);
+    mapped->corpus.count = static_cast<int>(header->count);
+    mapped->corpus.size = header->blob_size;
+    mapped->corpus.offsets = reinterpret_cast<uint64_t*>(data + header->offsets_pos);
+    mapped->corpus.lengths = reinterpret_cast<uint32_t*>(data + header->lengths_pos);
+    mapped->corpus.arena = data + header->blob_pos;
+    mapped->base = base;
+    mapped->size = size;
+    return &mapped->corpus;
+}
+
+
+void corpus_file_unmap(const text_corpus* corpus) {
+    if (!corpus) {
+        return;
+    }
+    // corpus é o primeiro membro de mapped_corpus
+    const mapped_corpus* mapped = reinterpret_cast<const mapped_corpus*>(corpus);
+    munmap(mapped->base, mapped->size);
+    delete mapped;
+}
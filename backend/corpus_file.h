@@ -0,0 +1,60 @@
+#ifndef CORPUS_FILE_H
+#define CORPUS_FILE_H
+
+#include <cstdint>
+
+#include "lib_gentexts.h"
+
+/**
+ * Formato binário do corpus persistido (ordem de bytes de quem gravou, seções alinhadas em 8 bytes):
+ *
+ *   [corpus_file_header]
+ *   [uint64_t offsets[count]]   posição de cada texto no blob
+ *   [uint32_t lengths[count]]   tamanho de cada texto, sem o '\0'
+ *   [char blob[blob_size]]      textos terminados por '\0', na mesma disposição da arena
+ *
+ * O layout é idêntico ao de text_corpus, então o arquivo mapeado com mmap é usado diretamente,
+ * sem cópia nem alocação por texto, e suas páginas são compartilhadas entre processos. Por isso
+ * o arquivo só é aceito em uma máquina com a mesma ordem de bytes (campo byte_order).
+ */
+struct corpus_file_header {
+    char magic[8];          // "GENTXT\0\1"
+    uint32_t version;       // CORPUS_FILE_VERSION
+    uint32_t header_size;   // sizeof(corpus_file_header)
+    uint32_t byte_order;    // CORPUS_FILE_BYTE_ORDER, na ordem de bytes de quem gravou
+    uint32_t reserved;      // Zero
+    uint64_t count;         // Número de textos
+    uint64_t blob_size;     // Bytes do blob
+    uint64_t offsets_pos;   // Posição da tabela de offsets no arquivo
+    uint64_t lengths_pos;   // Posição da tabela de tamanhos no arquivo
+    uint64_t blob_pos;      // Posição do blob no arquivo
+};
+
+static const uint32_t CORPUS_FILE_VERSION = 2;
+static const uint32_t CORPUS_FILE_BYTE_ORDER = 0x01020304;
+
+/**
+ * Grava o corpus no formato acima. A escrita é feita em um arquivo temporário de nome único no mesmo
+ * diretório, renomeado ao final (e o diretório sincronizado), então leitores nunca enxergam um arquivo
+ * parcial e gravações simultâneas no mesmo caminho não se misturam.
+ *
+ * @return true em caso de sucesso
+ */
+bool corpus_file_write(const char* path, const text_corpus* corpus);
+
+/**
+ * Mapeia um arquivo de corpus somente para leitura.
+ * O cabeçalho, os limites das seções e a posição, o tamanho e o terminador de cada texto são validados (um
+ * percurso das tabelas): um arquivo corrompido ou truncado é recusado, e os sorteios nunca leem
+ * fora do blob. O blob em si é lido sob demanda pelo sistema operacional.
+ *
+ * @return Corpus apontando para o mapeamento (liberar com corpus_file_unmap), ou nullptr em caso de erro
+ */
+text_corpus* corpus_file_map(const char* path);
+
+/**
+ * Desfaz o mapeamento criado por corpus_file_map().
+ */
+void corpus_file_unmap(const text_corpus* corpus);
+
+#endif
@@ -0,0 +1,184 @@
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "corpus_snapshot.h"
+
+using namespace std;
+
+/**
+ * Reclamação baseada em épocas (estilo RCU/EBR).
+ *
+ * - Cada thread leitora possui um slot exclusivo (alinhado à linha de cache) onde grava a época
+ *   global observada ao entrar em uma seção de leitura, e 0 ao sair. Os leitores nunca escrevem
+ *   em memória compartilhada com outras threads nem usam mutex.
+ * - Ao publicar, o escritor troca o ponteiro atômico, avança a época e coloca o snapshot antigo
+ *   em uma lista de retirados, marcado com a época anterior ao avanço.
+ * - Um snapshot retirado na época R pode ser liberado quando nenhum slot ativo registra época <= R:
+ *   leitores que entraram depois do avanço já enxergam o snapshot novo.
+ */
+
+// MAX_READER_SLOTS: quantidade de threads leitoras com slot próprio. Threads excedentes usam um
+// contador compartilhado, que bloqueia a reclamação enquanto houver alguma delas em leitura.
+static const int MAX_READER_SLOTS = 256;
+
+struct alignas(64) reader_slot {
+    atomic<uint64_t> epoch{0};      // 0 = fora de seção de leitura
+    atomic<bool> in_use{false};
+};
+
+static reader_slot reader_slots[MAX_READER_SLOTS];
+static atomic<int> overflow_readers{0};
+static atomic<uint64_t> global_epoch{1};
+static atomic<corpus_snapshot*> current_snapshot{nullptr};
+
+struct retired_snapshot {
+    corpus_snapshot* snapshot;
+    uint64_t epoch;
+};
+
+// Protege apenas a lista de retirados; usado somente por quem publica ou reclama
+static mutex retired_mutex;
+static vector<retired_snapshot> retired;
+
+// Estado de leitura da thread: slot reservado (-1 = ainda não reservado, -2 = sem slot) e profundidade
+struct thread_reader {
+    int slot = -1;
+    int depth = 0;
+
+    ~thread_reader() {
+        if (slot >= 0) {
+            reader_slots[slot].epoch.store(0, memory_order_release);
+            reader_slots[slot].in_use.store(false, memory_order_release);
+        }
+    }
+};
+
+static thread_local thread_reader this_reader;
+
+
+/**
+ * Reserva um slot livre para a thread chamadora.
+ *
+ * @return Índice do slot, ou -2 se todos estiverem ocupados
+ */
+static int claim_slot() {
+    for (int i = 0; i < MAX_READER_SLOTS; i++) {
+        bool expected = false;
+        if (!reader_slots[i].in_use.load(memory_order_relaxed)
+            && reader_slots[i].in_use.compare_exchange_strong(expected, true, memory_order_acq_rel)) {
+            return i;
+        }
+    }
+    return -2;
+}
+
+
+void snapshot_read_begin() {
+    thread_reader& reader = this_reader;
+    if (reader.depth++ > 0) {
+        return;
+    }
+    if (reader.slot == -1) {
+        reader.slot = claim_slot();
+    }
+    if (reader.slot >= 0) {
+        reader_slots[reader.slot].epoch.store(global_epoch.load(memory_order_acquire), memory_order_relaxed);
+    } else {
+        overflow_readers.fetch_add(1, memory_order_relaxed);
+    }
+    // A época anunciada precisa ser visível antes da leitura do ponteiro do snapshot
+    atomic_thread_fence(memory_order_seq_cst);
+}
+
+
+void snapshot_read_end() {
+    thread_reader& reader = this_reader;
+    if (--reader.depth > 0) {
+        return;
+    }
+    if (reader.slot >= 0) {
+        reader_slots[reader.slot].epoch.store(0, memory_order_release);
+    } else {
+        overflow_readers.fetch_sub(1, memory_order_release);
+    }
+}
+
+
+const corpus_snapshot* snapshot_current() {
+    return current_snapshot.load(memory_order_acquire);
+}
+
+
+/**
+ * Verifica se algum leitor ainda pode enxergar um snapshot retirado na época informada.
+ */
+static bool epoch_in_use(uint64_t epoch) {
+    if (overflow_readers.load(memory_order_seq_cst) > 0) {
+        return true;
+    }
+    for (int i = 0; i < MAX_READER_SLOTS; i++) {
+        uint64_t seen = reader_slots[i].epoch.load(memory_order_seq_cst);
+        if (seen != 0 && seen <= epoch) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+static void release_snapshot(corpus_snapshot* snapshot) {
+    if (snapshot->release) {
+        snapshot->release(snapshot->corpus);
+    }
+    delete snapshot;
+}
+
+
+/**
+ * Libera os retirados que já não podem ser vistos. Exige retired_mutex.
+ */
+static void reclaim_locked() {
+    size_t kept = 0;
+    for (size_t i = 0; i < retired.size(); i++) {
+        if (epoch_in_use(retired[i].epoch)) {
+            retired[kept++] = retired[i];
+        } else {
+            release_snapshot(retired[i].snapshot);
+        }
+    }
+    retired.resize(kept);
+}
+
+
+void snapshot_publish(corpus_snapshot* next) {
+    lock_guard<mutex> lock(retired_mutex);
+    corpus_snapshot* previous = current_snapshot.exchange(next, memory_order_seq_cst);
+    uint64_t epoch = global_epoch.fetch_add(1, memory_order_seq_cst);
+    atomic_thread_fence(memory_order_seq_cst);
+    if (previous) {
+        retired.push_back({previous, epoch});
+    }
+    reclaim_locked();
+}
+
+
+void snapshot_reclaim() {
+    lock_guard<mutex> lock(retired_mutex);
+    reclaim_locked();
+}
+
+
+void snapshot_synchronize() {
+    for (;;) {
+        {
+            lock_guard<mutex> lock(retired_mutex);
+            reclaim_locked();
+            if (retired.empty()) {
+                return;
+            }
+        }
+        this_thread::yield();
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef CORPUS_SNAPSHOT_H
+#define CORPUS_SNAPSHOT_H
+
+#include <cstdint>
+#include <functional>
+
+#include "lib_gentexts.h"
+
+struct packed_corpus;
+
+/**
+ * Snapshot imutável de um corpus publicado para os leitores.
+ * O corpus nunca é alterado depois de publicado; uma atualização publica um novo snapshot
+ * e o anterior é liberado (release) somente quando nenhum leitor pode mais enxergá-lo.
+ */
+struct corpus_snapshot {
+    const text_corpus* corpus;                         // Textos (arena e tabela de offsets), ou nullptr se compactado
+    uint64_t version;                                  // Número sequencial da publicação
+    std::function<void(const text_corpus*)> release;   // Libera os recursos de origem do corpus
+    const packed_corpus* packed = nullptr;             // Textos compactados em 5 bits (quando corpus é nullptr)
+    int count = 0;                                     // Número de textos (em qualquer das representações)
+};
+
+/**
+ * Entra em uma seção de leitura. Enquanto a thread estiver na seção, o snapshot obtido por
+ * snapshot_current() (e qualquer ponteiro para o seu conteúdo) continua válido.
+ * Não usa mutex: apenas grava a época atual no slot exclusivo da thread. Seções podem ser aninhadas.
+ */
+void snapshot_read_begin();
+
+/**
+ * Sai da seção de leitura iniciada por snapshot_read_begin().
+ */
+void snapshot_read_end();
+
+/**
+ * Retorna o snapshot publicado (ou nullptr se não houver). Deve ser chamada dentro de uma seção de leitura.
+ */
+const corpus_snapshot* snapshot_current();
+
+/**
+ * Publica um novo snapshot (ou nullptr para retirar o atual) e retira o anterior.
+ * O anterior é liberado assim que todos os leitores que podiam vê-lo saírem de suas seções.
+ * Pode ser chamada concorrentemente com leitores; publicações concorrentes são serializadas.
+ *
+ * @param next Snapshot a publicar (a função assume sua posse)
+ */
+void snapshot_publish(corpus_snapshot* next);
+
+/**
+ * Libera os snapshots retirados que nenhum leitor pode mais enxergar, sem bloquear.
+ */
+void snapshot_reclaim();
+
+/**
+ * Espera até que todos os leitores atuais saiam de suas seções e libera todos os snapshots retirados.
+ * Não deve ser chamada de dentro de uma seção de leitura.
+ */
+void snapshot_synchronize();
+
+/**
+ * Seção de leitura no estilo RAII.
+ */
+class snapshot_read_guard {
+public:
+    snapshot_read_guard() { snapshot_read_begin(); }
+    ~snapshot_read_guard() { snapshot_read_end(); }
+    snapshot_read_guard(const snapshot_read_guard&) = delete;
+    snapshot_read_guard& operator=(const snapshot_read_guard&) = delete;
+};
+
+#endif
@@ -0,0 +1,370 @@
+#include <iostream>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <curl/curl.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include "fetch_engine.h"
+#include "http_client.h"
+#include "trace.h"
+
+using namespace std;
+
+// Máximo de handles ociosos guardados para reutilização
+static const size_t FETCH_IDLE_HANDLES = 16;
+
+// Tempo máximo para estabelecer a conexão, como em http_client.cpp (o padrão da libcurl é 300 s)
+static const long FETCH_CONNECT_TIMEOUT_MS = 3000;
+
+/**
+ * Uma requisição em andamento, ligada ao seu handle por CURLOPT_PRIVATE.
+ */
+struct fetch_request {
+    CURL* curl = nullptr;
+    string url;
+    http_buffer body;
+    fetch_done_fn done;
+    char error[CURL_ERROR_SIZE] = {0};
+};
+
+struct fetch_engine {
+    CURLM* multi = nullptr;
+    fetch_loop_ops ops;
+    curl_slist* headers = nullptr;
+    vector<CURL*> idle;
+    vector<fetch_request*> active;
+};
+
+
+static size_t write_callback(void* contents, size_t size, size_t nmemb, void* userp) {
+    size_t total = size * nmemb;
+    if (!http_buffer_append(static_cast<http_buffer*>(userp), static_cast<const char*>(contents), total)) {
+        return 0;
+    }
+    return total;
+}
+
+
+/**
+ * Repassa ao laço de eventos os sockets que a libcurl quer observar.
+ */
+static int socket_callback(CURL*, curl_socket_t fd, int what, void* userp, void*) {
+    fetch_engine* engine = static_cast<fetch_engine*>(userp);
+    int events = 0;
+    if (what == CURL_POLL_IN || what == CURL_POLL_INOUT) {
+        events |= FETCH_EVENT_READ;
+    }
+    if (what == CURL_POLL_OUT || what == CURL_POLL_INOUT) {
+        events |= FETCH_EVENT_WRITE;
+    }
+    engine->ops.watch_socket(engine->ops.user, static_cast<int>(fd), events);
+    return 0;
+}
+
+
+/**
+ * Repassa ao laço de eventos o prazo do próximo timeout da libcurl.
+ */
+static int timer_callback(CURLM*, long timeout_ms, void* userp) {
+    fetch_engine* engine = static_cast<fetch_engine*>(userp);
+    engine->ops.set_timer(engine->ops.user, timeout_ms);
+    return 0;
+}
+
+
+/**
+ * Devolve o handle para reutilização pela próxima requisição ou o libera.
+ */
+static void recycle_handle(fetch_engine* engine, CURL* curl) {
+    if (engine->idle.size() < FETCH_IDLE_HANDLES) {
+        curl_easy_reset(curl);
+        engine->idle.push_back(curl);
+    } else {
+        curl_easy_cleanup(curl);
+    }
+}
+
+
+/**
+ * Recolhe as requisições concluídas e chama seus callbacks.
+ * Os callbacks rodam depois que a libcurl retornou, então podem iniciar novas requisições.
+ */
+static void dispatch_completed(fetch_engine* engine) {
+    int queued = 0;
+    while (CURLMsg* message = curl_multi_info_read(engine->multi, &queued)) {
+        if (message->msg != CURLMSG_DONE) {
+            continue;
+        }
+        CURL* curl = message->easy_handle;
+        CURLcode code = message->data.result;
+
+        fetch_request* request = nullptr;
+        curl_easy_getinfo(curl, CURLINFO_PRIVATE, &request);
+
+        fetch_result result{};
+        result.url = request->url.c_str();
+        result.ok = code == CURLE_OK;
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &result.status);
+        curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME, &result.total_seconds);
+        result.error = result.ok ? "" : (request->error[0] ? request->error : curl_easy_strerror(code));
+        result.body = request->body.data ? request->body.data : "";
+        result.length = request->body.length;
+
+        curl_multi_remove_handle(engine->multi, curl);
+        recycle_handle(engine, curl);
+        for (fetch_request*& entry : engine->active) {
+            if (entry == request) {
+                entry = engine->active.back();
+                engine->active.pop_back();
+                break;
+            }
+        }
+
+        {
+            TRACE_SCOPE("fetch_done");
+            request->done(result);
+        }
+        http_buffer_free(&request->body);
+        delete request;
+    }
+}
+
+
+fetch_engine* fetch_engine_create(const fetch_loop_ops* ops) {
+    http_global_init();
+
+    fetch_engine* engine = new fetch_engine;
+    engine->ops = *ops;
+    engine->multi = curl_multi_init();
+    if (!engine->multi) {
+        cerr << "Erro ao criar o handle curl_multi" << endl;
+        delete engine;
+        return nullptr;
+    }
+    curl_multi_setopt(engine->multi, CURLMOPT_SOCKETFUNCTION, socket_callback);
+    curl_multi_setopt(engine->multi, CURLMOPT_SOCKETDATA, engine);
+    curl_multi_setopt(engine->multi, CURLMOPT_TIMERFUNCTION, timer_callback);
+    curl_multi_setopt(engine->multi, CURLMOPT_TIMERDATA, engine);
+
+    engine->headers = curl_slist_append(engine->headers, "Accept: application/json");
+    engine->headers = curl_slist_append(engine->headers, "User-Agent: Mozilla/5.0");
+    return engine;
+}
+
+
+void fetch_engine_destroy(fetch_engine* engine) {
+    if (!engine) {
+        return;
+    }
+
+    // Requisições pendentes são canceladas sem chamar os callbacks
+    for (fetch_request* request : engine->active) {
+        curl_multi_remove_handle(engine->multi, request->curl);
+        curl_easy_cleanup(request->curl);
+        http_buffer_free(&request->body);
+        delete request;
+    }
+
+    for (CURL* curl : engine->idle) {
+        curl_easy_cleanup(curl);
+    }
+    curl_multi_cleanup(engine->multi);
+    curl_slist_free_all(engine->headers);
+    delete engine;
+}
+
+
+bool fetch_engine_get(fetch_engine* engine, const char* url, fetch_done_fn done, long timeout_ms) {
+    CURL* curl = nullptr;
+    if (!engine->idle.empty()) {
+        curl = engine->idle.back();
+        engine->idle.pop_back();
+    } else {
+        curl = curl_easy_init();
+        if (!curl) {
+            return false;
+        }
+    }
+
+    fetch_request* request = new fetch_request;
+    request->curl = curl;
+    request->url = url;
+    request->done = move(done);
+
+    curl_easy_setopt(curl, CURLOPT_URL, url);
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, engine->headers);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &request->body);
+    curl_easy_setopt(curl, CURLOPT_PRIVATE, request);
+    curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, request->error);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, timeout_ms);
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, FETCH_CONNECT_TIMEOUT_MS);
+
+    // A libcurl arma o timer pelo timer_callback; o laço inicia a transferência quando ele vencer
+    CURLMcode code = curl_multi_add_handle(engine->multi, curl);
+    if (code != CURLM_OK) {
+        cerr << "Erro ao iniciar requisição assíncrona: " << curl_multi_strerror(code) << endl;
+        curl_easy_cleanup(curl);
+        delete request;
+        return false;
+    }
+    engine->active.push_back(request);
+    return true;
+}
+
+
+void fetch_engine_socket_action(fetch_engine* engine, int fd, int events) {
+    int mask = 0;
+    if (events & FETCH_EVENT_READ) {
+        mask |= CURL_CSELECT_IN;
+    }
+    if (events & FETCH_EVENT_WRITE) {
+        mask |= CURL_CSELECT_OUT;
+    }
+    if (events & FETCH_EVENT_ERROR) {
+        mask |= CURL_CSELECT_ERR;
+    }
+    int running = 0;
+    curl_multi_socket_action(engine->multi, static_cast<curl_socket_t>(fd), mask, &running);
+    dispatch_completed(engine);
+}
+
+
+void fetch_engine_timeout(fetch_engine* engine) {
+    int running = 0;
+    curl_multi_socket_action(engine->multi, CURL_SOCKET_TIMEOUT, 0, &running);
+    dispatch_completed(engine);
+}
+
+
+size_t fetch_engine_pending(const fetch_engine* engine) {
+    return engine->active.size();
+}
+
+
+struct fetch_epoll_loop {
+    int epoll_fd = -1;
+    fetch_engine* engine = nullptr;
+    bool timer_armed = false;
+    chrono::steady_clock::time_point deadline;
+};
+
+
+static void epoll_watch_socket(void* user, int fd, int events) {
+    fetch_epoll_loop* loop = static_cast<fetch_epoll_loop*>(user);
+    if (events == 0) {
+        epoll_ctl(loop->epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+        return;
+    }
+    epoll_event event{};
+    event.data.fd = fd;
+    event.events = ((events & FETCH_EVENT_READ) ? static_cast<uint32_t>(EPOLLIN) : 0u)
+        | ((events & FETCH_EVENT_WRITE) ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+    if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_MOD, fd, &event) != 0 && errno == ENOENT) {
+        epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, fd, &event);
+    }
+}
+
+
+static void epoll_set_timer(void* user, long timeout_ms) {
+    fetch_epoll_loop* loop = static_cast<fetch_epoll_loop*>(user);
+    loop->timer_armed = timeout_ms >= 0;
+    if (loop->timer_armed) {
+        loop->deadline = chrono::steady_clock::now() + chrono::milliseconds(timeout_ms);
+    }
+}
+
+
+fetch_epoll_loop* fetch_epoll_create() {
+    fetch_epoll_loop* loop = new fetch_epoll_loop;
+    loop->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (loop->epoll_fd < 0) {
+        cerr << "Erro ao criar epoll: " << strerror(errno) << endl;
+        delete loop;
+        return nullptr;
+    }
+    fetch_loop_ops ops{loop, epoll_watch_socket, epoll_set_timer};
+    loop->engine = fetch_engine_create(&ops);
+    if (!loop->engine) {
+        close(loop->epoll_fd);
+        delete loop;
+        return nullptr;
+    }
+    return loop;
+}
+
+
+void fetch_epoll_destroy(fetch_epoll_loop* loop) {
+    if (!loop) {
+        return;
+    }
+    fetch_engine_destroy(loop->engine);
+    close(loop->epoll_fd);
+    delete loop;
+}
+
+
+fetch_engine* fetch_epoll_engine(fetch_epoll_loop* loop) {
+    return loop->engine;
+}
+
+
+int fetch_epoll_run_once(fetch_epoll_loop* loop, int max_wait_ms) {
+    // Espera até o próximo evento de socket ou o vencimento do timer da libcurl, o que vier primeiro
+    int wait_ms = max_wait_ms;
+    if (loop->timer_armed) {
+        auto remaining = chrono::ceil<chrono::milliseconds>(loop->deadline - chrono::steady_clock::now()).count();
+        if (remaining < 0) {
+            remaining = 0;
+        }
+        if (wait_ms < 0 || remaining < wait_ms) {
+            wait_ms = static_cast<int>(remaining);
+        }
+    }
+
+    epoll_event events[64];
+    int ready = epoll_wait(loop->epoll_fd, events, 64, wait_ms);
+    if (ready < 0) {
+        if (errno == EINTR) {
+            return static_cast<int>(fetch_engine_pending(loop->engine));
+        }
+        cerr << "Erro no epoll_wait: " << strerror(errno) << endl;
+        return -1;
+    }
+
+    for (int i = 0; i < ready; i++) {
+        int flags = 0;
+        if (events[i].events & EPOLLIN) {
+            flags |= FETCH_EVENT_READ;
+        }
+        if (events[i].events & EPOLLOUT) {
+            flags |= FETCH_EVENT_WRITE;
+        }
+        if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+            flags |= FETCH_EVENT_ERROR;
+        }
+        fetch_engine_socket_action(loop->engine, events[i].data.fd, flags);
+    }
+
+    if (loop->timer_armed && chrono::steady_clock::now() >= loop->deadline) {
+        loop->timer_armed = false;
+        fetch_engine_timeout(loop->engine);
+    }
+    return static_cast<int>(fetch_engine_pending(loop->engine));
+}
+
+
+bool fetch_epoll_run(fetch_epoll_loop* loop) {
+    while (fetch_engine_pending(loop->engine) > 0) {
+        if (fetch_epoll_run_once(loop, -1) < 0) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,120 @@
+#ifndef FETCH_ENGINE_H
+#define FETCH_ENGINE_H
+
+#include <cstddef>
+#include <functional>
+
+/**
+ * Motor de requisições HTTP assíncronas sobre curl_multi (interface de sockets).
+ *
+ * O motor não possui laço de eventos próprio: ele informa, pelas funções de fetch_loop_ops, quais
+ * sockets devem ser observados e quando o próximo timeout vence, e o laço de eventos do chamador
+ * (Qt, epoll, ...) devolve a prontidão com fetch_engine_socket_action() e fetch_engine_timeout().
+ * Assim, qualquer número de requisições simultâneas roda em uma única thread, sem bloqueá-la.
+ *
+ * Um motor pertence à thread do seu laço de eventos: todas as funções devem ser chamadas nela, e os
+ * callbacks de conclusão também executam nela.
+ */
+struct fetch_engine;
+
+// Eventos de prontidão de um socket (combinados com |); 0 em watch_socket significa "parar de observar"
+enum {
+    FETCH_EVENT_READ = 1,
+    FETCH_EVENT_WRITE = 2,
+    FETCH_EVENT_ERROR = 4,
+};
+
+/**
+ * Integração com o laço de eventos.
+ * watch_socket: passa a observar `fd` para os eventos indicados (substituindo os anteriores), ou deixa
+ * de observá-lo se events == 0. set_timer: (re)arma o timer único do motor; timeout_ms < 0 o desarma.
+ * Nenhuma das duas deve chamar o motor de volta diretamente: o laço faz isso quando o evento ocorrer.
+ */
+struct fetch_loop_ops {
+    void* user;
+    void (*watch_socket)(void* user, int fd, int events);
+    void (*set_timer)(void* user, long timeout_ms);
+};
+
+/**
+ * Resultado de uma requisição concluída. Os ponteiros valem apenas durante o callback.
+ */
+struct fetch_result {
+    const char* url;
+    bool ok;                    // Transferência concluída (qualquer código HTTP)
+    long status;                // Código HTTP (0 se não houve resposta)
+    const char* error;          // Mensagem de erro quando !ok
+    const char* body;           // Corpo da resposta, terminado por '\0'
+    size_t length;              // Tamanho do corpo
+    double total_seconds;       // Duração da transferência
+};
+
+using fetch_done_fn = std::function<void(const fetch_result&)>;
+
+/**
+ * Cria um motor integrado ao laço descrito por `ops` (copiado).
+ *
+ * @return Motor ou nullptr em caso de erro
+ */
+fetch_engine* fetch_engine_create(const fetch_loop_ops* ops);
+
+/**
+ * Cancela as requisições pendentes (sem chamar seus callbacks) e libera o motor.
+ * Não deve ser chamada de dentro de um callback de conclusão.
+ */
+void fetch_engine_destroy(fetch_engine* engine);
+
+/**
+ * Inicia um GET. O callback é chamado uma única vez, na conclusão ou falha da requisição.
+ * Conexões abertas são mantidas e reutilizadas pelas requisições seguintes ao mesmo servidor.
+ *
+ * @param timeout_ms Tempo máximo da requisição (0 = sem limite)
+ * @return true se a requisição foi iniciada; false em caso de erro (o callback não é chamado)
+ */
+bool fetch_engine_get(fetch_engine* engine, const char* url, fetch_done_fn done, long timeout_ms = 0);
+
+/**
+ * Informa ao motor que `fd` ficou pronto (eventos FETCH_EVENT_*). Pode disparar callbacks de conclusão.
+ */
+void fetch_engine_socket_action(fetch_engine* engine, int fd, int events);
+
+/**
+ * Informa ao motor que o timer armado por set_timer venceu. Pode disparar callbacks de conclusão.
+ */
+void fetch_engine_timeout(fetch_engine* engine);
+
+/**
+ * Número de requisições em andamento.
+ */
+size_t fetch_engine_pending(const fetch_engine* engine);
+
+
+/**
+ * Laço de eventos simples baseado em epoll, para uso sem interface gráfica.
+ * Cria e possui o seu próprio fetch_engine.
+ */
+struct fetch_epoll_loop;
+
+fetch_epoll_loop* fetch_epoll_create();
+void fetch_epoll_destroy(fetch_epoll_loop* loop);
+
+/**
+ * Motor associado ao laço, para iniciar requisições com fetch_engine_get().
+ */
+fetch_engine* fetch_epoll_engine(fetch_epoll_loop* loop);
+
+/**
+ * Espera por eventos por até `max_wait_ms` (-1 = até o próximo evento) e os despacha.
+ *
+ * @return Número de requisições ainda pendentes, ou -1 em caso de erro
+ */
+int fetch_epoll_run_once(fetch_epoll_loop* loop, int max_wait_ms);
+
+/**
+ * Despacha eventos até que não haja mais requisições pendentes.
+ *
+ * @return true em caso de sucesso; false se o epoll falhou
+ */
+bool fetch_epoll_run(fetch_epoll_loop* loop);
+
+#endif
@@ -0,0 +1,221 @@
+#include <iostream>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <vector>
+#include <curl/curl.h>
+
+#include "http_client.h"
+#include "trace.h"
+
+using namespace std;
+
+static const size_t HTTP_BUFFER_MIN_CAPACITY = 4096;
+
+// Tempo máximo para estabelecer a conexão (o padrão da libcurl é 300 s)
+static const long HTTP_CONNECT_TIMEOUT_MS = 3000;
+
+/**
+ * Handle CURL de uma thread, reutilizado em todas as requisições dela.
+ * O destrutor roda na saída da thread e devolve o handle, se http_client_cleanup() ainda não o fez.
+ */
+struct http_handle_slot {
+    CURL* curl = nullptr;
+    curl_slist* headers = nullptr;
+    ~http_handle_slot();
+};
+
+// Handles de todas as threads e o cache compartilhado (DNS e sessões TLS)
+static mutex clients_mutex;
+static vector<http_handle_slot*> slots;
+static CURLSH* share = nullptr;
+
+// Um mutex por tipo de dado compartilhado, para que o DNS e as sessões TLS não disputem o mesmo lock
+static mutex share_locks[CURL_LOCK_DATA_LAST];
+
+static once_flag global_init_once;
+
+static thread_local http_handle_slot thread_slot;
+
+
+bool http_buffer_append(http_buffer* buffer, const char* data, size_t length) {
+    size_t required = buffer->length + length + 1;
+    if (required > buffer->capacity) {
+        size_t capacity = max(max(buffer->capacity * 2, required), HTTP_BUFFER_MIN_CAPACITY);
+        char* grown = static_cast<char*>(realloc(buffer->data, capacity));
+        if (!grown) {
+            return false;
+        }
+        buffer->data = grown;
+        buffer->capacity = capacity;
+    }
+    memcpy(buffer->data + buffer->length, data, length);
+    buffer->length += length;
+    buffer->data[buffer->length] = '\0';
+    return true;
+}
+
+
+void http_buffer_clear(http_buffer* buffer) {
+    buffer->length = 0;
+    if (buffer->data) {
+        buffer->data[0] = '\0';
+    }
+}
+
+
+void http_buffer_free(http_buffer* buffer) {
+    free(buffer->data);
+    buffer->data = nullptr;
+    buffer->length = 0;
+    buffer->capacity = 0;
+}
+
+
+/**
+ * Função de callback utilizada pela libcurl para escrever os dados recebidos.
+ * Acrescenta os bytes ao http_buffer passado via CURLOPT_WRITEDATA; retornar um valor diferente
+ * de size * nmemb (falha de alocação) faz a libcurl abortar a transferência.
+ */
+static size_t write_callback(void* contents, size_t size, size_t nmemb, void* userp) {
+    size_t total = size * nmemb;
+    if (!http_buffer_append(static_cast<http_buffer*>(userp), static_cast<const char*>(contents), total)) {
+        return 0;
+    }
+    return total;
+}
+
+
+static void share_lock(CURL*, curl_lock_data data, curl_lock_access, void*) {
+    share_locks[data].lock();
+}
+
+
+static void share_unlock(CURL*, curl_lock_data data, void*) {
+    share_locks[data].unlock();
+}
+
+
+/**
+ * Cria o cache compartilhado entre as threads. Chamada com clients_mutex travado.
+ * O pool de conexões (CURL_LOCK_DATA_CONNECT) não é compartilhado: a libcurl não admite seu uso
+ * simultâneo por handles de threads diferentes. Cada handle mantém o seu, com keep-alive.
+ */
+static CURLSH* create_share_locked() {
+    CURLSH* created = curl_share_init();
+    if (!created) {
+        return nullptr;
+    }
+    curl_share_setopt(created, CURLSHOPT_LOCKFUNC, share_lock);
+    curl_share_setopt(created, CURLSHOPT_UNLOCKFUNC, share_unlock);
+    curl_share_setopt(created, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(created, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    return created;
+}
+
+
+void http_global_init() {
+    call_once(global_init_once, []() { curl_global_init(CURL_GLOBAL_DEFAULT); });
+}
+
+
+/**
+ * Retorna o handle da thread chamadora, criando-o (e o cache compartilhado) no primeiro uso.
+ * As opções fixas (cabeçalhos, keep-alive, callback) são definidas uma única vez por handle.
+ *
+ * @return Handle pronto para uso ou nullptr em caso de erro
+ */
+static CURL* thread_handle() {
+    http_handle_slot& slot = thread_slot;
+    if (slot.curl) {
+        return slot.curl;
+    }
+
+    http_global_init();
+
+    lock_guard<mutex> lock(clients_mutex);
+    if (!share) {
+        share = create_share_locked();
+        if (!share) {
+            cerr << "Erro ao criar o cache compartilhado da libcurl" << endl;
+            return nullptr;
+        }
+    }
+
+    CURL* curl = curl_easy_init();
+    if (!curl) {
+        return nullptr;
+    }
+
+    // Adiciona cabeçalhos HTTP
+    curl_slist* headers = nullptr;
+    headers = curl_slist_append(headers, "Accept: application/json");
+    headers = curl_slist_append(headers, "User-Agent: Mozilla/5.0");
+
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    curl_easy_setopt(curl, CURLOPT_SHARE, share);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, HTTP_CONNECT_TIMEOUT_MS);
+    // Sem sinais: o handle é usado fora da thread principal
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+
+    slot.curl = curl;
+    slot.headers = headers;
+    slots.push_back(&slot);
+    return curl;
+}
+
+
+http_handle_slot::~http_handle_slot() {
+    lock_guard<mutex> lock(clients_mutex);
+    if (!curl) {
+        return;
+    }
+    curl_easy_cleanup(curl);
+    curl_slist_free_all(headers);
+    slots.erase(remove(slots.begin(), slots.end(), this), slots.end());
+}
+
+
+bool http_get(const char* url, http_buffer* response, long* status, long timeout_ms) {
+    TRACE_SCOPE("http_get");
+    CURL* curl = thread_handle();
+    if (!curl) {
+        return false;
+    }
+
+    http_buffer_clear(response);
+    curl_easy_setopt(curl, CURLOPT_URL, url);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, response);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, timeout_ms);
+
+    // Executa a requisição HTTP (reaproveitando a conexão aberta, se houver)
+    CURLcode res = curl_easy_perform(curl);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, nullptr);
+    if (res != CURLE_OK) {
+        cerr << "[CURL ERROR] " << curl_easy_strerror(res) << " (code: " << res << ")" << endl;
+        return false;
+    }
+    if (status) {
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, status);
+    }
+    return true;
+}
+
+
+void http_client_cleanup() {
+    lock_guard<mutex> lock(clients_mutex);
+    for (http_handle_slot* slot : slots) {
+        curl_easy_cleanup(slot->curl);
+        curl_slist_free_all(slot->headers);
+        slot->curl = nullptr;
+        slot->headers = nullptr;
+    }
+    slots.clear();
+    if (share) {
+        curl_share_cleanup(share);
+        share = nullptr;
+    }
+}
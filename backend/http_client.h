@@ -0,0 +1,63 @@
+#ifndef HTTP_CLIENT_H
+#define HTTP_CLIENT_H
+
+#include <cstddef>
+
+/**
+ * Buffer de resposta crescente, com tamanho conhecido (sem strlen nem strcat).
+ * O conteúdo é sempre terminado por '\0', mas pode conter bytes nulos antes de `length`.
+ * A capacidade é mantida entre requisições, então um buffer reutilizado não realoca.
+ */
+struct http_buffer {
+    char* data = nullptr;
+    size_t length = 0;
+    size_t capacity = 0;
+};
+
+/**
+ * Acrescenta bytes ao buffer, crescendo geometricamente (custo amortizado linear).
+ *
+ * @return true em caso de sucesso; false se a memória não pôde ser alocada
+ */
+bool http_buffer_append(http_buffer* buffer, const char* data, size_t length);
+
+/**
+ * Esvazia o buffer, mantendo a memória alocada.
+ */
+void http_buffer_clear(http_buffer* buffer);
+
+/**
+ * Libera a memória do buffer.
+ */
+void http_buffer_free(http_buffer* buffer);
+
+/**
+ * Inicializa a libcurl (curl_global_init) uma única vez no processo, de qualquer thread. Chamada pelo
+ * cliente síncrono e pelo fetch_engine antes de criar seus handles; a inicialização vale até o fim
+ * do processo.
+ */
+void http_global_init();
+
+/**
+ * Executa um GET e grava o corpo da resposta em `response` (esvaziado antes).
+ *
+ * Cada thread reutiliza o seu próprio handle CURL, com keep-alive: requisições seguintes ao mesmo
+ * servidor aproveitam a conexão já aberta pela thread. O cache de DNS e as sessões TLS são
+ * compartilhados entre as threads (curl_share), então uma thread nova não repete a resolução de nomes
+ * e retoma a sessão TLS de um servidor já visitado. A conexão tem até 3 s para ser estabelecida.
+ *
+ * @param url URL de destino
+ * @param response Destino do corpo da resposta
+ * @param status Se não nulo, recebe o código HTTP da resposta
+ * @param timeout_ms Tempo máximo da requisição (0 = sem limite)
+ * @return true se a transferência foi concluída (qualquer código HTTP); false em erro de rede
+ */
+bool http_get(const char* url, http_buffer* response, long* status = nullptr, long timeout_ms = 0);
+
+/**
+ * Libera os handles de todas as threads e o cache compartilhado.
+ * Não deve haver requisições em andamento; uma chamada posterior a http_get() recria o cliente.
+ */
+void http_client_cleanup();
+
+#endif
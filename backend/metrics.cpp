@@ -0,0 +1,521 @@
+#include <iostream>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "metrics.h"
+#include "unix_socket.h"
+
+using namespace std;
+
+enum metric_type {
+    METRIC_COUNTER,
+    METRIC_GAUGE,
+    METRIC_HISTOGRAM,
+};
+
+/**
+ * Medidor em uma linha de cache própria: medidores atualizados por threads diferentes não disputam a linha.
+ */
+struct alignas(64) gauge_cell {
+    atomic<int64_t> value{0};
+};
+
+struct metric_info {
+    string name;                // Com os rótulos
+    string family;              // Nome sem os rótulos
+    string labels;              // Conteúdo entre as chaves (sem elas)
+    string help;
+    metric_type type;
+    uint32_t slot = METRICS_NO_SLOT;
+    double scale = 1.0;
+    gauge_cell* gauge = nullptr;
+};
+
+/**
+ * Métricas registradas e blocos das threads. Criado no primeiro uso e nunca destruído: métricas são
+ * registradas por objetos estáticos de outros arquivos, e threads podem gravar durante a destruição deles.
+ */
+struct metrics_registry {
+    mutex lock;
+    vector<metric_info> metrics;
+    uint32_t next_slot = 0;
+    vector<atomic<uint64_t>*> shards;       // Todos os blocos já criados
+    vector<atomic<uint64_t>*> free_shards;  // Blocos de threads encerradas, à espera de uma nova thread
+};
+
+static metrics_registry& registry() {
+    static metrics_registry* instance = new metrics_registry;
+    return *instance;
+}
+
+thread_local atomic<uint64_t>* metrics_thread_slots = nullptr;
+
+/**
+ * Devolve o bloco da thread ao registro quando ela termina.
+ */
+struct shard_release {
+    ~shard_release() {
+        if (metrics_thread_slots) {
+            metrics_registry& reg = registry();
+            lock_guard<mutex> lock(reg.lock);
+            reg.free_shards.push_back(metrics_thread_slots);
+            metrics_thread_slots = nullptr;
+        }
+    }
+};
+
+static thread_local shard_release thread_release;
+
+
+atomic<uint64_t>* metrics_attach_thread() {
+    // Garante a construção do objeto que devolve o bloco no fim da thread
+    (void)&thread_release;
+    metrics_registry& reg = registry();
+    lock_guard<mutex> lock(reg.lock);
+    if (!reg.free_shards.empty()) {
+        metrics_thread_slots = reg.free_shards.back();
+        reg.free_shards.pop_back();
+        return metrics_thread_slots;
+    }
+    // Alinhado e com tamanho múltiplo de 64 bytes: blocos de threads diferentes nunca dividem uma linha
+    void* memory = aligned_alloc(64, METRICS_THREAD_SLOTS * sizeof(atomic<uint64_t>));
+    if (!memory) {
+        throw bad_alloc();
+    }
+    atomic<uint64_t>* slots = static_cast<atomic<uint64_t>*>(memory);
+    for (uint32_t i = 0; i < METRICS_THREAD_SLOTS; i++) {
+        new (&slots[i]) atomic<uint64_t>(0);
+    }
+    reg.shards.push_back(slots);
+    metrics_thread_slots = slots;
+    return slots;
+}
+
+
+/**
+ * Registra ou encontra a métrica `name`. Exige reg.lock.
+ */
+static metric_info* register_locked(metrics_registry& reg, const char* name, const char* help, metric_type type,
+                                    uint32_t slots) {
+    for (metric_info& metric : reg.metrics) {
+        if (metric.name == name) {
+            if (metric.type != type) {
+                cerr << "Métrica já registrada com outro tipo: " << name << endl;
+                return nullptr;
+            }
+            return &metric;
+        }
+    }
+    metric_info metric;
+    metric.name = name;
+    size_t brace = metric.name.find('{');
+    metric.family = metric.name.substr(0, brace);
+    if (brace != string::npos && metric.name.back() == '}') {
+        metric.labels = metric.name.substr(brace + 1, metric.name.size() - brace - 2);
+    }
+    for (const metric_info& other : reg.metrics) {
+        if (other.family == metric.family && other.type != type) {
+            cerr << "Família de métricas já registrada com outro tipo: " << metric.family << endl;
+            return nullptr;
+        }
+    }
+    if (slots > METRICS_THREAD_SLOTS - reg.next_slot) {
+        cerr << "Sem posições para a métrica " << name << " (" << reg.next_slot << " de " << METRICS_THREAD_SLOTS
+             << " em uso): aumente METRICS_THREAD_SLOTS" << endl;
+        abort();
+    }
+    metric.help = help ? help : "";
+    metric.type = type;
+    if (slots > 0) {
+        metric.slot = reg.next_slot;
+        reg.next_slot += slots;
+    }
+    reg.metrics.push_back(metric);
+    return &reg.metrics.back();
+}
+
+
+metric_counter metrics_counter(const char* name, const char* help) {
+    metrics_registry& reg = registry();
+    lock_guard<mutex> lock(reg.lock);
+    metric_counter counter;
+    if (metric_info* metric = register_locked(reg, name, help, METRIC_COUNTER, 1)) {
+        counter.slot = metric->slot;
+    }
+    return counter;
+}
+
+
+metric_gauge metrics_gauge(const char* name, const char* help) {
+    metrics_registry& reg = registry();
+    lock_guard<mutex> lock(reg.lock);
+    metric_gauge gauge;
+    if (metric_info* metric = register_locked(reg, name, help, METRIC_GAUGE, 0)) {
+        if (!metric->gauge) {
+            metric->gauge = new gauge_cell;
+        }
+        gauge.value = &metric->gauge->value;
+    }
+    return gauge;
+}
+
+
+metric_histogram metrics_histogram(const char* name, const char* help, double scale) {
+    metrics_registry& reg = registry();
+    lock_guard<mutex> lock(reg.lock);
+    metric_histogram histogram;
+    if (metric_info* metric = register_locked(reg, name, help, METRIC_HISTOGRAM, METRICS_HISTOGRAM_BUCKETS + 1)) {
+        metric->scale = scale;
+        histogram.slot = metric->slot;
+    }
+    return histogram;
+}
+
+
+/**
+ * Soma uma posição sobre os blocos de todas as threads. Exige reg.lock.
+ */
+static uint64_t sum_slot_locked(const metrics_registry& reg, uint32_t slot) {
+    uint64_t total = 0;
+    for (const atomic<uint64_t>* shard : reg.shards) {
+        total += shard[slot].load(memory_order_relaxed);
+    }
+    return total;
+}
+
+
+static void read_histogram_locked(const metrics_registry& reg, uint32_t slot, metrics_histogram_snapshot* snapshot) {
+    snapshot->count = 0;
+    for (uint32_t i = 0; i < METRICS_HISTOGRAM_BUCKETS; i++) {
+        snapshot->buckets[i] = sum_slot_locked(reg, slot + i);
+        snapshot->count += snapshot->buckets[i];
+    }
+    snapshot->sum = sum_slot_locked(reg, slot + METRICS_HISTOGRAM_BUCKETS);
+}
+
+
+uint64_t metrics_counter_value(metric_counter counter) {
+    if (counter.slot == METRICS_NO_SLOT) {
+        return 0;
+    }
+    metrics_registry& reg = registry();
+    lock_guard<mutex> lock(reg.lock);
+    return sum_slot_locked(reg, counter.slot);
+}
+
+
+int64_t metrics_gauge_value(metric_gauge gauge) {
+    return gauge.value ? gauge.value->load(memory_order_relaxed) : 0;
+}
+
+
+bool metrics_histogram_read(metric_histogram histogram, metrics_histogram_snapshot* snapshot) {
+    if (histogram.slot == METRICS_NO_SLOT) {
+        return false;
+    }
+    metrics_registry& reg = registry();
+    lock_guard<mutex> lock(reg.lock);
+    read_histogram_locked(reg, histogram.slot, snapshot);
+    return true;
+}
+
+
+uint64_t metrics_bucket_lower(uint32_t bucket) {
+    if (bucket < METRICS_SUB_BUCKETS) {
+        return bucket;
+    }
+    if (bucket >= METRICS_OVERFLOW_BUCKET) {
+        return 1ull << METRICS_MAX_EXPONENT;
+    }
+    uint32_t exponent = bucket / METRICS_SUB_BUCKETS + METRICS_SUB_BUCKET_BITS - 1;
+    uint64_t sub = bucket % METRICS_SUB_BUCKETS;
+    return (METRICS_SUB_BUCKETS + sub) << (exponent - METRICS_SUB_BUCKET_BITS);
+}
+
+
+uint64_t metrics_bucket_upper(uint32_t bucket) {
+    if (bucket >= METRICS_OVERFLOW_BUCKET) {
+        return UINT64_MAX;
+    }
+    return metrics_bucket_lower(bucket + 1) - 1;
+}
+
+
+uint64_t metrics_histogram_quantile(const metrics_histogram_snapshot* snapshot, double q) {
+    if (snapshot->count == 0) {
+        return 0;
+    }
+    double clamped = q < 0.0 ? 0.0 : (q > 1.0 ? 1.0 : q);
+    uint64_t rank = static_cast<uint64_t>(ceil(clamped * static_cast<double>(snapshot->count)));
+    rank = rank == 0 ? 1 : rank;
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < METRICS_HISTOGRAM_BUCKETS; i++) {
+        seen += snapshot->buckets[i];
+        if (seen >= rank) {
+            return metrics_bucket_upper(i);
+        }
+    }
+    return metrics_bucket_upper(METRICS_HISTOGRAM_BUCKETS - 1);
+}
+
+
+/**
+ * Escapa a descrição conforme o formato (barra invertida e quebra de linha).
+ */
+static void append_help(string& out, const string& help) {
+    for (char c : help) {
+        if (c == '\\') {
+            out += "\\\\";
+        } else if (c == '\n') {
+            out += "\\n";
+        } else {
+            out += c;
+        }
+    }
+}
+
+
+static void append_number(string& out, double value) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.9g", value);
+    out += buffer;
+}
+
+
+/**
+ * Linha de uma série: nome, rótulos da métrica mais o rótulo extra (se houver) e valor.
+ */
+static void append_series(string& out, const string& name, const string& labels, const string& extra) {
+    out += name;
+    if (!labels.empty() || !extra.empty()) {
+        out += '{';
+        out += labels;
+        if (!labels.empty() && !extra.empty()) {
+            out += ',';
+        }
+        out += extra;
+        out += '}';
+    }
+    out += ' ';
+}
+
+
+static void append_histogram(string& out, const metric_info& metric, const metrics_histogram_snapshot& snapshot) {
+    // Um limite por potência de 2: o grupo de intervalos de cada expoente termina em 2^k - 1. O intervalo
+    // de estouro, acima do último limite, só entra no +Inf
+    uint64_t cumulative = 0;
+    for (uint32_t group = 0; group < METRICS_OVERFLOW_BUCKET / METRICS_SUB_BUCKETS; group++) {
+        for (uint32_t i = 0; i < METRICS_SUB_BUCKETS; i++) {
+            cumulative += snapshot.buckets[group * METRICS_SUB_BUCKETS + i];
+        }
+        uint64_t limit = (1ull << (group + METRICS_SUB_BUCKET_BITS)) - 1;
+        string le = "le=\"";
+        append_number(le, static_cast<double>(limit) * metric.scale);
+        le += '"';
+        append_series(out, metric.family + "_bucket", metric.labels, le);
+        out += to_string(cumulative);
+        out += '\n';
+    }
+    append_series(out, metric.family + "_bucket", metric.labels, "le=\"+Inf\"");
+    out += to_string(snapshot.count);
+    out += '\n';
+    append_series(out, metric.family + "_sum", metric.labels, "");
+    append_number(out, static_cast<double>(snapshot.sum) * metric.scale);
+    out += '\n';
+    append_series(out, metric.family + "_count", metric.labels, "");
+    out += to_string(snapshot.count);
+    out += '\n';
+}
+
+
+string metrics_export_prometheus() {
+    static const char* const type_names[] = {"counter", "gauge", "histogram"};
+    metrics_registry& reg = registry();
+    lock_guard<mutex> lock(reg.lock);
+    string out;
+    metrics_histogram_snapshot snapshot;
+
+    // As séries de uma família ficam juntas, na ordem do primeiro registro de cada família
+    vector<bool> written(reg.metrics.size(), false);
+    for (size_t i = 0; i < reg.metrics.size(); i++) {
+        if (written[i]) {
+            continue;
+        }
+        const metric_info& first = reg.metrics[i];
+        out += "# HELP " + first.family + " ";
+        append_help(out, first.help);
+        out += "\n# TYPE " + first.family + " " + type_names[first.type] + "\n";
+        for (size_t j = i; j < reg.metrics.size(); j++) {
+            const metric_info& metric = reg.metrics[j];
+            if (written[j] || metric.family != first.family) {
+                continue;
+            }
+            written[j] = true;
+            switch (metric.type) {
+            case METRIC_COUNTER:
+                append_series(out, metric.family, metric.labels, "");
+                out += to_string(sum_slot_locked(reg, metric.slot));
+                out += '\n';
+                break;
+            case METRIC_GAUGE:
+                append_series(out, metric.family, metric.labels, "");
+                out += to_string(metric.gauge->value.load(memory_order_relaxed));
+                out += '\n';
+                break;
+            case METRIC_HISTOGRAM:
+                read_histogram_locked(reg, metric.slot, &snapshot);
+                append_histogram(out, metric, snapshot);
+                break;
+            }
+        }
+    }
+    return out;
+}
+
+
+bool metrics_write_file(const char* path) {
+    string text = metrics_export_prometheus();
+    string temporary = string(path) + ".tmp";
+    FILE* out = fopen(temporary.c_str(), "w");
+    if (!out) {
+        cerr << "Erro ao criar arquivo de métricas: " << temporary << endl;
+        return false;
+    }
+    bool ok = fwrite(text.data(), 1, text.size(), out) == text.size();
+    ok = fclose(out) == 0 && ok;
+    if (!ok || rename(temporary.c_str(), path) != 0) {
+        cerr << "Erro ao gravar arquivo de métricas: " << path << endl;
+        unlink(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+
+// Atendimento por socket Unix (metrics_serve_start). A thread não é um objeto estático: um programa que
+// termina sem chamar metrics_serve_stop() não passa pelo destrutor de uma std::thread ainda ativa
+static mutex serve_mutex;
+static thread* serve_thread = nullptr;
+static int serve_fd = -1;
+static int serve_stop_fd = -1;
+static string serve_path;
+
+// Espera pelo pedido do cliente antes de responder só com o texto
+static const int METRICS_REQUEST_WAIT_MS = 50;
+
+
+static bool send_all(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t sent = send(fd, data, length, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += sent;
+        length -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+
+/**
+ * Responde a uma conexão: lê o que o cliente enviou (se enviou algo logo) para decidir entre HTTP e texto puro.
+ */
+static void serve_client(int fd) {
+    char request[1024];
+    ssize_t received = 0;
+    pollfd readable{fd, POLLIN, 0};
+    if (poll(&readable, 1, METRICS_REQUEST_WAIT_MS) > 0) {
+        received = recv(fd, request, sizeof(request), MSG_DONTWAIT);
+    }
+    string body = metrics_export_prometheus();
+    if (received >= 4 && memcmp(request, "GET ", 4) == 0) {
+        string header = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: " +
+                        to_string(body.size()) + "\r\nConnection: close\r\n\r\n";
+        send_all(fd, header.data(), header.size());
+    }
+    send_all(fd, body.data(), body.size());
+    shutdown(fd, SHUT_WR);
+}
+
+
+static void serve_loop(int listen_fd, int stop_fd) {
+    pollfd fds[2] = {{listen_fd, POLLIN, 0}, {stop_fd, POLLIN, 0}};
+    while (true) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            cerr << "Erro no atendimento das métricas: " << strerror(errno) << endl;
+            return;
+        }
+        if (fds[1].revents) {
+            return;
+        }
+        int fd = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd >= 0) {
+            serve_client(fd);
+            close(fd);
+        }
+    }
+}
+
+
+bool metrics_serve_start(const char* unix_path) {
+    lock_guard<mutex> lock(serve_mutex);
+    if (serve_fd >= 0) {
+        cerr << "Métricas já são atendidas em " << serve_path << endl;
+        return false;
+    }
+    int fd = unix_socket_listen(unix_path, 0, 16);
+    if (fd < 0) {
+        return false;
+    }
+    int stop_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (stop_fd < 0) {
+        cerr << "Erro ao criar eventfd: " << strerror(errno) << endl;
+        close(fd);
+        unlink(unix_path);
+        return false;
+    }
+    serve_fd = fd;
+    serve_stop_fd = stop_fd;
+    serve_path = unix_path;
+    serve_thread = new thread(serve_loop, fd, stop_fd);
+    return true;
+}
+
+
+void metrics_serve_stop() {
+    lock_guard<mutex> lock(serve_mutex);
+    if (serve_fd < 0) {
+        return;
+    }
+    uint64_t one = 1;
+    if (write(serve_stop_fd, &one, sizeof(one)) != sizeof(one)) {
+        cerr << "Erro ao encerrar o atendimento das métricas: " << strerror(errno) << endl;
+    }
+    serve_thread->join();
+    delete serve_thread;
+    serve_thread = nullptr;
+    close(serve_fd);
+    close(serve_stop_fd);
+    unlink(serve_path.c_str());
+    serve_fd = -1;
+    serve_stop_fd = -1;
+    serve_path.clear();
+}
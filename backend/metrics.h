@@ -0,0 +1,219 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <time.h>
+
+/**
+ * Métricas de execução do backend: contadores, medidores e histogramas, exportados no formato de texto
+ * do Prometheus (em arquivo ou por socket Unix, sob demanda).
+ *
+ * Contadores e histogramas são gravados em um bloco de posições próprio de cada thread, alinhado a
+ * linhas de cache e escrito só por ela: um registro é uma leitura e uma escrita relaxadas, sem
+ * instrução atômica de leitura-modificação-escrita nem linha de cache disputada com outra thread.
+ * A exportação soma os blocos de todas as threads. O bloco de uma thread encerrada é entregue à
+ * próxima thread criada, que continua somando sobre ele, então nenhum valor se perde.
+ *
+ * Os histogramas são log-lineares, como o HdrHistogram: cada potência de 2 é dividida em
+ * METRICS_SUB_BUCKETS faixas iguais, o que guarda cada valor com erro relativo de até 1/8 em toda a
+ * escala, com um número fixo de posições e sem divisão ao registrar. Valores acima da escala
+ * (2^METRICS_MAX_EXPONENT) ficam em um intervalo próprio de estouro, sem limite superior.
+ *
+ * Os medidores (valores instantâneos, como a memória do corpus) são globais, cada um em uma linha de
+ * cache própria, e devem ser atualizados fora dos caminhos quentes.
+ *
+ * Os nomes seguem o Prometheus e podem trazer rótulos, ex.: "gentexts_texts_sampled_total{api=\"view\"}";
+ * métricas com o mesmo nome antes dos rótulos formam uma família e devem ter o mesmo tipo.
+ */
+
+static const uint32_t METRICS_SUB_BUCKET_BITS = 3;
+static const uint32_t METRICS_SUB_BUCKETS = 1u << METRICS_SUB_BUCKET_BITS;
+
+// Valores a partir de 2^METRICS_MAX_EXPONENT (em ns, cerca de 68 s) caem no intervalo de estouro
+static const uint32_t METRICS_MAX_EXPONENT = 36;
+static const uint32_t METRICS_OVERFLOW_BUCKET = (METRICS_MAX_EXPONENT - METRICS_SUB_BUCKET_BITS + 1) * METRICS_SUB_BUCKETS;
+static const uint32_t METRICS_HISTOGRAM_BUCKETS = METRICS_OVERFLOW_BUCKET + 1;
+
+// Posições do bloco de cada thread (64 KiB): um contador ocupa uma, um histograma METRICS_HISTOGRAM_BUCKETS + 1
+// (soma), o que comporta 29 histogramas. Um registro além disso encerra o programa (ver metrics_counter())
+static const uint32_t METRICS_THREAD_SLOTS = 8192;
+static const uint32_t METRICS_NO_SLOT = UINT32_MAX;
+
+/**
+ * Identificadores devolvidos pelo registro. Um identificador inválido (registro com conflito de tipo) é
+ * aceito pelas funções de gravação, que então não fazem nada.
+ */
+struct metric_counter {
+    uint32_t slot = METRICS_NO_SLOT;
+};
+
+struct metric_histogram {
+    uint32_t slot = METRICS_NO_SLOT;
+};
+
+struct metric_gauge {
+    std::atomic<int64_t>* value = nullptr;
+};
+
+/**
+ * Registra (ou encontra, se o nome já existe com o mesmo tipo) uma métrica. `help` é a descrição
+ * exportada. Os histogramas gravam inteiros (ex.: ns, bytes) e são exportados multiplicados por
+ * `scale` (1e-9 para ns em segundos, como pede o Prometheus).
+ * Falham, com mensagem em cerr, se o nome já existe com outro tipo. Se as posições do bloco acabaram,
+ * o programa é encerrado (abort): gravações descartadas em silêncio esconderiam a falta de
+ * METRICS_THREAD_SLOTS, que deve ser aumentado.
+ */
+metric_counter metrics_counter(const char* name, const char* help);
+metric_gauge metrics_gauge(const char* name, const char* help);
+metric_histogram metrics_histogram(const char* name, const char* help, double scale = 1.0);
+
+// Bloco da thread chamadora (nullptr até o primeiro registro)
+extern thread_local std::atomic<uint64_t>* metrics_thread_slots;
+
+/**
+ * Associa um bloco à thread chamadora (reaproveitando o de uma thread encerrada, se houver).
+ */
+std::atomic<uint64_t>* metrics_attach_thread();
+
+inline std::atomic<uint64_t>* metrics_slots() {
+    std::atomic<uint64_t>* block = metrics_thread_slots;
+    if (__builtin_expect(!block, 0)) {
+        block = metrics_attach_thread();
+    }
+    return block;
+}
+
+/**
+ * Soma em uma posição do bloco da thread. Só a thread dona escreve nela; a exportação apenas lê.
+ */
+inline void metrics_slot_add(std::atomic<uint64_t>& slot, uint64_t n) {
+    slot.store(slot.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+inline void metrics_add(metric_counter counter, uint64_t n = 1) {
+    if (counter.slot != METRICS_NO_SLOT) {
+        metrics_slot_add(metrics_slots()[counter.slot], n);
+    }
+}
+
+/**
+ * Intervalo do histograma de um valor: os menores que METRICS_SUB_BUCKETS têm um intervalo cada;
+ * os demais, o expoente e os bits seguintes ao mais significativo; os acima da escala, o de estouro.
+ */
+inline uint32_t metrics_bucket(uint64_t value) {
+    if (value < METRICS_SUB_BUCKETS) {
+        return static_cast<uint32_t>(value);
+    }
+    uint32_t exponent = 63u - static_cast<uint32_t>(__builtin_clzll(value));
+    if (exponent >= METRICS_MAX_EXPONENT) {
+        return METRICS_OVERFLOW_BUCKET;
+    }
+    uint32_t sub = static_cast<uint32_t>(value >> (exponent - METRICS_SUB_BUCKET_BITS)) & (METRICS_SUB_BUCKETS - 1);
+    return (exponent - METRICS_SUB_BUCKET_BITS + 1) * METRICS_SUB_BUCKETS + sub;
+}
+
+inline void metrics_observe(metric_histogram histogram, uint64_t value) {
+    if (histogram.slot != METRICS_NO_SLOT) {
+        std::atomic<uint64_t>* block = metrics_slots() + histogram.slot;
+        metrics_slot_add(block[metrics_bucket(value)], 1);
+        metrics_slot_add(block[METRICS_HISTOGRAM_BUCKETS], value);
+    }
+}
+
+inline void metrics_gauge_set(metric_gauge gauge, int64_t value) {
+    if (gauge.value) {
+        gauge.value->store(value, std::memory_order_relaxed);
+    }
+}
+
+inline void metrics_gauge_add(metric_gauge gauge, int64_t delta) {
+    if (gauge.value) {
+        gauge.value->fetch_add(delta, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * Relógio das medições de latência (CLOCK_MONOTONIC, em ns).
+ */
+inline int64_t metrics_now_ns() {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<int64_t>(now.tv_sec) * 1000000000LL + now.tv_nsec;
+}
+
+/**
+ * Mede o escopo em que é declarada e grava a duração (ns) no histograma.
+ */
+class metrics_timer {
+public:
+    explicit metrics_timer(metric_histogram histogram) : histogram(histogram), start(metrics_now_ns()) {}
+
+    ~metrics_timer() {
+        metrics_observe(histogram, static_cast<uint64_t>(metrics_now_ns() - start));
+    }
+
+    metrics_timer(const metrics_timer&) = delete;
+    metrics_timer& operator=(const metrics_timer&) = delete;
+
+private:
+    metric_histogram histogram;
+    int64_t start;
+};
+
+/**
+ * Leitura de um histograma, somada sobre todas as threads.
+ */
+struct metrics_histogram_snapshot {
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint64_t buckets[METRICS_HISTOGRAM_BUCKETS] = {};
+};
+
+// Leituras somadas sobre todas as threads (podem ser chamadas com as threads gravando)
+uint64_t metrics_counter_value(metric_counter counter);
+int64_t metrics_gauge_value(metric_gauge gauge);
+bool metrics_histogram_read(metric_histogram histogram, metrics_histogram_snapshot* snapshot);
+
+/**
+ * Menor e maior valor guardados no intervalo `bucket` (o maior, inclusive; UINT64_MAX no de estouro).
+ */
+uint64_t metrics_bucket_lower(uint32_t bucket);
+uint64_t metrics_bucket_upper(uint32_t bucket);
+
+/**
+ * Quantil q (0..1) do histograma: o maior valor do intervalo que o contém (0 se vazio).
+ */
+uint64_t metrics_histogram_quantile(const metrics_histogram_snapshot* snapshot, double q);
+
+/**
+ * Todas as métricas no formato de texto do Prometheus (versão 0.0.4). Os histogramas são exportados com
+ * um limite `le` por potência de 2, fixos, para que as séries sejam as mesmas em todas as coletas.
+ */
+std::string metrics_export_prometheus();
+
+/**
+ * Grava a exportação em `path`, por um arquivo temporário renomeado em seguida: quem lê o arquivo
+ * (ex.: textfile collector do node_exporter) nunca vê uma exportação pela metade.
+ *
+ * @return true em caso de sucesso
+ */
+bool metrics_write_file(const char* path);
+
+/**
+ * Atende a exportação em um socket Unix, em uma thread própria: cada conexão recebe as métricas do
+ * momento e é encerrada. Um pedido HTTP (ex.: curl --unix-socket <caminho> http://localhost/metrics)
+ * recebe a resposta com cabeçalhos HTTP; qualquer outra conexão (ex.: socat) recebe só o texto. Um
+ * socket em que outro processo ainda responde não é tomado (ver unix_socket_listen()).
+ *
+ * @return true se o socket foi criado
+ */
+bool metrics_serve_start(const char* unix_path);
+
+/**
+ * Encerra o atendimento iniciado por metrics_serve_start() e remove o arquivo do socket.
+ */
+void metrics_serve_stop();
+
+#endif
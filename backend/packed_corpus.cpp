@@ -0,0 +1,239 @@
+#include <cstdlib>
+#include <cstring>
+
+#include "packed_corpus.h"
+
+#if defined(__x86_64__)
+#include <cpuid.h>
+#include <immintrin.h>
+#define PACKED_CORPUS_BMI2 1
+#endif
+
+// SPACE_SYMBOL: código do espaço; as letras usam 0 ('a') a 25 ('z')
+static const uint8_t SPACE_SYMBOL = 26;
+
+// SYMBOL_BITS: bits por símbolo
+static const unsigned SYMBOL_BITS = 5;
+
+// Tabela de decodificação de um símbolo
+static const char SYMBOL_CHARS[32] = "abcdefghijklmnopqrstuvwxyz ";
+
+
+/**
+ * Lê 64 bits a partir de um byte qualquer do bitstream (little-endian).
+ */
+static inline uint64_t load64(const uint8_t* p) {
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+
+packed_corpus* packed_corpus_build(const text_corpus* corpus) {
+    size_t count = static_cast<size_t>(corpus->count);
+    uint64_t symbols = 0;
+    for (size_t i = 0; i < count; i++) {
+        symbols += corpus->lengths[i];
+    }
+
+    size_t stream_bytes = static_cast<size_t>((symbols * SYMBOL_BITS + 7) / 8) + sizeof(uint64_t);
+    size_t table_bytes = (count + 1) * sizeof(uint64_t);
+
+    // Estrutura e tabela em um único bloco; o bitstream em outro
+    packed_corpus* packed = static_cast<packed_corpus*>(malloc(sizeof(packed_corpus) + table_bytes));
+    if (!packed) {
+        return nullptr;
+    }
+    packed->bits = static_cast<uint8_t*>(calloc(stream_bytes, 1));
+    if (!packed->bits) {
+        free(packed);
+        return nullptr;
+    }
+    packed->count = corpus->count;
+    packed->offsets = reinterpret_cast<uint64_t*>(packed + 1);
+    packed->bytes = sizeof(packed_corpus) + table_bytes + stream_bytes;
+
+    // Acumula os símbolos em um registrador de 64 bits e descarrega 32 bits por vez
+    uint64_t position = 0;
+    uint64_t accumulator = 0;
+    unsigned pending = 0;
+    uint8_t* out = packed->bits;
+
+    for (size_t i = 0; i < count; i++) {
+        packed->offsets[i] = position;
+        const char* text = corpus->arena + corpus->offsets[i];
+        for (uint32_t j = 0; j < corpus->lengths[i]; j++) {
+            char c = text[j];
+            uint64_t symbol;
+            if (c >= 'a' && c <= 'z') {
+                symbol = static_cast<uint64_t>(c - 'a');
+            } else if (c == ' ') {
+                symbol = SPACE_SYMBOL;
+            } else {
+                packed_corpus_free(packed);
+                return nullptr;
+            }
+            accumulator |= symbol << pending;
+            pending += SYMBOL_BITS;
+            if (pending >= 32) {
+                uint32_t word = static_cast<uint32_t>(accumulator);
+                memcpy(out, &word, sizeof(word));
+                out += sizeof(word);
+                accumulator >>= 32;
+                pending -= 32;
+            }
+        }
+        position += corpus->lengths[i];
+    }
+    packed->offsets[count] = position;
+
+    while (pending > 0) {
+        *out++ = static_cast<uint8_t>(accumulator);
+        accumulator >>= 8;
+        pending = pending > 8 ? pending - 8 : 0;
+    }
+
+    return packed;
+}
+
+
+void packed_corpus_free(const packed_corpus* packed) {
+    if (!packed) {
+        return;
+    }
+    free(packed->bits);
+    free(const_cast<packed_corpus*>(packed));
+}
+
+
+/**
+ * Decodifica n símbolos a partir da posição symbol, um por vez. Usado como fallback e para a cauda.
+ */
+static void decode_scalar(const uint8_t* bits, uint64_t symbol, char* dst, size_t n) {
+    for (size_t i = 0; i < n; i++, symbol++) {
+        uint64_t bit = symbol * SYMBOL_BITS;
+        uint64_t word = load64(bits + bit / 8) >> (bit % 8);
+        dst[i] = SYMBOL_CHARS[word & 0x1F];
+    }
+}
+
+
+/**
+ * Converte 8 códigos (um por byte) em ASCII, em paralelo nos 8 bytes do registrador (SWAR):
+ * soma 'a' e troca o código do espaço ('a' + 26 = '{') por ' '.
+ */
+static inline uint64_t symbols_to_ascii(uint64_t codes) {
+    const uint64_t ones = 0x0101010101010101ULL;
+    const uint64_t low7 = 0x7F7F7F7F7F7F7F7FULL;
+    const uint64_t space_code = ones * ('a' + SPACE_SYMBOL);
+    uint64_t chars = codes + ones * 'a';
+
+    // Bytes iguais a '{' viram zero em diff; high marca exatamente esses bytes com 0x80
+    uint64_t diff = chars ^ space_code;
+    uint64_t high = ~(((diff & low7) + low7) | diff | low7);
+    return chars ^ ((high >> 7) * static_cast<uint64_t>(('a' + SPACE_SYMBOL) ^ ' '));
+}
+
+
+/**
+ * Decodifica 8 símbolos por iteração sem instruções específicas: uma leitura de 64 bits traz os
+ * 40 bits do grupo, e três passos de deslocamento e máscara separam os campos de 5 bits em
+ * metades de 20 bits, pares de 10 bits e, por fim, um campo por byte.
+ * Escreve sempre 8 bytes por grupo, então só é usada enquanto restam pelo menos 8 símbolos.
+ */
+static size_t decode_swar(const uint8_t* bits, uint64_t symbol, char* dst, size_t n) {
+    size_t done = 0;
+    for (; done + 8 <= n; done += 8, symbol += 8) {
+        uint64_t bit = symbol * SYMBOL_BITS;
+        uint64_t word = load64(bits + bit / 8) >> (bit % 8);
+        uint64_t codes = (word & 0xFFFFFULL) | ((word & 0xFFFFF00000ULL) << 12);
+        codes = (codes & 0x000003FF000003FFULL) | ((codes & 0x000FFC00000FFC00ULL) << 6);
+        codes = (codes & 0x001F001F001F001FULL) | ((codes & 0x03E003E003E003E0ULL) << 3);
+        uint64_t chars = symbols_to_ascii(codes);
+        memcpy(dst + done, &chars, sizeof(chars));
+    }
+    return done;
+}
+
+
+#ifdef PACKED_CORPUS_BMI2
+
+/**
+ * Como decode_swar(), mas o PDEP espalha cada campo de 5 bits em um byte em uma instrução.
+ */
+__attribute__((target("bmi2")))
+static size_t decode_bmi2(const uint8_t* bits, uint64_t symbol, char* dst, size_t n) {
+    const uint64_t lanes = 0x1F1F1F1F1F1F1F1FULL;
+    size_t done = 0;
+
+    for (; done + 8 <= n; done += 8, symbol += 8) {
+        uint64_t bit = symbol * SYMBOL_BITS;
+        uint64_t word = load64(bits + bit / 8) >> (bit % 8);
+        uint64_t chars = symbols_to_ascii(_pdep_u64(word, lanes));
+        memcpy(dst + done, &chars, sizeof(chars));
+    }
+    return done;
+}
+
+
+/**
+ * PDEP rápido: BMI2 presente e implementado em hardware. Nos AMD anteriores ao Zen 3 (família 17h,
+ * e Hygon, família 18h) o PDEP é microcodificado, com latência de centenas de ciclos e dependente
+ * da máscara; neles o SWAR é mais rápido.
+ */
+static bool cpu_has_fast_pdep() {
+    static const bool fast = [] {
+        if (!__builtin_cpu_supports("bmi2")) {
+            return false;
+        }
+        unsigned eax, ebx, ecx, edx;
+        if (!__get_cpuid(0, &eax, &ebx, &ecx, &edx)) {
+            return false;
+        }
+        char vendor[12];
+        memcpy(vendor, &ebx, 4);
+        memcpy(vendor + 4, &edx, 4);
+        memcpy(vendor + 8, &ecx, 4);
+        bool amd = memcmp(vendor, "AuthenticAMD", 12) == 0 || memcmp(vendor, "HygonGenuine", 12) == 0;
+        if (!amd) {
+            return true;
+        }
+        if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+            return false;
+        }
+        unsigned family = (eax >> 8) & 0xF;
+        if (family == 0xF) {
+            family += (eax >> 20) & 0xFF;
+        }
+        return family >= 0x19;
+    }();
+    return fast;
+}
+
+#endif
+
+
+size_t packed_corpus_decode(const packed_corpus* packed, uint32_t index, char* dst, size_t capacity) {
+    if (capacity == 0) {
+        return 0;
+    }
+    uint64_t symbol = packed->offsets[index];
+    size_t length = packed_corpus_length(packed, index);
+    if (length > capacity - 1) {
+        length = capacity - 1;
+    }
+
+    size_t done;
+#ifdef PACKED_CORPUS_BMI2
+    if (cpu_has_fast_pdep()) {
+        done = decode_bmi2(packed->bits, symbol, dst, length);
+    } else {
+        done = decode_swar(packed->bits, symbol, dst, length);
+    }
+#else
+    done = decode_swar(packed->bits, symbol, dst, length);
+#endif
+    decode_scalar(packed->bits, symbol + done, dst + done, length - done);
+    dst[length] = '\0';
+    return length;
+}
@@ -0,0 +1,52 @@
+#ifndef PACKED_CORPUS_H
+#define PACKED_CORPUS_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "lib_gentexts.h"
+
+/**
+ * Corpus compactado com 5 bits por símbolo.
+ * Os textos gerados contêm apenas 'a'..'z' e espaço (27 símbolos), então cada caractere
+ * ocupa 5 bits em um único bitstream contínuo, sem terminadores. O texto i ocupa os símbolos
+ * [offsets[i], offsets[i + 1]), de modo que a tabela de offsets também dá os tamanhos.
+ * Em relação ao corpus em bytes, a memória residente cai para cerca de 5/8 nos textos
+ * e a tabela por texto passa de 12 para 8 bytes.
+ */
+struct packed_corpus {
+    int count;              // Número de textos
+    uint64_t* offsets;      // count + 1 posições (em símbolos) no bitstream
+    uint8_t* bits;          // Bitstream (com folga de 8 bytes para leituras de 64 bits)
+    size_t bytes;           // Memória total ocupada (estrutura, tabela e bitstream)
+};
+
+/**
+ * Compacta um corpus. Retorna nullptr se algum texto contiver caracteres fora de 'a'..'z' e espaço,
+ * ou em caso de erro de alocação. O corpus original não é alterado.
+ */
+packed_corpus* packed_corpus_build(const text_corpus* corpus);
+
+/**
+ * Libera um corpus compactado.
+ */
+void packed_corpus_free(const packed_corpus* packed);
+
+/**
+ * Tamanho (em caracteres) do texto de índice index.
+ */
+inline size_t packed_corpus_length(const packed_corpus* packed, uint32_t index) {
+    return static_cast<size_t>(packed->offsets[index + 1] - packed->offsets[index]);
+}
+
+/**
+ * Decodifica o texto de índice index no buffer do chamador, terminando-o com '\0'.
+ * Se o buffer for menor que o texto, a saída é truncada em capacity - 1 caracteres.
+ * Expande 8 símbolos por vez: com PDEP (BMI2) onde ele é rápido, e com deslocamentos e máscaras
+ * (SWAR) nas demais CPUs, inclusive AMD Zen 1/Zen 2, em que o PDEP é microcodificado.
+ *
+ * @return Quantidade de caracteres escritos (sem o terminador)
+ */
+size_t packed_corpus_decode(const packed_corpus* packed, uint32_t index, char* dst, size_t capacity);
+
+#endif
@@ -0,0 +1,317 @@
+#include <iostream>
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <dirent.h>
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "plugin_registry.h"
+
+using namespace std;
+
+// Plugins registrados, por nome
+static mutex registry_mutex;
+static map<string, shared_ptr<generator_plugin>> registry;
+
+
+generator_plugin::~generator_plugin() {
+    if (handle) {
+        dlclose(handle);
+    }
+}
+
+
+/**
+ * Cria o arquivo da cópia privada em um diretório que permite executar código: o do próprio .so
+ * (de onde ele já seria carregado) ou, se não for possível escrever nele, $XDG_RUNTIME_DIR.
+ * O nome começa com ponto para que plugin_registry_scan() não o confunda com um plugin.
+ *
+ * @param tmp_path Recebe o caminho do arquivo criado
+ * @return Descritor do arquivo ou -1 em caso de erro
+ */
+static int create_private_copy(const string& path, string& tmp_path) {
+    size_t slash = path.rfind('/');
+    string directories[2] = {slash == string::npos ? "." : path.substr(0, slash), ""};
+    if (const char* runtime_dir = getenv("XDG_RUNTIME_DIR")) {
+        directories[1] = runtime_dir;
+    }
+
+    int saved_errno = 0;
+    for (const string& directory : directories) {
+        if (directory.empty()) {
+            continue;
+        }
+        tmp_path = directory + "/.gentexts-plugin-XXXXXX.so";
+        int fd = mkostemps(&tmp_path[0], 3, O_CLOEXEC);
+        if (fd >= 0) {
+            return fd;
+        }
+        saved_errno = errno;
+    }
+    errno = saved_errno;
+    return -1;
+}
+
+
+/**
+ * Copia o .so para um arquivo temporário exclusivo e o abre com dlopen.
+ * A cópia é removida logo após o dlopen: o mapeamento mantém o conteúdo acessível.
+ *
+ * @return Handle do dlopen ou nullptr em caso de erro
+ */
+static void* open_private_copy(const string& path) {
+    int in = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (in < 0) {
+        cerr << "Erro ao abrir plugin " << path << ": " << strerror(errno) << endl;
+        return nullptr;
+    }
+
+    string tmp_path;
+    int out = create_private_copy(path, tmp_path);
+    if (out < 0) {
+        cerr << "Erro ao criar cópia do plugin " << path << ": " << strerror(errno) << endl;
+        close(in);
+        return nullptr;
+    }
+
+    char buffer[65536];
+    bool ok = true;
+    for (;;) {
+        ssize_t n = read(in, buffer, sizeof(buffer));
+        if (n <= 0) {
+            ok = n == 0;
+            break;
+        }
+        if (write(out, buffer, static_cast<size_t>(n)) != n) {
+            ok = false;
+            break;
+        }
+    }
+    close(in);
+    close(out);
+
+    void* handle = ok ? dlopen(tmp_path.c_str(), RTLD_NOW | RTLD_LOCAL) : nullptr;
+    if (ok && !handle) {
+        cerr << "Erro ao carregar plugin " << path << ": " << dlerror() << endl;
+    }
+    unlink(tmp_path.c_str());
+    return handle;
+}
+
+
+/**
+ * Monta a descrição de uma biblioteca antiga (sem gentexts_plugin_query) a partir dos símbolos avulsos.
+ */
+static bool build_legacy_api(generator_plugin& plugin) {
+    gentexts_plugin_api& api = plugin.local_api;
+    api.abi_version = GENTEXTS_PLUGIN_ABI_VERSION;
+    api.struct_size = sizeof(gentexts_plugin_api);
+    api.name = "gentexts";
+    api.version = "legacy";
+    api.generate_list = (char** (*)(int*))dlsym(plugin.handle, "generate_list_random_texts");
+    api.generate_corpus = (text_corpus* (*)(int))dlsym(plugin.handle, "generate_corpus");
+    api.generate_corpus_parallel = (text_corpus* (*)(int, uint64_t, int))dlsym(plugin.handle, "generate_corpus_parallel");
+    api.free_corpus = (void (*)(text_corpus*))dlsym(plugin.handle, "free_corpus");
+    api.seed = (void (*)(uint64_t))dlsym(plugin.handle, "gentexts_seed");
+    dlerror();
+
+    api.capabilities = (api.generate_list ? GENTEXTS_CAP_LIST : 0)
+        | (api.generate_corpus && api.free_corpus ? GENTEXTS_CAP_CORPUS : 0)
+        | (api.generate_corpus_parallel ? GENTEXTS_CAP_PARALLEL : 0)
+        | (api.seed ? GENTEXTS_CAP_SEED : 0);
+    plugin.api = &api;
+    return (api.capabilities & GENTEXTS_CAP_CORPUS) != 0;
+}
+
+
+// Menor descrição aceita: até free_corpus, os campos obrigatórios
+static const size_t PLUGIN_API_MIN_SIZE = offsetof(gentexts_plugin_api, free_corpus) + sizeof(void (*)(text_corpus*));
+
+/**
+ * Limpa as capacidades cujos pontos de entrada ficam além da estrutura do plugin (campos que ele não conhece).
+ */
+static uint32_t known_capabilities(uint32_t capabilities, size_t struct_size) {
+    struct field_capability {
+        uint32_t capability;
+        size_t end;             // Fim do último campo exigido pela capacidade
+    };
+    static const field_capability fields[] = {
+        {GENTEXTS_CAP_LIST, offsetof(gentexts_plugin_api, generate_list) + sizeof(void*)},
+        {GENTEXTS_CAP_PARALLEL, offsetof(gentexts_plugin_api, generate_corpus_parallel) + sizeof(void*)},
+        {GENTEXTS_CAP_SEED, offsetof(gentexts_plugin_api, seed) + sizeof(void*)},
+        {GENTEXTS_CAP_STREAM, offsetof(gentexts_plugin_api, stream_close) + sizeof(void*)},
+    };
+    for (const field_capability& field : fields) {
+        if (field.end > struct_size) {
+            capabilities &= ~field.capability;
+        }
+    }
+    return capabilities;
+}
+
+
+/**
+ * Verifica se a descrição do plugin é compatível com este backend e a copia para plugin.local_api,
+ * completando com zeros os campos posteriores ao struct_size do plugin.
+ */
+static bool adopt_api(generator_plugin& plugin, const gentexts_plugin_api* api, const string& path) {
+    if (!api || api->abi_version != GENTEXTS_PLUGIN_ABI_VERSION) {
+        cerr << "Plugin " << path << " com versão de ABI incompatível" << endl;
+        return false;
+    }
+    if (api->struct_size < PLUGIN_API_MIN_SIZE || !api->name || !api->name[0]) {
+        cerr << "Plugin " << path << " com descrição inválida" << endl;
+        return false;
+    }
+
+    // Campos novos só entram no final: os que o plugin conhece estão no início, na mesma posição
+    gentexts_plugin_api& local = plugin.local_api;
+    memset(&local, 0, sizeof(local));
+    memcpy(&local, api, api->struct_size < sizeof(local) ? api->struct_size : sizeof(local));
+    local.struct_size = sizeof(local);
+    local.capabilities = known_capabilities(api->capabilities, api->struct_size);
+    plugin.api = &local;
+
+    if (!(local.capabilities & GENTEXTS_CAP_CORPUS) || !local.generate_corpus || !local.free_corpus) {
+        cerr << "Plugin " << path << " não oferece generate_corpus/free_corpus" << endl;
+        return false;
+    }
+    if (((local.capabilities & GENTEXTS_CAP_PARALLEL) && !local.generate_corpus_parallel)
+        || ((local.capabilities & GENTEXTS_CAP_SEED) && !local.seed)
+        || ((local.capabilities & GENTEXTS_CAP_LIST) && !local.generate_list)
+        || ((local.capabilities & GENTEXTS_CAP_STREAM) && (!local.stream_open || !local.stream_next || !local.stream_close))) {
+        cerr << "Plugin " << path << " anuncia capacidades sem os pontos de entrada correspondentes" << endl;
+        return false;
+    }
+    return true;
+}
+
+
+/**
+ * O arquivo mudou desde a carga do plugin: data de modificação com nanossegundos (uma recompilação no
+ * mesmo segundo também conta) ou outro inode (arquivo substituído).
+ */
+static bool file_changed(const generator_plugin& plugin, const struct stat& st) {
+    return st.st_mtim.tv_sec != plugin.modified.tv_sec || st.st_mtim.tv_nsec != plugin.modified.tv_nsec
+        || st.st_ino != plugin.inode;
+}
+
+
+shared_ptr<generator_plugin> plugin_load(const string& path) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) {
+        cerr << "Plugin não encontrado: " << path << endl;
+        return nullptr;
+    }
+
+    auto plugin = make_shared<generator_plugin>();
+    plugin->path = path;
+    plugin->modified = st.st_mtim;
+    plugin->inode = st.st_ino;
+    plugin->handle = open_private_copy(path);
+    if (!plugin->handle) {
+        return nullptr;
+    }
+
+    dlerror();
+    gentexts_plugin_query_fn query = (gentexts_plugin_query_fn)dlsym(plugin->handle, GENTEXTS_PLUGIN_QUERY_SYMBOL);
+    dlerror();
+    if (query) {
+        if (!adopt_api(*plugin, query(), path)) {
+            return nullptr;
+        }
+    } else if (!build_legacy_api(*plugin)) {
+        cerr << "Biblioteca " << path << " não é um gerador de textos" << endl;
+        return nullptr;
+    }
+
+    plugin->name = plugin->api->name;
+    return plugin;
+}
+
+
+shared_ptr<generator_plugin> plugin_registry_add(const string& path) {
+    shared_ptr<generator_plugin> plugin = plugin_load(path);
+    if (plugin) {
+        lock_guard<mutex> lock(registry_mutex);
+        registry[plugin->name] = plugin;
+    }
+    return plugin;
+}
+
+
+size_t plugin_registry_scan(const string& directory) {
+    DIR* dir = opendir(directory.c_str());
+    if (!dir) {
+        cerr << "Erro ao abrir diretório de plugins " << directory << ": " << strerror(errno) << endl;
+        return 0;
+    }
+
+    size_t loaded = 0;
+    while (struct dirent* entry = readdir(dir)) {
+        string file = entry->d_name;
+        // Arquivos ocultos ficam de fora, inclusive cópias privadas em andamento (ver create_private_copy)
+        if (file.size() > 3 && file[0] != '.' && file.compare(file.size() - 3, 3, ".so") == 0) {
+            if (plugin_registry_add(directory + "/" + file)) {
+                loaded++;
+            }
+        }
+    }
+    closedir(dir);
+    return loaded;
+}
+
+
+shared_ptr<generator_plugin> plugin_registry_find(const string& name) {
+    lock_guard<mutex> lock(registry_mutex);
+    auto it = registry.find(name);
+    return it != registry.end() ? it->second : nullptr;
+}
+
+
+shared_ptr<generator_plugin> plugin_registry_reload(const string& name, bool only_if_modified) {
+    shared_ptr<generator_plugin> current = plugin_registry_find(name);
+    if (!current) {
+        cerr << "Plugin não registrado: " << name << endl;
+        return nullptr;
+    }
+
+    struct stat st;
+    if (only_if_modified && stat(current->path.c_str(), &st) == 0 && !file_changed(*current, st)) {
+        return current;
+    }
+
+    shared_ptr<generator_plugin> reloaded = plugin_load(current->path);
+    if (!reloaded) {
+        return nullptr;
+    }
+    if (reloaded->name != name) {
+        cerr << "Plugin " << current->path << " mudou de nome (" << name << " -> " << reloaded->name << ")" << endl;
+    }
+
+    lock_guard<mutex> lock(registry_mutex);
+    registry[reloaded->name] = reloaded;
+    return reloaded;
+}
+
+
+vector<string> plugin_registry_names() {
+    lock_guard<mutex> lock(registry_mutex);
+    vector<string> names;
+    for (const auto& entry : registry) {
+        names.push_back(entry.first);
+    }
+    return names;
+}
+
+
+void plugin_registry_clear() {
+    lock_guard<mutex> lock(registry_mutex);
+    registry.clear();
+}
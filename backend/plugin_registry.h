@@ -0,0 +1,83 @@
+#ifndef PLUGIN_REGISTRY_H
+#define PLUGIN_REGISTRY_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <ctime>
+#include <sys/types.h>
+
+#include "gentexts_plugin.h"
+
+/**
+ * Gerador carregado a partir de uma biblioteca .so.
+ * A biblioteca permanece carregada enquanto houver referências (shared_ptr) ao plugin; um corpus
+ * gerado por ele guarda uma referência, então recarregar o plugin não invalida corpora antigos.
+ */
+struct generator_plugin {
+    std::string name;                   // Nome anunciado pelo plugin
+    std::string path;                   // Caminho original do .so
+    timespec modified{};                // Data de modificação do .so quando foi carregado (em ns)
+    ino_t inode = 0;                    // Inode do .so quando foi carregado
+    void* handle = nullptr;             // Handle do dlopen (da cópia privada do .so)
+    const gentexts_plugin_api* api = nullptr;   // Aponta para local_api
+    // Descrição do plugin no tamanho deste backend: os campos que o plugin não conhece ficam zerados.
+    // Para bibliotecas sem gentexts_plugin_query, é montada a partir dos símbolos avulsos
+    gentexts_plugin_api local_api{};
+
+    ~generator_plugin();
+};
+
+/**
+ * Carrega um plugin de geração. A biblioteca é copiada para um arquivo temporário antes do dlopen,
+ * para que uma versão recompilada no mesmo caminho seja de fato carregada novamente
+ * (o dlopen reaproveitaria o handle já aberto para o mesmo arquivo). A cópia fica no diretório do
+ * próprio .so (ou em $XDG_RUNTIME_DIR, se ele não aceitar escrita), e não em /tmp, que pode estar
+ * montado com noexec.
+ * Verifica a versão do ABI e as capacidades obrigatórias. Uma estrutura menor que a deste backend
+ * (plugin compilado antes de campos novos) é aceita: os campos ausentes contam como não oferecidos.
+ * Bibliotecas antigas, sem gentexts_plugin_query, são aceitas se exportarem generate_corpus e free_corpus.
+ *
+ * @return Plugin carregado, ou nullptr em caso de erro (a mensagem é escrita em cerr)
+ */
+std::shared_ptr<generator_plugin> plugin_load(const std::string& path);
+
+/**
+ * Carrega todos os arquivos .so de um diretório e os registra pelo nome anunciado.
+ * Um plugin com nome já registrado substitui o anterior.
+ *
+ * @return Quantidade de plugins registrados com sucesso
+ */
+size_t plugin_registry_scan(const std::string& directory);
+
+/**
+ * Carrega um único arquivo e o registra pelo nome anunciado.
+ */
+std::shared_ptr<generator_plugin> plugin_registry_add(const std::string& path);
+
+/**
+ * Procura um plugin registrado pelo nome.
+ */
+std::shared_ptr<generator_plugin> plugin_registry_find(const std::string& name);
+
+/**
+ * Recarrega do disco o plugin registrado com esse nome e substitui o registro.
+ * Quem ainda usa a versão antiga continua com ela até soltar a referência.
+ *
+ * @param only_if_modified Se true, só recarrega quando o arquivo mudou desde a última carga (data de
+ *                         modificação em ns ou inode, o que detecta recompilações no mesmo segundo)
+ * @return Plugin recarregado (ou o atual, se não houve mudança), ou nullptr em caso de erro
+ */
+std::shared_ptr<generator_plugin> plugin_registry_reload(const std::string& name, bool only_if_modified);
+
+/**
+ * Nomes dos plugins registrados.
+ */
+std::vector<std::string> plugin_registry_names();
+
+/**
+ * Remove todos os plugins do registro (as bibliotecas são descarregadas quando a última referência é solta).
+ */
+void plugin_registry_clear();
+
+#endif
@@ -0,0 +1,271 @@
+#include <iostream>
+#include <cmath>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "sampler.h"
+#include "corpus_snapshot.h"
+#include "packed_corpus.h"
+#include "lib_prng.h"
+#include "trace.h"
+
+using namespace std;
+
+/**
+ * Coluna da tabela do alias: o índice da coluna sai com probabilidade threshold / 2^32, senão sai alias.
+ * Os dois campos ficam juntos para que um sorteio leia uma única linha de cache.
+ */
+struct alias_entry {
+    uint32_t threshold;
+    uint32_t alias;
+};
+
+struct text_sampler {
+    sampler_config config;
+    prng_state rng;
+    uint64_t version = 0;           // Versão do corpus para a qual o estado foi montado (0 = nenhuma)
+    uint32_t count = 0;
+    bool valid = false;             // false se todos os pesos são 0
+
+    vector<alias_entry> table;      // SAMPLER_WEIGHTED
+    vector<uint32_t> order;         // Permutação (SAMPLER_SHUFFLE_BAG) ou textos disponíveis + janela (SAMPLER_NO_REPEAT)
+    uint32_t position = 0;          // Próxima posição do ciclo (SAMPLER_SHUFFLE_BAG)
+    bool cycled = false;            // Já completou um ciclo (SAMPLER_SHUFFLE_BAG)
+    uint32_t window = 0;            // Janela efetiva (SAMPLER_NO_REPEAT)
+    uint32_t filled = 0;            // Textos na janela até ela encher
+    uint32_t oldest = 0;            // Posição, em order, do texto mais antigo da janela
+};
+
+
+text_sampler* sampler_create(const sampler_config* config) {
+    if (config->mode == SAMPLER_WEIGHTED && !config->weight) {
+        cerr << "Amostrador ponderado sem função de peso" << endl;
+        return nullptr;
+    }
+    text_sampler* sampler = new text_sampler;
+    sampler->config = *config;
+    prng_seed(&sampler->rng, config->seed ? config->seed : backend_stream_seed());
+    return sampler;
+}
+
+
+void sampler_destroy(text_sampler* sampler) {
+    delete sampler;
+}
+
+
+/**
+ * Monta a tabela do alias (Vose) em O(n): cada coluna guarda uma parte da probabilidade do próprio
+ * texto e completa o restante com um texto de peso acima da média.
+ */
+static void build_alias(text_sampler* sampler, const corpus_snapshot* snapshot) {
+    uint32_t n = sampler->count;
+    vector<double> scaled(n);
+    vector<char> decoded;
+    double sum = 0.0;
+    for (uint32_t i = 0; i < n; i++) {
+        text_view text;
+        if (snapshot->corpus) {
+            text.data = snapshot->corpus->arena + snapshot->corpus->offsets[i];
+            text.length = snapshot->corpus->lengths[i];
+        } else {
+            decoded.resize(packed_corpus_length(snapshot->packed, i) + 1);
+            text.length = packed_corpus_decode(snapshot->packed, i, decoded.data(), decoded.size());
+            text.data = decoded.data();
+        }
+        double weight = sampler->config.weight(i, text);
+        // Negativos e NaN falham a comparação e valem 0
+        scaled[i] = weight > 0.0 && std::isfinite(weight) ? weight : 0.0;
+        sum += scaled[i];
+    }
+    sampler->valid = sum > 0.0;
+    if (!sampler->valid) {
+        sampler->table.clear();
+        cerr << "Amostrador ponderado: todos os pesos são 0" << endl;
+        return;
+    }
+
+    vector<uint32_t> small;
+    vector<uint32_t> large;
+    for (uint32_t i = 0; i < n; i++) {
+        scaled[i] = scaled[i] * n / sum;
+        (scaled[i] < 1.0 ? small : large).push_back(i);
+    }
+    sampler->table.assign(n, alias_entry{UINT32_MAX, 0});
+    while (!small.empty() && !large.empty()) {
+        uint32_t low = small.back();
+        small.pop_back();
+        uint32_t high = large.back();
+        large.pop_back();
+        sampler->table[low] = alias_entry{static_cast<uint32_t>(scaled[low] * 4294967296.0), high};
+        scaled[high] = (scaled[high] + scaled[low]) - 1.0;
+        (scaled[high] < 1.0 ? small : large).push_back(high);
+    }
+    // O que sobra tem probabilidade 1 (a menos de arredondamento): a coluna aponta para si mesma
+    for (uint32_t i : large) {
+        sampler->table[i] = alias_entry{UINT32_MAX, i};
+    }
+    for (uint32_t i : small) {
+        sampler->table[i] = alias_entry{UINT32_MAX, i};
+    }
+}
+
+
+/**
+ * Refaz o estado para o snapshot atual, se ele mudou desde o último sorteio.
+ */
+static bool prepare(text_sampler* sampler, const corpus_snapshot* snapshot) {
+    if (snapshot->version == sampler->version) {
+        return sampler->valid;
+    }
+    TRACE_SCOPE("sampler_rebuild");
+    sampler->version = snapshot->version;
+    sampler->count = static_cast<uint32_t>(snapshot->count);
+    sampler->valid = sampler->count > 0;
+    if (!sampler->valid) {
+        return false;
+    }
+
+    switch (sampler->config.mode) {
+    case SAMPLER_UNIFORM:
+        break;
+    case SAMPLER_WEIGHTED:
+        build_alias(sampler, snapshot);
+        break;
+    case SAMPLER_SHUFFLE_BAG:
+    case SAMPLER_NO_REPEAT:
+        sampler->order.resize(sampler->count);
+        for (uint32_t i = 0; i < sampler->count; i++) {
+            sampler->order[i] = i;
+        }
+        sampler->position = 0;
+        sampler->cycled = false;
+        sampler->window = static_cast<uint32_t>(min<size_t>(sampler->config.window, sampler->count - 1));
+        sampler->filled = 0;
+        sampler->oldest = sampler->count - 1;
+        break;
+    }
+    return sampler->valid;
+}
+
+
+/**
+ * Um sorteio em O(1) sobre o estado já montado.
+ */
+static uint32_t draw(text_sampler* sampler) {
+    prng_state* rng = &sampler->rng;
+    uint32_t n = sampler->count;
+    switch (sampler->config.mode) {
+    case SAMPLER_UNIFORM:
+        break;
+
+    case SAMPLER_WEIGHTED: {
+        uint32_t column = prng_bounded(rng, n);
+        const alias_entry& entry = sampler->table[column];
+        return static_cast<uint32_t>(prng_next(rng) >> 32) < entry.threshold ? column : entry.alias;
+    }
+
+    case SAMPLER_SHUFFLE_BAG: {
+        // Passo de Fisher-Yates: escolhe um dos textos ainda não mostrados no ciclo e o traz para a posição.
+        // No início de um ciclo, a última posição (o texto mostrado por último) fica de fora
+        uint32_t position = sampler->position;
+        uint32_t chosen = position == 0 && sampler->cycled && n > 1 ? prng_bounded(rng, n - 1)
+                                                                     : position + prng_bounded(rng, n - position);
+        swap(sampler->order[position], sampler->order[chosen]);
+        sampler->position = position + 1 == n ? 0 : position + 1;
+        sampler->cycled = sampler->cycled || sampler->position == 0;
+        return sampler->order[position];
+    }
+
+    case SAMPLER_NO_REPEAT: {
+        if (sampler->window == 0) {
+            break;
+        }
+        vector<uint32_t>& order = sampler->order;
+        // order[0, n - janela) são os textos disponíveis; o fim de order é a janela, em anel
+        if (sampler->filled < sampler->window) {
+            uint32_t available = n - sampler->filled;
+            uint32_t chosen = prng_bounded(rng, available);
+            swap(order[chosen], order[available - 1]);
+            sampler->filled++;
+            return order[available - 1];
+        }
+        uint32_t chosen = prng_bounded(rng, n - sampler->window);
+        uint32_t text = order[chosen];
+        // O mais antigo da janela volta a ficar disponível no lugar do sorteado, que entra na janela
+        order[chosen] = order[sampler->oldest];
+        order[sampler->oldest] = text;
+        sampler->oldest = sampler->oldest == n - sampler->window ? n - 1 : sampler->oldest - 1;
+        return text;
+    }
+    }
+    return prng_bounded(rng, n);
+}
+
+
+/**
+ * Snapshot atual, carregando o primeiro corpus se necessário. Deve ser chamada dentro de uma seção de leitura.
+ */
+static const corpus_snapshot* current_snapshot() {
+    const corpus_snapshot* snapshot = snapshot_current();
+    if (!snapshot && get_corpus_count() > 0) {
+        snapshot = snapshot_current();
+    }
+    return snapshot;
+}
+
+
+bool sampler_next_index(text_sampler* sampler, uint32_t* index) {
+    snapshot_read_guard guard;
+    const corpus_snapshot* snapshot = current_snapshot();
+    if (!snapshot || !prepare(sampler, snapshot)) {
+        return false;
+    }
+    *index = draw(sampler);
+    return true;
+}
+
+
+size_t sampler_next_indices(text_sampler* sampler, size_t n, uint32_t* indices) {
+    snapshot_read_guard guard;
+    const corpus_snapshot* snapshot = current_snapshot();
+    if (!snapshot || !prepare(sampler, snapshot)) {
+        return 0;
+    }
+    for (size_t i = 0; i < n; i++) {
+        indices[i] = draw(sampler);
+    }
+    return n;
+}
+
+
+bool sampler_next_view(text_sampler* sampler, text_view* view) {
+    snapshot_read_guard guard;
+    const corpus_snapshot* snapshot = current_snapshot();
+    if (!snapshot || !snapshot->corpus || !prepare(sampler, snapshot)) {
+        return false;
+    }
+    uint32_t index = draw(sampler);
+    view->data = snapshot->corpus->arena + snapshot->corpus->offsets[index];
+    view->length = snapshot->corpus->lengths[index];
+    return true;
+}
+
+
+size_t sampler_next_into(text_sampler* sampler, char* buffer, size_t capacity) {
+    snapshot_read_guard guard;
+    const corpus_snapshot* snapshot = current_snapshot();
+    if (!snapshot || capacity == 0 || !prepare(sampler, snapshot)) {
+        return 0;
+    }
+    uint32_t index = draw(sampler);
+    if (snapshot->packed) {
+        return packed_corpus_decode(snapshot->packed, index, buffer, capacity);
+    }
+    const text_corpus* corpus = snapshot->corpus;
+    size_t length = corpus->lengths[index] < capacity - 1 ? corpus->lengths[index] : capacity - 1;
+    memcpy(buffer, corpus->arena + corpus->offsets[index], length);
+    buffer[length] = '\0';
+    return length;
+}
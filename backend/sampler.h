@@ -0,0 +1,77 @@
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+#include "backend.h"
+
+/**
+ * Amostradores sobre o corpus publicado, com custo O(1) por sorteio em qualquer modo:
+ * - SAMPLER_UNIFORM: uniforme, como get_random_text() (Lemire, sem viés de módulo).
+ * - SAMPLER_WEIGHTED: cada texto com probabilidade proporcional ao seu peso (método do alias, de Vose).
+ * - SAMPLER_SHUFFLE_BAG: cada ciclo de get_corpus_count() sorteios mostra todos os textos uma vez, em ordem
+ *   aleatória (Fisher-Yates incremental, sem pausa para reembaralhar); o primeiro de um ciclo nunca repete
+ *   o último do anterior.
+ * - SAMPLER_NO_REPEAT: uniforme entre os textos que não saíram nos últimos `window` sorteios.
+ *
+ * Cada amostrador tem seu próprio gerador e estado e pertence a uma única thread: nenhum sorteio usa
+ * lock ou operação atômica além da leitura do snapshot. Threads diferentes criam amostradores próprios.
+ * O estado (tabela do alias, permutação) é montado em O(n) no primeiro sorteio e refeito quando o
+ * corpus é trocado; com milhões de textos, ocupa 8 bytes (alias) ou 4 bytes (demais modos) por texto.
+ */
+struct text_sampler;
+
+enum sampler_mode {
+    SAMPLER_UNIFORM,
+    SAMPLER_WEIGHTED,
+    SAMPLER_SHUFFLE_BAG,
+    SAMPLER_NO_REPEAT,
+};
+
+/**
+ * Peso de um texto (>= 0; pesos negativos ou NaN valem 0). Chamado para todos os textos a cada montagem
+ * da tabela, com o texto já decodificado se o corpus estiver compactado.
+ */
+using sampler_weight_fn = std::function<double(uint32_t index, text_view text)>;
+
+struct sampler_config {
+    sampler_mode mode = SAMPLER_UNIFORM;
+    sampler_weight_fn weight;       // SAMPLER_WEIGHTED
+    size_t window = 0;              // SAMPLER_NO_REPEAT (limitado a get_corpus_count() - 1)
+    uint64_t seed = 0;              // 0 = derivada do gerador da thread (reproduzível com backend_set_seed())
+};
+
+/**
+ * Cria um amostrador. Retorna nullptr se a configuração for inválida.
+ */
+text_sampler* sampler_create(const sampler_config* config);
+void sampler_destroy(text_sampler* sampler);
+
+/**
+ * Sorteia o índice do próximo texto.
+ *
+ * @return false se o corpus não pôde ser carregado ou todos os pesos são 0
+ */
+bool sampler_next_index(text_sampler* sampler, uint32_t* index);
+
+/**
+ * Sorteia n índices de uma vez (mesmo snapshot para todo o lote).
+ *
+ * @return Quantidade de índices preenchidos (n, ou 0 em caso de erro)
+ */
+size_t sampler_next_indices(text_sampler* sampler, size_t n, uint32_t* indices);
+
+/**
+ * Sorteia um texto e devolve uma visão emprestada, com a mesma validade de get_random_text_view().
+ * Retorna false em caso de erro ou se o corpus está compactado.
+ */
+bool sampler_next_view(text_sampler* sampler, text_view* view);
+
+/**
+ * Sorteia um texto e o copia (decodificando, se compactado) para o buffer, como get_random_text_into().
+ */
+size_t sampler_next_into(text_sampler* sampler, char* buffer, size_t capacity);
+
+#endif
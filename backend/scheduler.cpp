@@ -0,0 +1,279 @@
+#include <iostream>
+#include <cerrno>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+#include <poll.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "scheduler.h"
+#include "trace.h"
+
+using namespace std;
+
+struct scheduler_job {
+    int64_t deadline;
+    int64_t period;             // 0 = execução única
+    shared_ptr<scheduler_fn> fn;
+    uint64_t last_pass;         // Último despacho em que rodou
+};
+
+/**
+ * Entrada do heap de prazos. Cancelamentos e reagendamentos não removem entradas antigas:
+ * elas são descartadas ao chegar ao topo, se não corresponderem mais ao prazo da tarefa.
+ */
+struct scheduler_entry {
+    int64_t deadline;
+    uint64_t job;
+
+    bool operator>(const scheduler_entry& other) const {
+        return deadline != other.deadline ? deadline > other.deadline : job > other.job;
+    }
+};
+
+struct scheduler {
+    scheduler_loop_ops ops;
+    int64_t coalesce_ns;
+    uint64_t next_id = 1;
+    unordered_map<uint64_t, scheduler_job> jobs;
+    priority_queue<scheduler_entry, vector<scheduler_entry>, greater<scheduler_entry>> heap;
+    int64_t armed = -1;         // Prazo atualmente armado no laço
+    bool dispatching = false;
+    uint64_t pass = 0;
+};
+
+
+int64_t monotonic_now_ns() {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<int64_t>(now.tv_sec) * 1000000000LL + now.tv_nsec;
+}
+
+
+/**
+ * Descarta as entradas obsoletas do topo do heap e retorna o prazo mais próximo (-1 se não houver).
+ */
+static int64_t earliest_deadline(scheduler* sched) {
+    while (!sched->heap.empty()) {
+        const scheduler_entry& top = sched->heap.top();
+        auto it = sched->jobs.find(top.job);
+        if (it != sched->jobs.end() && it->second.deadline == top.deadline) {
+            return top.deadline;
+        }
+        sched->heap.pop();
+    }
+    return -1;
+}
+
+
+/**
+ * Rearma o timer do laço se o prazo mais próximo mudou (adiado até o fim de um despacho).
+ */
+static void rearm(scheduler* sched) {
+    if (sched->dispatching) {
+        return;
+    }
+    int64_t deadline = earliest_deadline(sched);
+    if (deadline != sched->armed) {
+        sched->armed = deadline;
+        sched->ops.set_timer(sched->ops.user, deadline);
+    }
+}
+
+
+scheduler* scheduler_create(const scheduler_loop_ops* ops, int64_t coalesce_ns) {
+    scheduler* sched = new scheduler;
+    sched->ops = *ops;
+    sched->coalesce_ns = coalesce_ns > 0 ? coalesce_ns : 0;
+    return sched;
+}
+
+
+void scheduler_destroy(scheduler* sched) {
+    if (!sched) {
+        return;
+    }
+    if (sched->armed >= 0) {
+        sched->ops.set_timer(sched->ops.user, -1);
+    }
+    delete sched;
+}
+
+
+static uint64_t add_job(scheduler* sched, int64_t deadline_ns, int64_t period_ns, scheduler_fn fn) {
+    if (!fn || period_ns < 0) {
+        return 0;
+    }
+    uint64_t id = sched->next_id++;
+    sched->jobs[id] = scheduler_job{deadline_ns, period_ns, make_shared<scheduler_fn>(move(fn)), 0};
+    sched->heap.push({deadline_ns, id});
+    rearm(sched);
+    return id;
+}
+
+
+uint64_t scheduler_add_periodic(scheduler* sched, int64_t first_deadline_ns, int64_t period_ns, scheduler_fn fn) {
+    if (period_ns <= 0) {
+        cerr << "Período inválido para tarefa periódica: " << period_ns << " ns" << endl;
+        return 0;
+    }
+    return add_job(sched, first_deadline_ns, period_ns, move(fn));
+}
+
+
+uint64_t scheduler_add_oneshot(scheduler* sched, int64_t deadline_ns, scheduler_fn fn) {
+    return add_job(sched, deadline_ns, 0, move(fn));
+}
+
+
+bool scheduler_cancel(scheduler* sched, uint64_t job) {
+    if (sched->jobs.erase(job) == 0) {
+        return false;
+    }
+    rearm(sched);
+    return true;
+}
+
+
+size_t scheduler_run_due(scheduler* sched) {
+    TRACE_SCOPE("scheduler_run_due");
+    int64_t now = monotonic_now_ns();
+    int64_t limit = now + sched->coalesce_ns;
+    size_t runs = 0;
+
+    sched->dispatching = true;
+    sched->pass++;
+    // Os prazos armados pelo laço já venceram; rearm() volta a armar ao final
+    sched->armed = -1;
+    for (;;) {
+        int64_t deadline = earliest_deadline(sched);
+        if (deadline < 0 || deadline > limit) {
+            break;
+        }
+        scheduler_entry entry = sched->heap.top();
+        scheduler_job& job = sched->jobs[entry.job];
+        // Uma tarefa de período menor que a janela de agrupamento roda uma vez por despacho
+        if (job.last_pass == sched->pass) {
+            break;
+        }
+        sched->heap.pop();
+        job.last_pass = sched->pass;
+
+        scheduler_tick tick{entry.job, deadline, now, 0};
+        shared_ptr<scheduler_fn> fn = job.fn;
+        if (job.period > 0) {
+            // Próximo prazo na grade original; prazos que já passaram são contados, não executados
+            if (now >= deadline + job.period) {
+                tick.missed = static_cast<uint64_t>((now - deadline) / job.period);
+            }
+            job.deadline = deadline + static_cast<int64_t>(tick.missed + 1) * job.period;
+            sched->heap.push({job.deadline, entry.job});
+        } else {
+            sched->jobs.erase(entry.job);
+        }
+
+        // O callback pode agendar ou cancelar tarefas (inclusive esta)
+        (*fn)(tick);
+        runs++;
+    }
+    sched->dispatching = false;
+    rearm(sched);
+    return runs;
+}
+
+
+int64_t scheduler_next_deadline(scheduler* sched) {
+    return earliest_deadline(sched);
+}
+
+
+size_t scheduler_job_count(const scheduler* sched) {
+    return sched->jobs.size();
+}
+
+
+struct scheduler_timerfd_loop {
+    int timer_fd = -1;
+    scheduler* sched = nullptr;
+};
+
+
+static void timerfd_set_timer(void* user, int64_t deadline_ns) {
+    scheduler_timerfd_loop* loop = static_cast<scheduler_timerfd_loop*>(user);
+    itimerspec spec;
+    memset(&spec, 0, sizeof(spec));
+    if (deadline_ns >= 0) {
+        // it_value zerado desarmaria o timer: prazos no passado viram o menor instante válido
+        int64_t value = deadline_ns > 0 ? deadline_ns : 1;
+        spec.it_value.tv_sec = static_cast<time_t>(value / 1000000000LL);
+        spec.it_value.tv_nsec = static_cast<long>(value % 1000000000LL);
+    }
+    if (timerfd_settime(loop->timer_fd, TFD_TIMER_ABSTIME, &spec, nullptr) != 0) {
+        cerr << "Erro ao armar timerfd: " << strerror(errno) << endl;
+    }
+}
+
+
+scheduler_timerfd_loop* scheduler_timerfd_create(int64_t coalesce_ns) {
+    scheduler_timerfd_loop* loop = new scheduler_timerfd_loop;
+    loop->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (loop->timer_fd < 0) {
+        cerr << "Erro ao criar timerfd: " << strerror(errno) << endl;
+        delete loop;
+        return nullptr;
+    }
+    scheduler_loop_ops ops{loop, timerfd_set_timer};
+    loop->sched = scheduler_create(&ops, coalesce_ns);
+    return loop;
+}
+
+
+void scheduler_timerfd_destroy(scheduler_timerfd_loop* loop) {
+    if (!loop) {
+        return;
+    }
+    scheduler_destroy(loop->sched);
+    close(loop->timer_fd);
+    delete loop;
+}
+
+
+scheduler* scheduler_timerfd_scheduler(scheduler_timerfd_loop* loop) {
+    return loop->sched;
+}
+
+
+int scheduler_timerfd_fd(const scheduler_timerfd_loop* loop) {
+    return loop->timer_fd;
+}
+
+
+size_t scheduler_timerfd_dispatch(scheduler_timerfd_loop* loop) {
+    uint64_t expirations;
+    // EAGAIN (disparo já consumido) não é erro: as tarefas vencidas rodam de qualquer forma
+    ssize_t result = read(loop->timer_fd, &expirations, sizeof(expirations));
+    (void)result;
+    return scheduler_run_due(loop->sched);
+}
+
+
+int scheduler_timerfd_run_once(scheduler_timerfd_loop* loop, int max_wait_ms) {
+    pollfd fd{loop->timer_fd, POLLIN, 0};
+    int ready = poll(&fd, 1, max_wait_ms);
+    if (ready < 0) {
+        if (errno == EINTR) {
+            return 0;
+        }
+        cerr << "Erro em poll: " << strerror(errno) << endl;
+        return -1;
+    }
+    if (ready == 0) {
+        return 0;
+    }
+    return static_cast<int>(scheduler_timerfd_dispatch(loop));
+}
@@ -0,0 +1,119 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+/**
+ * Agendador de tarefas por prazo absoluto, em nanossegundos do relógio monotônico.
+ *
+ * Tarefas periódicas têm prazos deadline0 + k * período, calculados a partir do prazo anterior e não do
+ * instante em que a tarefa rodou: atrasos de uma execução não se acumulam (sem deriva), e se o laço
+ * ficar parado por mais de um período a tarefa roda uma única vez, informando quantos prazos perdeu.
+ *
+ * Como o fetch_engine, o agendador não tem laço próprio: ele arma um único timer (set_timer) para o
+ * prazo mais próximo entre todas as tarefas, e o laço do chamador (Qt, timerfd, ...) chama
+ * scheduler_run_due() quando ele vence. Tarefas com prazos a menos de `coalesce_ns` umas das outras
+ * rodam no mesmo despertar. Todas as funções devem ser chamadas na thread do laço, e os callbacks
+ * executam nela.
+ */
+struct scheduler;
+
+/**
+ * Integração com o laço de eventos. set_timer (re)arma o timer único para o instante absoluto
+ * `deadline_ns` (monotonic_now_ns); deadline_ns < 0 o desarma. Não deve chamar o agendador de volta.
+ */
+struct scheduler_loop_ops {
+    void* user;
+    void (*set_timer)(void* user, int64_t deadline_ns);
+};
+
+/**
+ * Informações de uma execução.
+ */
+struct scheduler_tick {
+    uint64_t job;
+    int64_t deadline_ns;        // Prazo desta execução (múltiplo exato do período, nas periódicas)
+    int64_t now_ns;             // Instante em que a execução começou
+    uint64_t missed;            // Prazos anteriores pulados por atraso do laço
+};
+
+using scheduler_fn = std::function<void(const scheduler_tick&)>;
+
+// Janela padrão de agrupamento de despertares
+static const int64_t SCHEDULER_DEFAULT_COALESCE_NS = 1000000;
+
+/**
+ * Relógio monotônico (CLOCK_MONOTONIC), em nanossegundos.
+ */
+int64_t monotonic_now_ns();
+
+scheduler* scheduler_create(const scheduler_loop_ops* ops, int64_t coalesce_ns = SCHEDULER_DEFAULT_COALESCE_NS);
+
+/**
+ * Desarma o timer e libera o agendador e as tarefas (sem executá-las).
+ */
+void scheduler_destroy(scheduler* sched);
+
+/**
+ * Agenda uma tarefa periódica.
+ *
+ * @param first_deadline_ns Prazo da primeira execução (monotonic_now_ns)
+ * @param period_ns Período (> 0)
+ * @return Identificador da tarefa (0 em caso de erro)
+ */
+uint64_t scheduler_add_periodic(scheduler* sched, int64_t first_deadline_ns, int64_t period_ns, scheduler_fn fn);
+
+/**
+ * Agenda uma execução única.
+ */
+uint64_t scheduler_add_oneshot(scheduler* sched, int64_t deadline_ns, scheduler_fn fn);
+
+/**
+ * Cancela uma tarefa (pode ser chamada de dentro de um callback, inclusive o da própria tarefa).
+ *
+ * @return true se a tarefa existia
+ */
+bool scheduler_cancel(scheduler* sched, uint64_t job);
+
+/**
+ * Executa as tarefas vencidas (ou a menos de coalesce_ns do prazo) e rearma o timer.
+ *
+ * @return Número de execuções
+ */
+size_t scheduler_run_due(scheduler* sched);
+
+/**
+ * Prazo mais próximo entre as tarefas, ou -1 se não houver tarefas.
+ */
+int64_t scheduler_next_deadline(scheduler* sched);
+
+size_t scheduler_job_count(const scheduler* sched);
+
+
+/**
+ * Laço baseado em timerfd (CLOCK_MONOTONIC, prazo absoluto), para uso sem interface gráfica.
+ * O descritor pode ser observado em um epoll externo; quando ficar legível, chame scheduler_timerfd_dispatch().
+ */
+struct scheduler_timerfd_loop;
+
+scheduler_timerfd_loop* scheduler_timerfd_create(int64_t coalesce_ns = SCHEDULER_DEFAULT_COALESCE_NS);
+void scheduler_timerfd_destroy(scheduler_timerfd_loop* loop);
+
+scheduler* scheduler_timerfd_scheduler(scheduler_timerfd_loop* loop);
+int scheduler_timerfd_fd(const scheduler_timerfd_loop* loop);
+
+/**
+ * Consome o disparo do timerfd e executa as tarefas vencidas.
+ */
+size_t scheduler_timerfd_dispatch(scheduler_timerfd_loop* loop);
+
+/**
+ * Espera o próximo prazo por até `max_wait_ms` (-1 = sem limite) e executa as tarefas vencidas.
+ *
+ * @return Número de execuções, ou -1 em caso de erro
+ */
+int scheduler_timerfd_run_once(scheduler_timerfd_loop* loop, int max_wait_ms);
+
+#endif
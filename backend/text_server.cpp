@@ -0,0 +1,574 @@
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "text_server.h"
+#include "backend.h"
+#include "scheduler.h"
+#include "trace.h"
+#include "unix_socket.h"
+#include "lib_gentexts.h"
+
+using namespace std;
+
+// Maior linha de requisição aceita: acima disso a conexão é encerrada
+static const size_t SERVER_MAX_LINE = 64;
+// Bytes lidos de uma conexão por evento, para que uma conexão não monopolize a thread
+static const size_t SERVER_READ_CHUNK = 64 * 1024;
+// Com mais que isso pendente de envio, a conexão deixa de ser lida e respondida até o cliente consumir as respostas
+static const size_t SERVER_OUT_LIMIT = 4 * 1024 * 1024;
+// Maior "TEXT <n>" aceito: a resposta de um lote (até GENTEXTS_MAX_TEXT_BYTES por linha) cabe no limite da saída
+static const size_t SERVER_MAX_BATCH = SERVER_OUT_LIMIT / GENTEXTS_MAX_TEXT_BYTES - 1;
+static const int SERVER_MAX_EVENTS = 64;
+static const int SERVER_ACCEPT_BURST = 32;
+
+// Respostas fixas
+static const char REPLY_PONG[] = "+PONG\n";
+static const char REPLY_UNKNOWN[] = "-ERR comando desconhecido\n";
+static const char REPLY_BAD_COUNT[] = "-ERR quantidade invalida\n";
+static const char REPLY_NO_CORPUS[] = "-ERR corpus indisponivel\n";
+static const char REPLY_NO_TIME[] = "-ERR relogio remoto indisponivel\n";
+static const char REPLY_LINE_TOO_LONG[] = "-ERR linha longa demais\n";
+
+struct server_conn {
+    int fd;
+    vector<char> in;            // Bytes recebidos e ainda não respondidos
+    vector<char> out;           // Respostas ainda não enviadas
+    size_t out_sent = 0;
+    uint32_t events = 0;        // Eventos registrados no epoll
+    bool closing = false;       // Encerrar depois de enviar a saída pendente
+    bool backlog = false;       // `in` tem linhas completas à espera de a saída pendente baixar do limite
+};
+
+struct server_worker {
+    text_server* server = nullptr;
+    int epoll_fd = -1;
+    thread runner;
+    string thread_name;         // Nome da thread no rastreamento
+    unordered_map<int, server_conn*> conns;
+    vector<text_view> views;    // Sorteios de um lote, reutilizado
+
+    // Resposta de TIME já formatada e o instante em que foi montada
+    char time_line[32];
+    size_t time_length = 0;
+    int64_t time_formatted_at = 0;
+
+    atomic<uint64_t> connections{0};
+    atomic<uint64_t> requests{0};
+    atomic<uint64_t> texts{0};
+    atomic<uint64_t> errors{0};
+};
+
+struct text_server {
+    text_server_config config;
+    string unix_path;
+    int unix_fd = -1;
+    int tcp_fd = -1;
+    int tcp_port = 0;
+    int stop_fd = -1;           // eventfd observado por todas as threads; nunca é lido
+    vector<server_worker*> workers;
+};
+
+
+static void append(vector<char>& out, const char* data, size_t length) {
+    out.insert(out.end(), data, data + length);
+}
+
+
+template <size_t N>
+static void append_reply(server_worker* worker, vector<char>& out, const char (&reply)[N]) {
+    append(out, reply, N - 1);
+    worker->errors.fetch_add(1, memory_order_relaxed);
+}
+
+
+/**
+ * Formata "<prefixo><valor>\n" em dst (pelo menos 24 bytes) e retorna o tamanho.
+ */
+static size_t format_number(char* dst, char prefix, uint64_t value) {
+    char digits[24];
+    size_t pos = sizeof(digits);
+    digits[--pos] = '\n';
+    do {
+        digits[--pos] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value);
+    digits[--pos] = prefix;
+    memcpy(dst, digits + pos, sizeof(digits) - pos);
+    return sizeof(digits) - pos;
+}
+
+
+static void append_number(vector<char>& out, char prefix, uint64_t value) {
+    char line[24];
+    append(out, line, format_number(line, prefix, value));
+}
+
+
+/**
+ * Responde "TEXT <n>": sorteia o lote de uma vez (visões sem cópia) e copia os textos para a saída.
+ * Com o corpus compactado, cada texto é decodificado diretamente no buffer de saída.
+ */
+static void reply_texts(server_worker* worker, vector<char>& out, size_t n) {
+    worker->views.resize(n);
+    size_t drawn = get_random_texts(n, worker->views.data());
+    if (drawn == n) {
+        size_t bytes = 0;
+        for (size_t i = 0; i < n; i++) {
+            bytes += worker->views[i].length + 1;
+        }
+        append_number(out, '*', n);
+        size_t pos = out.size();
+        out.resize(pos + bytes);
+        for (size_t i = 0; i < n; i++) {
+            memcpy(&out[pos], worker->views[i].data, worker->views[i].length);
+            pos += worker->views[i].length;
+            out[pos++] = '\n';
+        }
+        worker->texts.fetch_add(n, memory_order_relaxed);
+        return;
+    }
+
+    size_t header = out.size();
+    append_number(out, '*', n);
+    for (size_t i = 0; i < n; i++) {
+        size_t pos = out.size();
+        out.resize(pos + GENTEXTS_MAX_TEXT_BYTES);
+        size_t length = get_random_text_into(&out[pos], GENTEXTS_MAX_TEXT_BYTES);
+        if (length == 0) {
+            out.resize(header);
+            append_reply(worker, out, REPLY_NO_CORPUS);
+            return;
+        }
+        out[pos + length] = '\n';
+        out.resize(pos + length + 1);
+    }
+    worker->texts.fetch_add(n, memory_order_relaxed);
+}
+
+
+static void reply_time(server_worker* worker, vector<char>& out) {
+    int64_t now = monotonic_now_ns();
+    if (worker->time_length == 0 || now - worker->time_formatted_at >= worker->server->config.time_cache_ns) {
+        int64_t unix_ns;
+        if (!get_remote_time_ns(&unix_ns)) {
+            append_reply(worker, out, REPLY_NO_TIME);
+            return;
+        }
+        worker->time_length = format_number(worker->time_line, ':', static_cast<uint64_t>(unix_ns));
+        worker->time_formatted_at = now;
+    }
+    append(out, worker->time_line, worker->time_length);
+}
+
+
+/**
+ * Interpreta uma linha (sem o '\n') e acrescenta a resposta à saída da conexão.
+ */
+static void handle_line(server_worker* worker, server_conn* conn, const char* line, size_t length) {
+    if (length > 0 && line[length - 1] == '\r') {
+        length--;
+    }
+    worker->requests.fetch_add(1, memory_order_relaxed);
+
+    if (length >= 4 && memcmp(line, "TEXT", 4) == 0 && (length == 4 || line[4] == ' ')) {
+        size_t n = length == 4 ? 1 : 0;
+        bool valid = length == 4;
+        for (size_t i = 5; i < length && n <= worker->server->config.max_batch; i++) {
+            valid = line[i] >= '0' && line[i] <= '9';
+            if (!valid) {
+                break;
+            }
+            n = n * 10 + static_cast<size_t>(line[i] - '0');
+        }
+        if (!valid || n == 0 || n > worker->server->config.max_batch) {
+            append_reply(worker, conn->out, REPLY_BAD_COUNT);
+            return;
+        }
+        reply_texts(worker, conn->out, n);
+    } else if (length == 4 && memcmp(line, "TIME", 4) == 0) {
+        reply_time(worker, conn->out);
+    } else if (length == 4 && memcmp(line, "PING", 4) == 0) {
+        append(conn->out, REPLY_PONG, sizeof(REPLY_PONG) - 1);
+    } else {
+        append_reply(worker, conn->out, REPLY_UNKNOWN);
+    }
+}
+
+
+static void update_events(server_worker* worker, server_conn* conn) {
+    uint32_t events = 0;
+    if (!conn->closing && !conn->backlog && conn->out.size() - conn->out_sent < SERVER_OUT_LIMIT) {
+        events |= EPOLLIN;
+    }
+    if (conn->out_sent < conn->out.size()) {
+        events |= EPOLLOUT;
+    }
+    if (events == conn->events) {
+        return;
+    }
+    epoll_event event{};
+    event.events = events;
+    event.data.fd = conn->fd;
+    epoll_ctl(worker->epoll_fd, EPOLL_CTL_MOD, conn->fd, &event);
+    conn->events = events;
+}
+
+
+static void close_conn(server_worker* worker, server_conn* conn) {
+    epoll_ctl(worker->epoll_fd, EPOLL_CTL_DEL, conn->fd, nullptr);
+    close(conn->fd);
+    worker->conns.erase(conn->fd);
+    delete conn;
+}
+
+
+/**
+ * Envia o máximo possível da saída pendente. Retorna false se o envio falhou.
+ */
+static bool flush_conn(server_conn* conn) {
+    while (conn->out_sent < conn->out.size()) {
+        ssize_t sent = send(conn->fd, conn->out.data() + conn->out_sent, conn->out.size() - conn->out_sent,
+                            MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        conn->out_sent += static_cast<size_t>(sent);
+    }
+    // Tudo enviado: o buffer é esvaziado, mas mantém a capacidade para as próximas respostas
+    conn->out.clear();
+    conn->out_sent = 0;
+    return true;
+}
+
+
+/**
+ * Envia a saída pendente; retorna false se a conexão deve ser fechada (erro, ou encerramento
+ * pedido e nada mais a enviar).
+ */
+static bool flush_or_finish(server_conn* conn) {
+    return flush_conn(conn) && !(conn->closing && conn->out.empty());
+}
+
+
+/**
+ * Responde as linhas completas de `in` em uma única seção de leitura do corpus, até a saída pendente
+ * atingir SERVER_OUT_LIMIT: as linhas restantes ficam em `in` (backlog) e são respondidas quando o
+ * envio a fizer baixar. Retorna false se a conexão deve ser fechada.
+ */
+static bool process_lines(server_worker* worker, server_conn* conn) {
+    conn->backlog = false;
+    // A parte já enviada sai da frente: com o cliente lendo devagar, a saída nunca esvaziaria por completo
+    if (conn->out_sent > 0) {
+        conn->out.erase(conn->out.begin(), conn->out.begin() + static_cast<ptrdiff_t>(conn->out_sent));
+        conn->out_sent = 0;
+    }
+    {
+        TRACE_SCOPE("text_server/batch");
+        corpus_read_guard guard;
+        const char* begin = conn->in.data();
+        const char* end = begin + conn->in.size();
+        while (begin < end) {
+            if (conn->out.size() - conn->out_sent >= SERVER_OUT_LIMIT) {
+                conn->backlog = memchr(begin, '\n', static_cast<size_t>(end - begin)) != nullptr;
+                break;
+            }
+            const char* newline = static_cast<const char*>(memchr(begin, '\n', static_cast<size_t>(end - begin)));
+            if (!newline) {
+                break;
+            }
+            handle_line(worker, conn, begin, static_cast<size_t>(newline - begin));
+            begin = newline + 1;
+        }
+        conn->in.erase(conn->in.begin(), conn->in.begin() + (begin - conn->in.data()));
+    }
+    if (!conn->backlog && conn->in.size() > SERVER_MAX_LINE) {
+        append_reply(worker, conn->out, REPLY_LINE_TOO_LONG);
+        conn->in.clear();
+        conn->closing = true;
+    }
+    return flush_or_finish(conn);
+}
+
+
+/**
+ * Lê o que chegou e responde as linhas completas. Retorna false se a conexão deve ser fechada.
+ */
+static bool read_conn(server_worker* worker, server_conn* conn) {
+    size_t used = conn->in.size();
+    conn->in.resize(used + SERVER_READ_CHUNK);
+    ssize_t received;
+    do {
+        received = recv(conn->fd, conn->in.data() + used, SERVER_READ_CHUNK, MSG_DONTWAIT);
+    } while (received < 0 && errno == EINTR);
+    if (received <= 0) {
+        conn->in.resize(used);
+        if (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+            return false;
+        }
+        // Fim da entrada: as respostas já montadas ainda são enviadas antes de fechar
+        conn->closing = conn->closing || received == 0;
+        return flush_or_finish(conn);
+    }
+    conn->in.resize(used + static_cast<size_t>(received));
+    return process_lines(worker, conn);
+}
+
+
+/**
+ * A conexão pode ser escrita: envia a saída pendente e, se ela baixou do limite, retoma as linhas
+ * que ficaram em espera. Retorna false se a conexão deve ser fechada.
+ */
+static bool write_conn(server_worker* worker, server_conn* conn) {
+    if (!flush_conn(conn)) {
+        return false;
+    }
+    if (conn->backlog && conn->out.size() - conn->out_sent < SERVER_OUT_LIMIT) {
+        return process_lines(worker, conn);
+    }
+    return !(conn->closing && conn->out.empty());
+}
+
+
+static void accept_conns(server_worker* worker, int listen_fd) {
+    for (int i = 0; i < SERVER_ACCEPT_BURST; i++) {
+        int fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR && errno != ECONNABORTED) {
+                cerr << "Erro ao aceitar conexão: " << strerror(errno) << endl;
+            }
+            return;
+        }
+        if (listen_fd == worker->server->tcp_fd) {
+            // Respostas pequenas e em lote: não vale esperar o algoritmo de Nagle
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        }
+        server_conn* conn = new server_conn;
+        conn->fd = fd;
+        conn->events = EPOLLIN;
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(worker->epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            close(fd);
+            delete conn;
+            continue;
+        }
+        worker->conns[fd] = conn;
+        worker->connections.fetch_add(1, memory_order_relaxed);
+    }
+}
+
+
+static void worker_loop(server_worker* worker, int index) {
+    worker->thread_name = "text_server/" + to_string(index);
+    trace_set_thread_name(worker->thread_name.c_str());
+    text_server* server = worker->server;
+    epoll_event events[SERVER_MAX_EVENTS];
+    for (;;) {
+        int ready = epoll_wait(worker->epoll_fd, events, SERVER_MAX_EVENTS, -1);
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            cerr << "Erro no epoll_wait: " << strerror(errno) << endl;
+            break;
+        }
+        for (int i = 0; i < ready; i++) {
+            int fd = events[i].data.fd;
+            if (fd == server->stop_fd) {
+                return;
+            }
+            if (fd == server->unix_fd || fd == server->tcp_fd) {
+                accept_conns(worker, fd);
+                continue;
+            }
+            auto it = worker->conns.find(fd);
+            if (it == worker->conns.end()) {
+                continue;
+            }
+            server_conn* conn = it->second;
+            bool keep = true;
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                keep = false;
+            }
+            if (keep && (events[i].events & EPOLLOUT)) {
+                keep = write_conn(worker, conn);
+            }
+            if (keep && (events[i].events & EPOLLIN)) {
+                keep = read_conn(worker, conn);
+            }
+            if (keep) {
+                update_events(worker, conn);
+            } else {
+                close_conn(worker, conn);
+            }
+        }
+    }
+}
+
+
+static int listen_tcp(const char* host, int port, int* bound_port) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    if (inet_pton(AF_INET, host, &addr.sin_addr) != 1) {
+        cerr << "Endereço IPv4 inválido: " << host << endl;
+        return -1;
+    }
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        cerr << "Erro ao criar socket TCP: " << strerror(errno) << endl;
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    socklen_t length = sizeof(addr);
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(fd, SOMAXCONN) != 0 ||
+        getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &length) != 0) {
+        cerr << "Erro ao escutar em " << host << ":" << port << ": " << strerror(errno) << endl;
+        close(fd);
+        return -1;
+    }
+    *bound_port = ntohs(addr.sin_port);
+    return fd;
+}
+
+
+static void release_server(text_server* server) {
+    for (server_worker* worker : server->workers) {
+        for (auto& entry : worker->conns) {
+            close(entry.first);
+            delete entry.second;
+        }
+        if (worker->epoll_fd >= 0) {
+            close(worker->epoll_fd);
+        }
+        delete worker;
+    }
+    if (server->unix_fd >= 0) {
+        close(server->unix_fd);
+        unlink(server->unix_path.c_str());
+    }
+    if (server->tcp_fd >= 0) {
+        close(server->tcp_fd);
+    }
+    if (server->stop_fd >= 0) {
+        close(server->stop_fd);
+    }
+    delete server;
+}
+
+
+text_server* text_server_start(const text_server_config* config) {
+    if (!config->unix_path && !config->tcp_host) {
+        cerr << "Servidor de textos sem socket Unix nem TCP configurado" << endl;
+        return nullptr;
+    }
+    // Carrega o corpus antes de aceitar conexões, para a primeira requisição não pagar a geração
+    if (get_corpus_count() == 0) {
+        cerr << "Servidor de textos sem corpus disponível" << endl;
+        return nullptr;
+    }
+
+    text_server* server = new text_server;
+    server->config = *config;
+    if (server->config.threads <= 0) {
+        server->config.threads = max(1u, thread::hardware_concurrency());
+    }
+    if (server->config.max_batch > SERVER_MAX_BATCH) {
+        cerr << "Lote máximo reduzido para " << SERVER_MAX_BATCH << " textos (limite da saída por conexão)" << endl;
+        server->config.max_batch = SERVER_MAX_BATCH;
+    }
+    if (config->unix_path) {
+        server->unix_path = config->unix_path;
+        server->config.unix_path = server->unix_path.c_str();
+        server->unix_fd = unix_socket_listen(config->unix_path, SOCK_NONBLOCK, SOMAXCONN);
+    }
+    if (config->tcp_host) {
+        server->config.tcp_host = nullptr;
+        server->tcp_fd = listen_tcp(config->tcp_host, config->tcp_port, &server->tcp_port);
+    }
+    server->stop_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if ((config->unix_path && server->unix_fd < 0) || (config->tcp_host && server->tcp_fd < 0) || server->stop_fd < 0) {
+        release_server(server);
+        return nullptr;
+    }
+
+    for (int i = 0; i < server->config.threads; i++) {
+        server_worker* worker = new server_worker;
+        worker->server = server;
+        server->workers.push_back(worker);
+        worker->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if (worker->epoll_fd < 0) {
+            cerr << "Erro ao criar epoll: " << strerror(errno) << endl;
+            release_server(server);
+            return nullptr;
+        }
+        // Os sockets de escuta são compartilhados: EPOLLEXCLUSIVE acorda uma thread por conexão nova
+        for (int fd : {server->unix_fd, server->tcp_fd, server->stop_fd}) {
+            if (fd < 0) {
+                continue;
+            }
+            epoll_event event{};
+            event.events = EPOLLIN | (fd == server->stop_fd ? 0u : static_cast<uint32_t>(EPOLLEXCLUSIVE));
+            event.data.fd = fd;
+            epoll_ctl(worker->epoll_fd, EPOLL_CTL_ADD, fd, &event);
+        }
+    }
+    for (size_t i = 0; i < server->workers.size(); i++) {
+        server->workers[i]->runner = thread(worker_loop, server->workers[i], static_cast<int>(i));
+    }
+    return server;
+}
+
+
+int text_server_tcp_port(const text_server* server) {
+    return server->tcp_fd >= 0 ? server->tcp_port : 0;
+}
+
+
+void text_server_get_stats(const text_server* server, text_server_stats* stats) {
+    memset(stats, 0, sizeof(*stats));
+    for (const server_worker* worker : server->workers) {
+        stats->connections += worker->connections.load(memory_order_relaxed);
+        stats->requests += worker->requests.load(memory_order_relaxed);
+        stats->texts += worker->texts.load(memory_order_relaxed);
+        stats->errors += worker->errors.load(memory_order_relaxed);
+    }
+}
+
+
+void text_server_stop(text_server* server) {
+    if (!server) {
+        return;
+    }
+    // O eventfd fica legível para sempre: todas as threads acordam e saem
+    uint64_t one = 1;
+    if (write(server->stop_fd, &one, sizeof(one)) != sizeof(one)) {
+        cerr << "Erro ao sinalizar o fim do servidor: " << strerror(errno) << endl;
+    }
+    for (server_worker* worker : server->workers) {
+        if (worker->runner.joinable()) {
+            worker->runner.join();
+        }
+    }
+    release_server(server);
+}
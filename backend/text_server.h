@@ -0,0 +1,63 @@
+#ifndef TEXT_SERVER_H
+#define TEXT_SERVER_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Servidor de textos sem interface gráfica: expõe o corpus e o relógio remoto do backend a outros
+ * processos por um socket Unix e/ou TCP.
+ *
+ * Protocolo em linhas (terminadas por '\n'; '\r' opcional), com várias requisições por envio (pipelining):
+ * - "TEXT" ou "TEXT <n>"  -> "*<n>\n" seguido de n linhas, cada uma com um texto sorteado
+ * - "TIME"                -> ":<ns desde a época Unix>\n" (relógio remoto, ver backend_start_time_service())
+ * - "PING"                -> "+PONG\n"
+ * - erros                 -> "-ERR <motivo>\n" (linhas longas demais também fecham a conexão)
+ *
+ * Cada thread de trabalho tem seu próprio epoll e atende as conexões que aceitou; os sockets de escuta
+ * são compartilhados entre elas (EPOLLEXCLUSIVE). Todas as requisições já recebidas de uma conexão são
+ * respondidas em uma única seção de leitura do corpus, em um buffer de saída reutilizado, e enviadas
+ * com um único send(). Com 4 MiB de respostas pendentes, a conexão deixa de ser lida e respondida até o
+ * cliente consumi-las.
+ */
+struct text_server;
+
+struct text_server_config {
+    const char* unix_path = nullptr;    // Caminho do socket Unix (nullptr = sem socket Unix); ver unix_socket_listen()
+    const char* tcp_host = nullptr;     // Endereço IPv4 de escuta (nullptr = sem TCP)
+    int tcp_port = 0;                   // 0 = porta escolhida pelo sistema (ver text_server_tcp_port())
+    int threads = 0;                    // 0 = número de processadores
+    size_t max_batch = 4096;            // Maior n aceito em "TEXT <n>" (reduzido para o lote caber em 4 MiB)
+    int64_t time_cache_ns = 1000000;    // Validade da resposta de TIME já formatada, por thread
+};
+
+struct text_server_stats {
+    uint64_t connections;               // Conexões aceitas
+    uint64_t requests;                  // Requisições respondidas (inclusive com erro)
+    uint64_t texts;                     // Textos enviados
+    uint64_t errors;                    // Respostas de erro
+};
+
+/**
+ * Abre os sockets e inicia as threads de trabalho. O corpus deve estar configurado antes
+ * (é carregado aqui, se ainda não foi). Retorna nullptr em caso de erro.
+ */
+text_server* text_server_start(const text_server_config* config);
+
+/**
+ * Porta TCP efetiva (útil com tcp_port = 0), ou 0 se o servidor não escuta em TCP.
+ */
+int text_server_tcp_port(const text_server* server);
+
+/**
+ * Soma os contadores de todas as threads de trabalho.
+ */
+void text_server_get_stats(const text_server* server, text_server_stats* stats);
+
+/**
+ * Para as threads, fecha as conexões e os sockets de escuta (removendo o arquivo do socket Unix)
+ * e libera o servidor.
+ */
+void text_server_stop(text_server* server);
+
+#endif
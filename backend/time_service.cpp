@@ -0,0 +1,301 @@
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "time_service.h"
+#include "http_client.h"
+#include "worldtime.h"
+#include "trace.h"
+
+using namespace std;
+
+// Tempo máximo de uma sincronização; também limita a espera de time_service_stop()
+static const long TIME_FETCH_TIMEOUT_MS = 5000;
+// Após uma falha, tenta de novo antes do TTL
+static const int64_t TIME_RETRY_MS = 5000;
+// A deriva só é estimada entre amostras separadas por pelo menos este intervalo local...
+static const int64_t TIME_DRIFT_MIN_INTERVAL_NS = 10000000000LL;
+// ...e quando a incerteza do par (soma das metades dos RTTs) é pequena frente a ele
+static const double TIME_DRIFT_MAX_UNCERTAINTY_PPM = 50.0;
+// Deriva máxima aceita para um oscilador de computador; acima disso a amostra é descartada
+static const double TIME_DRIFT_LIMIT_PPM = 500.0;
+// Velocidade com que a diferença para uma nova amostra é absorvida (5%: 50 ms por segundo). Menor
+// que 1, então o relógio extrapolado só desacelera durante o ajuste e nunca volta no tempo
+static const double TIME_SLEW_RATE = 0.05;
+
+// Estado publicado pela última sincronização válida, protegido por um seqlock:
+// leitores nunca bloqueiam e repetem a leitura se uma publicação ocorreu no meio dela.
+// A partir de slew_start_ns, a diferença slew_offset_ns entre a extrapolação anterior e a nova é
+// somada à nova e reduzida linearmente até zero em slew_end_ns
+static atomic<uint32_t> sync_sequence{0};
+static atomic<bool> sync_valid{false};
+static atomic<int64_t> sync_local_ns{0};
+static atomic<int64_t> sync_remote_ns{0};
+static atomic<int64_t> sync_rtt_ns{0};
+static atomic<double> sync_drift_ppm{0.0};
+static atomic<int64_t> sync_slew_start_ns{0};
+static atomic<int64_t> sync_slew_end_ns{0};
+static atomic<int64_t> sync_slew_offset_ns{0};
+static atomic<uint64_t> sync_count{0};
+static atomic<uint64_t> failure_count{0};
+
+// Cópia consistente do estado publicado
+struct sync_state {
+    bool valid;
+    int64_t local_ns;
+    int64_t remote_ns;
+    int64_t rtt_ns;
+    double drift_ppm;
+    int64_t slew_start_ns;
+    int64_t slew_end_ns;
+    int64_t slew_offset_ns;
+};
+
+// Última amostra bruta e URL, usadas apenas por quem sincroniza (serializado por refresh_mutex)
+static mutex refresh_mutex;
+static string service_url;
+static bool has_sample = false;
+static int64_t sample_local_ns = 0;
+static int64_t sample_remote_ns = 0;
+static int64_t sample_rtt_ns = 0;
+static bool has_drift = false;
+
+// Thread de atualização em segundo plano
+static mutex worker_mutex;
+static condition_variable worker_wakeup;
+static thread worker;
+static bool worker_stop = false;
+static int64_t worker_ttl_ms = 0;
+
+
+static int64_t steady_now_ns() {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+/**
+ * Lê o estado publicado dentro do seqlock, repetindo se uma publicação ocorreu no meio da leitura.
+ * O instante local (now_ns) também é lido dentro dele: quem lê o estado anterior a uma publicação
+ * leu o relógio antes dela.
+ */
+static void read_sync(sync_state* state, int64_t* now_ns) {
+    uint32_t before, after;
+    do {
+        before = sync_sequence.load(memory_order_acquire);
+        state->valid = sync_valid.load(memory_order_relaxed);
+        state->local_ns = sync_local_ns.load(memory_order_relaxed);
+        state->remote_ns = sync_remote_ns.load(memory_order_relaxed);
+        state->rtt_ns = sync_rtt_ns.load(memory_order_relaxed);
+        state->drift_ppm = sync_drift_ppm.load(memory_order_relaxed);
+        state->slew_start_ns = sync_slew_start_ns.load(memory_order_relaxed);
+        state->slew_end_ns = sync_slew_end_ns.load(memory_order_relaxed);
+        state->slew_offset_ns = sync_slew_offset_ns.load(memory_order_relaxed);
+        *now_ns = steady_now_ns();
+        atomic_thread_fence(memory_order_acquire);
+        after = sync_sequence.load(memory_order_relaxed);
+    } while ((before & 1) || before != after);
+}
+
+
+/**
+ * Horário remoto extrapolado pelo estado no instante local now_ns, com a parte restante do ajuste.
+ */
+static int64_t extrapolate(const sync_state& state, int64_t now_ns) {
+    int64_t elapsed = now_ns - state.local_ns;
+    int64_t remote = state.remote_ns + elapsed + static_cast<int64_t>(static_cast<double>(elapsed) * state.drift_ppm * 1e-6);
+    if (now_ns < state.slew_end_ns) {
+        int64_t remaining = state.slew_end_ns - max(now_ns, state.slew_start_ns);
+        remote += static_cast<int64_t>(static_cast<double>(state.slew_offset_ns) * static_cast<double>(remaining) /
+                                       static_cast<double>(state.slew_end_ns - state.slew_start_ns));
+    }
+    return remote;
+}
+
+
+/**
+ * Publica uma nova sincronização para os leitores. A nova amostra não é aplicada de uma vez: a diferença
+ * para o valor que a sincronização anterior daria agora é absorvida a TIME_SLEW_RATE, então o horário
+ * retornado é contínuo e nunca anda para trás (o RTT/2 e a extrapolação de cada amostra têm erro).
+ * Chamada com refresh_mutex travado (único escritor, que lê o estado atual sem o seqlock).
+ */
+static void publish_sync(int64_t local_ns, int64_t remote_ns, int64_t rtt_ns, double drift_ppm) {
+    uint32_t sequence = sync_sequence.load(memory_order_relaxed);
+    sync_sequence.store(sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    // Lido com a sequência já ímpar: leitores que ainda usam o estado anterior leram o relógio antes deste instante
+    int64_t now = steady_now_ns();
+    sync_state next{true, local_ns, remote_ns, rtt_ns, drift_ppm, 0, 0, 0};
+    if (sync_valid.load(memory_order_relaxed)) {
+        sync_state previous{true,
+                            sync_local_ns.load(memory_order_relaxed),
+                            sync_remote_ns.load(memory_order_relaxed),
+                            sync_rtt_ns.load(memory_order_relaxed),
+                            sync_drift_ppm.load(memory_order_relaxed),
+                            sync_slew_start_ns.load(memory_order_relaxed),
+                            sync_slew_end_ns.load(memory_order_relaxed),
+                            sync_slew_offset_ns.load(memory_order_relaxed)};
+        int64_t offset = extrapolate(previous, now) - extrapolate(next, now);
+        if (offset != 0) {
+            double duration = static_cast<double>(offset < 0 ? -offset : offset) / TIME_SLEW_RATE;
+            next.slew_start_ns = now;
+            next.slew_end_ns = now + max<int64_t>(1, static_cast<int64_t>(duration));
+            next.slew_offset_ns = offset;
+        }
+    }
+
+    sync_local_ns.store(next.local_ns, memory_order_relaxed);
+    sync_remote_ns.store(next.remote_ns, memory_order_relaxed);
+    sync_rtt_ns.store(next.rtt_ns, memory_order_relaxed);
+    sync_drift_ppm.store(next.drift_ppm, memory_order_relaxed);
+    sync_slew_start_ns.store(next.slew_start_ns, memory_order_relaxed);
+    sync_slew_end_ns.store(next.slew_end_ns, memory_order_relaxed);
+    sync_slew_offset_ns.store(next.slew_offset_ns, memory_order_relaxed);
+    sync_valid.store(true, memory_order_relaxed);
+    sync_sequence.store(sequence + 2, memory_order_release);
+}
+
+
+/**
+ * Incorpora uma amostra (instante remoto associado ao ponto médio local da requisição).
+ * A deriva é a diferença entre o tempo decorrido no servidor e o local desde a amostra anterior,
+ * suavizada por média móvel exponencial; amostras próximas demais ou incertas demais não a alteram.
+ * Chamada com refresh_mutex travado.
+ */
+static void apply_sample_locked(int64_t local_ns, int64_t remote_ns, int64_t rtt_ns) {
+    double drift_ppm = sync_drift_ppm.load(memory_order_relaxed);
+
+    if (has_sample) {
+        int64_t local_elapsed = local_ns - sample_local_ns;
+        double uncertainty_ppm = 1e6 * (rtt_ns + sample_rtt_ns) / 2.0 / static_cast<double>(max<int64_t>(local_elapsed, 1));
+        if (local_elapsed >= TIME_DRIFT_MIN_INTERVAL_NS && uncertainty_ppm <= TIME_DRIFT_MAX_UNCERTAINTY_PPM) {
+            double measured = 1e6 * static_cast<double>((remote_ns - sample_remote_ns) - local_elapsed) /
+                              static_cast<double>(local_elapsed);
+            if (measured >= -TIME_DRIFT_LIMIT_PPM && measured <= TIME_DRIFT_LIMIT_PPM) {
+                drift_ppm = has_drift ? drift_ppm + (measured - drift_ppm) / 4.0 : measured;
+                has_drift = true;
+            }
+        }
+    }
+
+    has_sample = true;
+    sample_local_ns = local_ns;
+    sample_remote_ns = remote_ns;
+    sample_rtt_ns = rtt_ns;
+    publish_sync(local_ns, remote_ns, rtt_ns, drift_ppm);
+    sync_count.fetch_add(1, memory_order_relaxed);
+}
+
+
+bool time_service_refresh() {
+    TRACE_SCOPE("time_service_refresh");
+    lock_guard<mutex> lock(refresh_mutex);
+
+    http_buffer response;
+    long status = 0;
+    int64_t sent_ns = steady_now_ns();
+    bool ok = http_get(service_url.c_str(), &response, &status, TIME_FETCH_TIMEOUT_MS);
+    int64_t received_ns = steady_now_ns();
+
+    worldtime_info info;
+    worldtime_error error;
+    bool valid = ok && status == 200 && response.data && worldtime_parse(response.data, response.length, &info, &error);
+    http_buffer_free(&response);
+    if (!valid) {
+        if (ok && status != 200) {
+            cerr << "Serviço de horário respondeu HTTP " << status << endl;
+        } else if (ok) {
+            cerr << "Resposta inválida do serviço de horário: " << worldtime_error_message(error.code)
+                 << (error.field ? string(" (") + error.field + ")" : string()) << endl;
+        }
+        failure_count.fetch_add(1, memory_order_relaxed);
+        return false;
+    }
+
+    // O servidor leu o relógio em algum ponto da requisição; o ponto médio limita o erro a RTT/2
+    apply_sample_locked(sent_ns + (received_ns - sent_ns) / 2, info.unix_ns, received_ns - sent_ns);
+    return true;
+}
+
+
+bool time_service_now_ns(int64_t* unix_ns) {
+    sync_state state;
+    int64_t now;
+    read_sync(&state, &now);
+    if (!state.valid) {
+        return false;
+    }
+    *unix_ns = extrapolate(state, now);
+    return true;
+}
+
+
+void time_service_get_status(time_service_status* status) {
+    sync_state state;
+    int64_t now;
+    read_sync(&state, &now);
+    status->synced = state.valid;
+    status->last_sync_age_ns = state.valid ? now - state.local_ns : 0;
+    status->last_rtt_ns = state.rtt_ns;
+    status->drift_ppm = state.drift_ppm;
+    status->syncs = sync_count.load(memory_order_relaxed);
+    status->failures = failure_count.load(memory_order_relaxed);
+}
+
+
+/**
+ * Laço da thread de atualização: espera o TTL (ou menos, após uma falha) e sincroniza.
+ */
+static void worker_loop() {
+    trace_set_thread_name("time_service");
+    bool last_ok = sync_valid.load(memory_order_relaxed);
+    unique_lock<mutex> lock(worker_mutex);
+    while (!worker_stop) {
+        int64_t wait_ms = last_ok ? worker_ttl_ms : min(worker_ttl_ms, TIME_RETRY_MS);
+        if (worker_wakeup.wait_for(lock, chrono::milliseconds(wait_ms), []() { return worker_stop; })) {
+            break;
+        }
+        lock.unlock();
+        last_ok = time_service_refresh();
+        lock.lock();
+    }
+}
+
+
+bool time_service_start(const char* url, int64_t ttl_ms) {
+    time_service_stop();
+
+    {
+        lock_guard<mutex> lock(refresh_mutex);
+        // Amostras de outro servidor não servem para estimar a deriva deste
+        if (service_url != url) {
+            has_sample = false;
+            has_drift = false;
+        }
+        service_url = url;
+    }
+    bool ok = time_service_refresh();
+
+    lock_guard<mutex> lock(worker_mutex);
+    worker_stop = false;
+    worker_ttl_ms = max<int64_t>(ttl_ms, 1);
+    worker = thread(worker_loop);
+    return ok;
+}
+
+
+void time_service_stop() {
+    {
+        lock_guard<mutex> lock(worker_mutex);
+        worker_stop = true;
+    }
+    worker_wakeup.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
@@ -0,0 +1,66 @@
+#ifndef TIME_SERVICE_H
+#define TIME_SERVICE_H
+
+#include <cstdint>
+
+/**
+ * Relógio remoto extrapolado localmente.
+ *
+ * Uma requisição à worldtimeapi fornece o horário do servidor; o serviço o associa a uma leitura de
+ * std::chrono::steady_clock (no ponto médio da requisição, o que compensa metade do RTT) e passa a
+ * responder "que horas são no servidor" somente com o relógio local, em nanossegundos, sem rede.
+ * Uma thread em segundo plano refaz a sincronização a cada TTL e estima a deriva entre os dois
+ * relógios; se a rede falhar, a última sincronização válida continua sendo extrapolada. Cada nova
+ * sincronização é absorvida gradualmente (a 5% da velocidade do relógio), então o horário retornado
+ * é monotônico, sem saltos para trás entre uma sincronização e a seguinte.
+ */
+
+/**
+ * Estado da sincronização, para diagnóstico.
+ */
+struct time_service_status {
+    bool synced;                // Há ao menos uma sincronização válida
+    int64_t last_sync_age_ns;   // Tempo local desde a última sincronização válida
+    int64_t last_rtt_ns;        // RTT da última sincronização válida
+    double drift_ppm;           // Deriva estimada do relógio local em relação ao remoto (partes por milhão)
+    uint64_t syncs;             // Sincronizações bem-sucedidas
+    uint64_t failures;          // Tentativas que falharam (rede ou resposta inválida)
+};
+
+/**
+ * Inicia o serviço: sincroniza uma vez (de forma síncrona) e inicia a atualização em segundo plano.
+ * Se o serviço já estiver rodando, ele é reiniciado com os novos parâmetros.
+ *
+ * @param url URL no formato da worldtimeapi (resposta interpretada por worldtime_parse())
+ * @param ttl_ms Intervalo entre sincronizações
+ * @return true se a sincronização inicial teve sucesso (em caso de falha, o serviço continua tentando)
+ */
+bool time_service_start(const char* url, int64_t ttl_ms);
+
+/**
+ * Para a atualização em segundo plano. A última sincronização continua disponível em time_service_now_ns().
+ */
+void time_service_stop();
+
+/**
+ * Sincroniza imediatamente, na thread chamadora.
+ *
+ * @return true em caso de sucesso; em caso de falha, a sincronização anterior é mantida
+ */
+bool time_service_refresh();
+
+/**
+ * Horário remoto atual extrapolado, em nanossegundos desde a época Unix.
+ * Não acessa a rede nem bloqueia: lê o estado publicado pela última sincronização.
+ * Chamadas seguintes (em qualquer thread) nunca retornam um valor menor.
+ *
+ * @return true em caso de sucesso; false se nunca houve uma sincronização válida
+ */
+bool time_service_now_ns(int64_t* unix_ns);
+
+/**
+ * Preenche `status` com o estado atual da sincronização.
+ */
+void time_service_get_status(time_service_status* status);
+
+#endif
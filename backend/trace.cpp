@@ -0,0 +1,367 @@
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+#include "trace.h"
+
+using namespace std;
+
+enum trace_event_type : uint32_t {
+    TRACE_EVENT_COMPLETE,
+    TRACE_EVENT_INSTANT,
+    TRACE_EVENT_COUNTER,
+};
+
+/**
+ * Um evento no buffer circular. Os campos são atômicos (acessos relaxados, sem custo extra em x86)
+ * para que a exportação possa lê-los enquanto a thread dona grava.
+ */
+struct trace_event {
+    atomic<const char*> name;
+    atomic<uint64_t> start;
+    atomic<uint64_t> end;   // Fim (duração) ou valor (contador)
+    atomic<uint32_t> type;
+};
+
+/**
+ * Thread que gravou os eventos de um buffer a partir de first_event (inclusive).
+ */
+struct trace_owner {
+    uint64_t first_event;
+    long tid;
+    const char* thread_name;
+};
+
+/**
+ * Buffer de uma thread. Só a thread dona escreve; `head` conta os eventos já gravados
+ * (o evento i fica em events[i % TRACE_RING_EVENTS]).
+ *
+ * O buffer de uma thread encerrada passa à próxima thread criada. Os eventos das donas anteriores
+ * continuam exportados (com o tid delas) até serem sobrescritos: `previous` guarda as donas cujos
+ * eventos ainda estão no buffer, e `tid`, `first_event` e `previous` só mudam com rings_mutex travado.
+ */
+struct trace_ring {
+    atomic<uint64_t> head{0};
+    long tid = 0;
+    uint64_t first_event = 0;
+    atomic<const char*> thread_name{nullptr};
+    vector<trace_owner> previous;
+    trace_event events[TRACE_RING_EVENTS];
+};
+
+/**
+ * Verifica se o TSC é invariante (mesma frequência em todos os núcleos e estados de energia).
+ */
+static bool detect_invariant_tsc() {
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)) {
+        return (edx >> 8) & 1;
+    }
+#endif
+    return false;
+}
+
+atomic<bool> trace_active{false};
+bool trace_use_tsc = detect_invariant_tsc();
+
+// Buffers de todas as threads que já gravaram; mantidos após o fim da thread para a exportação.
+// Nunca destruídos: threads ainda podem gravar durante a destruição dos objetos estáticos.
+static mutex rings_mutex;
+static vector<trace_ring*>& rings = *new vector<trace_ring*>;
+static vector<trace_ring*>& free_rings = *new vector<trace_ring*>;    // De threads encerradas
+static unordered_set<string>& thread_names = *new unordered_set<string>;  // Cópias dos nomes de thread
+static thread_local trace_ring* thread_ring = nullptr;
+static thread_local const char* thread_name = nullptr;
+
+/**
+ * Devolve o buffer da thread quando ela termina, para que a próxima thread o reaproveite.
+ */
+struct ring_release {
+    ~ring_release() {
+        if (thread_ring) {
+            lock_guard<mutex> lock(rings_mutex);
+            free_rings.push_back(thread_ring);
+            thread_ring = nullptr;
+        }
+    }
+};
+
+static thread_local ring_release thread_release;
+
+// Ponto de calibração do relógio: leitura simultânea de trace_now() e do steady_clock
+static mutex calibration_mutex;
+static uint64_t calibration_ticks = 0;
+static int64_t calibration_ns = 0;
+
+
+uint64_t trace_steady_ticks() {
+    return static_cast<uint64_t>(
+        chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+
+static int64_t steady_ns() {
+    return static_cast<int64_t>(trace_steady_ticks());
+}
+
+
+/**
+ * Buffer da thread chamadora, criado e registrado no primeiro evento.
+ */
+static trace_ring* ring_get() {
+    trace_ring* ring = thread_ring;
+    if (!ring) {
+        // Garante a construção do objeto que devolve o buffer no fim da thread
+        (void)&thread_release;
+        long tid = static_cast<long>(syscall(SYS_gettid));
+        lock_guard<mutex> lock(rings_mutex);
+        if (!free_rings.empty()) {
+            ring = free_rings.back();
+            free_rings.pop_back();
+            // Os eventos da dona anterior continuam no buffer até serem sobrescritos
+            uint64_t head = ring->head.load(memory_order_relaxed);
+            uint64_t oldest = head > TRACE_RING_EVENTS ? head - TRACE_RING_EVENTS : 0;
+            vector<trace_owner>& previous = ring->previous;
+            previous.push_back({ring->first_event, ring->tid, ring->thread_name.load(memory_order_relaxed)});
+            ring->first_event = head;
+            // Esquece as donas sem eventos ou com todos eles já sobrescritos
+            size_t kept = 0;
+            for (size_t i = 0; i < previous.size(); i++) {
+                uint64_t end = i + 1 < previous.size() ? previous[i + 1].first_event : head;
+                if (end > oldest && end > previous[i].first_event) {
+                    previous[kept++] = previous[i];
+                }
+            }
+            previous.resize(kept);
+        } else {
+            ring = new trace_ring;
+            rings.push_back(ring);
+        }
+        ring->tid = tid;
+        ring->thread_name.store(thread_name, memory_order_relaxed);
+        thread_ring = ring;
+    }
+    return ring;
+}
+
+
+static void record(trace_event_type type, const char* name, uint64_t start, uint64_t end) {
+    trace_ring* ring = ring_get();
+    uint64_t index = ring->head.load(memory_order_relaxed);
+    trace_event& event = ring->events[index % TRACE_RING_EVENTS];
+    event.name.store(name, memory_order_relaxed);
+    event.start.store(start, memory_order_relaxed);
+    event.end.store(end, memory_order_relaxed);
+    event.type.store(type, memory_order_relaxed);
+    // Publica o evento: quem ler head com acquire enxerga os campos completos
+    ring->head.store(index + 1, memory_order_release);
+}
+
+
+void trace_record_complete(const char* name, uint64_t start, uint64_t end) {
+    record(TRACE_EVENT_COMPLETE, name, start, end);
+}
+
+
+void trace_record_instant(const char* name) {
+    uint64_t now = trace_now();
+    record(TRACE_EVENT_INSTANT, name, now, now);
+}
+
+
+void trace_record_counter(const char* name, int64_t value) {
+    record(TRACE_EVENT_COUNTER, name, trace_now(), static_cast<uint64_t>(value));
+}
+
+
+void trace_set_thread_name(const char* name) {
+    // Os buffers sobrevivem às threads: o nome é copiado, uma vez por texto distinto
+    if (name) {
+        lock_guard<mutex> lock(rings_mutex);
+        name = thread_names.insert(name).first->c_str();
+    }
+    // O buffer só é criado no primeiro evento; até lá o nome fica guardado na thread
+    thread_name = name;
+    if (thread_ring) {
+        thread_ring->thread_name.store(name, memory_order_relaxed);
+    }
+}
+
+
+void trace_enable(bool enabled) {
+    if (enabled) {
+        lock_guard<mutex> lock(calibration_mutex);
+        if (calibration_ns == 0) {
+            calibration_ticks = trace_now();
+            calibration_ns = steady_ns();
+        }
+    }
+    trace_active.store(enabled, memory_order_release);
+}
+
+
+void trace_clear() {
+    lock_guard<mutex> lock(rings_mutex);
+    for (trace_ring* ring : rings) {
+        ring->head.store(0, memory_order_relaxed);
+        ring->first_event = 0;
+        ring->previous.clear();
+    }
+}
+
+
+/**
+ * Escreve `text` como string JSON (com as aspas).
+ */
+static void write_json_string(FILE* out, const char* text) {
+    fputc('"', out);
+    for (const char* p = text ? text : ""; *p; p++) {
+        unsigned char c = static_cast<unsigned char>(*p);
+        if (c == '"' || c == '\\') {
+            fputc('\\', out);
+            fputc(c, out);
+        } else if (c < 0x20) {
+            fprintf(out, "\\u%04x", c);
+        } else {
+            fputc(c, out);
+        }
+    }
+    fputc('"', out);
+}
+
+
+bool trace_export_chrome(const char* path) {
+    // Segundo ponto de calibração: com o TSC, a frequência é a razão entre os dois intervalos
+    uint64_t origin_ticks;
+    int64_t origin_ns;
+    {
+        lock_guard<mutex> lock(calibration_mutex);
+        if (calibration_ns == 0) {
+            calibration_ticks = trace_now();
+            calibration_ns = steady_ns();
+        }
+        origin_ticks = calibration_ticks;
+        origin_ns = calibration_ns;
+    }
+    double ns_per_tick = 1.0;
+    if (trace_use_tsc) {
+        // Um intervalo curto demais daria uma frequência imprecisa
+        while (steady_ns() - origin_ns < 10000000) {
+            this_thread::yield();
+        }
+        uint64_t ticks = trace_now();
+        int64_t ns = steady_ns();
+        ns_per_tick = static_cast<double>(ns - origin_ns) / static_cast<double>(ticks - origin_ticks);
+    }
+    auto to_us = [&](uint64_t ticks) {
+        return (static_cast<double>(static_cast<int64_t>(ticks - origin_ticks)) * ns_per_tick) / 1000.0;
+    };
+
+    FILE* out = fopen(path, "w");
+    if (!out) {
+        cerr << "Erro ao criar arquivo de rastreamento: " << path << endl;
+        return false;
+    }
+
+    // Donas de cada buffer (a atual por último) e os eventos gravados até aqui: eventos posteriores
+    // podem ser de uma nova dona, então ficam para a próxima exportação
+    struct ring_snapshot {
+        trace_ring* ring;
+        uint64_t head;
+        vector<trace_owner> owners;
+    };
+    vector<ring_snapshot> snapshot;
+    {
+        lock_guard<mutex> lock(rings_mutex);
+        snapshot.reserve(rings.size());
+        for (trace_ring* ring : rings) {
+            snapshot.push_back({ring, ring->head.load(memory_order_acquire), ring->previous});
+            snapshot.back().owners.push_back(
+                {ring->first_event, ring->tid, ring->thread_name.load(memory_order_relaxed)});
+        }
+    }
+
+    long pid = static_cast<long>(getpid());
+    bool first = true;
+    fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+
+    struct copied_event {
+        const char* name;
+        uint64_t start;
+        uint64_t end;
+        uint32_t type;
+    };
+    vector<copied_event> events;
+
+    for (const ring_snapshot& entry : snapshot) {
+        const trace_ring* ring = entry.ring;
+        for (const trace_owner& owner : entry.owners) {
+            if (owner.thread_name) {
+                fprintf(out, "%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%ld,\"tid\":%ld,\"args\":{\"name\":",
+                        first ? "" : ",\n", pid, owner.tid);
+                write_json_string(out, owner.thread_name);
+                fprintf(out, "}}");
+                first = false;
+            }
+        }
+
+        // Copia os eventos disponíveis e descarta os que a thread sobrescreveu durante a cópia
+        uint64_t head = entry.head;
+        uint64_t begin = head > TRACE_RING_EVENTS ? head - TRACE_RING_EVENTS : 0;
+        events.clear();
+        for (uint64_t i = begin; i < head; i++) {
+            const trace_event& event = ring->events[i % TRACE_RING_EVENTS];
+            events.push_back({event.name.load(memory_order_relaxed), event.start.load(memory_order_relaxed),
+                              event.end.load(memory_order_relaxed), event.type.load(memory_order_relaxed)});
+        }
+        uint64_t head_after = ring->head.load(memory_order_acquire);
+        uint64_t valid_from = head_after > TRACE_RING_EVENTS ? head_after - TRACE_RING_EVENTS : 0;
+        size_t skip = valid_from > begin ? static_cast<size_t>(valid_from - begin) : 0;
+
+        // As donas estão em ordem: avança para a que gravou cada evento
+        size_t owner = 0;
+        for (size_t i = skip; i < events.size(); i++) {
+            const copied_event& event = events[i];
+            while (owner + 1 < entry.owners.size() && entry.owners[owner + 1].first_event <= begin + i) {
+                owner++;
+            }
+            fprintf(out, "%s{\"pid\":%ld,\"tid\":%ld,\"name\":", first ? "" : ",\n", pid,
+                    entry.owners[owner].tid);
+            write_json_string(out, event.name);
+            switch (event.type) {
+                case TRACE_EVENT_COMPLETE:
+                    fprintf(out, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f}", to_us(event.start),
+                            to_us(event.end) - to_us(event.start));
+                    break;
+                case TRACE_EVENT_INSTANT:
+                    fprintf(out, ",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f}", to_us(event.start));
+                    break;
+                default:
+                    fprintf(out, ",\"ph\":\"C\",\"ts\":%.3f,\"args\":{\"value\":%lld}}", to_us(event.start),
+                            static_cast<long long>(event.end));
+                    break;
+            }
+            first = false;
+        }
+    }
+
+    fprintf(out, "\n]}\n");
+    bool ok = fflush(out) == 0;
+    ok = fclose(out) == 0 && ok;
+    if (!ok) {
+        cerr << "Erro ao gravar arquivo de rastreamento: " << path << endl;
+    }
+    return ok;
+}
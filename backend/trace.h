@@ -0,0 +1,121 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/**
+ * Rastreamento de baixo custo dos caminhos quentes, exportado no formato JSON do Chrome/Perfetto
+ * (chrome://tracing ou ui.perfetto.dev).
+ *
+ * Cada thread grava seus eventos em um buffer circular próprio, sem locks nem alocação; quando o buffer
+ * enche, os eventos mais antigos são sobrescritos. Os tempos vêm do TSC (quando invariante) ou do
+ * steady_clock, e são convertidos para microssegundos apenas na exportação.
+ *
+ * Desativado, cada ponto de rastreamento custa uma leitura relaxada de um booleano e um desvio
+ * previsível, então as macros podem ficar compiladas nas builds de produção.
+ */
+
+// Eventos guardados por thread (os mais recentes)
+static const uint32_t TRACE_RING_EVENTS = 1u << 16;
+
+extern std::atomic<bool> trace_active;
+extern bool trace_use_tsc;
+
+uint64_t trace_steady_ticks();
+
+inline bool trace_enabled() {
+    return __builtin_expect(trace_active.load(std::memory_order_relaxed), 0);
+}
+
+/**
+ * Leitura do relógio usado nos eventos (ciclos do TSC ou nanossegundos do steady_clock).
+ */
+inline uint64_t trace_now() {
+#if defined(__x86_64__) || defined(__i386__)
+    if (trace_use_tsc) {
+        return __rdtsc();
+    }
+#endif
+    return trace_steady_ticks();
+}
+
+/**
+ * Liga ou desliga a gravação. Ao ligar, o relógio é calibrado; eventos anteriores são mantidos.
+ */
+void trace_enable(bool enabled);
+
+/**
+ * Descarta todos os eventos gravados até agora.
+ * Não deve haver threads gravando ao mesmo tempo (chamar com a gravação desligada).
+ */
+void trace_clear();
+
+/**
+ * Nome da thread chamadora na exportação (o texto é copiado).
+ */
+void trace_set_thread_name(const char* name);
+
+// Gravação (use as macros abaixo; os nomes devem ser literais ou textos que vivam até a exportação)
+void trace_record_complete(const char* name, uint64_t start, uint64_t end);
+void trace_record_instant(const char* name);
+void trace_record_counter(const char* name, int64_t value);
+
+/**
+ * Exporta os eventos de todas as threads no formato JSON do Chrome/Perfetto.
+ * Pode ser chamada com as threads ainda gravando: eventos sobrescritos durante a cópia são descartados.
+ *
+ * @return true em caso de sucesso
+ */
+bool trace_export_chrome(const char* path);
+
+/**
+ * Mede o escopo em que é declarada e o grava como um evento de duração.
+ */
+class trace_scope {
+public:
+    // O flag é lido uma única vez; start fica 0 se a gravação estava desligada (nenhum relógio retorna 0).
+    // O destrutor testa esse mesmo valor, que o compilador sabe ser 0 no caminho desligado
+    explicit trace_scope(const char* name) : name(name), start(trace_enabled() ? trace_now() : 0) {}
+
+    ~trace_scope() {
+        if (__builtin_expect(start != 0, 0)) {
+            trace_record_complete(name, start, trace_now());
+        }
+    }
+
+    trace_scope(const trace_scope&) = delete;
+    trace_scope& operator=(const trace_scope&) = delete;
+
+private:
+    const char* name;
+    uint64_t start;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+// Evento de duração cobrindo o restante do escopo atual
+#define TRACE_SCOPE(name) trace_scope TRACE_CONCAT(trace_scope_, __LINE__)(name)
+
+// Evento pontual
+#define TRACE_INSTANT(name)              \
+    do {                                 \
+        if (trace_enabled()) {           \
+            trace_record_instant(name);  \
+        }                                \
+    } while (0)
+
+// Valor de um contador (gráfico na linha do tempo)
+#define TRACE_COUNTER(name, value)                \
+    do {                                          \
+        if (trace_enabled()) {                    \
+            trace_record_counter(name, (value));  \
+        }                                         \
+    } while (0)
+
+#endif
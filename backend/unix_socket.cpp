@@ -0,0 +1,89 @@
+#include <iostream>
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "unix_socket.h"
+
+using namespace std;
+
+
+/**
+ * Libera o caminho para o bind: nada a fazer se ele não existe; um socket sem ninguém escutando
+ * (ECONNREFUSED) é removido; um socket que aceita a conexão, ou qualquer outro arquivo, é mantido.
+ *
+ * @return true se o caminho está livre
+ */
+static bool release_stale_socket(const char* path, const sockaddr_un& addr) {
+    struct stat st;
+    if (lstat(path, &st) != 0) {
+        if (errno == ENOENT) {
+            return true;
+        }
+        cerr << "Erro ao verificar " << path << ": " << strerror(errno) << endl;
+        return false;
+    }
+    if (!S_ISSOCK(st.st_mode)) {
+        cerr << "Caminho já existe e não é um socket: " << path << endl;
+        return false;
+    }
+
+    int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (probe < 0) {
+        cerr << "Erro ao criar socket Unix: " << strerror(errno) << endl;
+        return false;
+    }
+    bool connected = connect(probe, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0;
+    int connect_errno = errno;
+    close(probe);
+    if (connected) {
+        cerr << "Outro servidor já escuta em " << path << endl;
+        return false;
+    }
+    // EAGAIN: a fila do outro servidor está cheia, mas ele está vivo
+    if (connect_errno != ECONNREFUSED) {
+        cerr << "Socket em uso ou inacessível: " << path << ": " << strerror(connect_errno) << endl;
+        return false;
+    }
+    if (unlink(path) != 0 && errno != ENOENT) {
+        cerr << "Erro ao remover socket abandonado " << path << ": " << strerror(errno) << endl;
+        return false;
+    }
+    return true;
+}
+
+
+int unix_socket_listen(const char* path, int flags, int backlog) {
+    sockaddr_un addr{};
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        cerr << "Caminho do socket Unix longo demais: " << path << endl;
+        return -1;
+    }
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    if (!release_stale_socket(path, addr)) {
+        return -1;
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | flags, 0);
+    if (fd < 0) {
+        cerr << "Erro ao criar socket Unix: " << strerror(errno) << endl;
+        return -1;
+    }
+    // Se outra instância criou o socket entre a verificação e aqui, o bind falha com EADDRINUSE
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        cerr << "Erro ao escutar em " << path << ": " << strerror(errno) << endl;
+        close(fd);
+        return -1;
+    }
+    if (listen(fd, backlog) != 0) {
+        cerr << "Erro ao escutar em " << path << ": " << strerror(errno) << endl;
+        close(fd);
+        unlink(path);
+        return -1;
+    }
+    return fd;
+}
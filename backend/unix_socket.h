@@ -0,0 +1,17 @@
+#ifndef UNIX_SOCKET_H
+#define UNIX_SOCKET_H
+
+/**
+ * Cria um socket Unix (SOCK_STREAM) escutando em `path`.
+ *
+ * Um socket já existente no caminho só é removido se estiver abandonado (nenhum processo aceita
+ * conexões nele): se outro servidor responde, ou se o caminho não é um socket, a criação é recusada
+ * em vez de tomar o caminho de uma instância viva ou apagar um arquivo qualquer.
+ *
+ * @param flags Flags adicionais de socket(), como SOCK_NONBLOCK (SOCK_CLOEXEC é sempre usado)
+ * @param backlog Tamanho da fila de conexões pendentes (listen)
+ * @return Descritor do socket ou -1 em caso de erro (já informado em cerr)
+ */
+int unix_socket_listen(const char* path, int flags, int backlog);
+
+#endif
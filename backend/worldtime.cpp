@@ -0,0 +1,569 @@
+#include <cstring>
+
+#include "worldtime.h"
+
+// Profundidade máxima de objetos/vetores aninhados em campos desconhecidos
+static const int WORLDTIME_MAX_DEPTH = 32;
+
+/**
+ * Estado da análise: posição atual, limites e o primeiro erro encontrado.
+ */
+struct parse_state {
+    const char* begin;
+    const char* p;
+    const char* end;
+    worldtime_error error;
+};
+
+
+static bool fail(parse_state& state, worldtime_error_code code, const char* at, const char* field) {
+    if (state.error.code == WORLDTIME_OK) {
+        state.error.code = code;
+        state.error.offset = static_cast<size_t>(at - state.begin);
+        state.error.field = field;
+    }
+    return false;
+}
+
+
+static void skip_whitespace(parse_state& state) {
+    while (state.p < state.end && (*state.p == ' ' || *state.p == '\t' || *state.p == '\n' || *state.p == '\r')) {
+        state.p++;
+    }
+}
+
+
+static bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+
+static bool is_hex(char c) {
+    return is_digit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+
+/**
+ * Lê uma string JSON (o cursor está nas aspas de abertura) e devolve o conteúdo sem as aspas.
+ */
+static bool parse_string(parse_state& state, worldtime_text* out, const char* field) {
+    const char* start = ++state.p;
+    bool escaped = false;
+    while (state.p < state.end) {
+        char c = *state.p;
+        if (c == '"') {
+            out->data = start;
+            out->length = static_cast<size_t>(state.p - start);
+            out->escaped = escaped;
+            state.p++;
+            return true;
+        }
+        if (static_cast<unsigned char>(c) < 0x20) {
+            return fail(state, WORLDTIME_ERR_SYNTAX, state.p, field);
+        }
+        if (c == '\\') {
+            escaped = true;
+            if (state.p + 1 >= state.end) {
+                break;
+            }
+            char e = state.p[1];
+            if (e == 'u') {
+                if (state.end - state.p < 6 || !is_hex(state.p[2]) || !is_hex(state.p[3]) || !is_hex(state.p[4]) ||
+                    !is_hex(state.p[5])) {
+                    return fail(state, WORLDTIME_ERR_SYNTAX, state.p, field);
+                }
+                state.p += 6;
+                continue;
+            }
+            if (!strchr("\"\\/bfnrt", e) || e == '\0') {
+                return fail(state, WORLDTIME_ERR_SYNTAX, state.p, field);
+            }
+            state.p += 2;
+            continue;
+        }
+        state.p++;
+    }
+    return fail(state, WORLDTIME_ERR_SYNTAX, state.end, field);
+}
+
+
+/**
+ * Lê um número JSON. Se for inteiro e couber em 64 bits, `*integer` recebe o valor e `*is_integer` fica true.
+ */
+static bool parse_number(parse_state& state, int64_t* integer, bool* is_integer, const char* field) {
+    const char* start = state.p;
+    bool negative = false;
+    if (state.p < state.end && *state.p == '-') {
+        negative = true;
+        state.p++;
+    }
+    if (state.p >= state.end || !is_digit(*state.p)) {
+        return fail(state, WORLDTIME_ERR_SYNTAX, start, field);
+    }
+
+    uint64_t value = 0;
+    bool overflow = false;
+    if (*state.p == '0') {
+        state.p++;
+    } else {
+        while (state.p < state.end && is_digit(*state.p)) {
+            uint64_t digit = static_cast<uint64_t>(*state.p - '0');
+            if (value > (UINT64_MAX - digit) / 10) {
+                overflow = true;
+            }
+            value = value * 10 + digit;
+            state.p++;
+        }
+    }
+
+    bool fractional = false;
+    if (state.p < state.end && *state.p == '.') {
+        fractional = true;
+        state.p++;
+        if (state.p >= state.end || !is_digit(*state.p)) {
+            return fail(state, WORLDTIME_ERR_SYNTAX, state.p, field);
+        }
+        while (state.p < state.end && is_digit(*state.p)) {
+            state.p++;
+        }
+    }
+    if (state.p < state.end && (*state.p == 'e' || *state.p == 'E')) {
+        fractional = true;
+        state.p++;
+        if (state.p < state.end && (*state.p == '+' || *state.p == '-')) {
+            state.p++;
+        }
+        if (state.p >= state.end || !is_digit(*state.p)) {
+            return fail(state, WORLDTIME_ERR_SYNTAX, state.p, field);
+        }
+        while (state.p < state.end && is_digit(*state.p)) {
+            state.p++;
+        }
+    }
+
+    *is_integer = !fractional && !overflow && value <= static_cast<uint64_t>(INT64_MAX);
+    if (*is_integer) {
+        *integer = negative ? -static_cast<int64_t>(value) : static_cast<int64_t>(value);
+    }
+    return true;
+}
+
+
+static bool match_literal(parse_state& state, const char* literal) {
+    size_t length = strlen(literal);
+    if (static_cast<size_t>(state.end - state.p) < length || memcmp(state.p, literal, length) != 0) {
+        return false;
+    }
+    state.p += length;
+    return true;
+}
+
+
+/**
+ * Pula um valor JSON qualquer (usado nos campos desconhecidos), validando a sintaxe.
+ */
+static bool skip_value(parse_state& state, int depth) {
+    if (depth > WORLDTIME_MAX_DEPTH) {
+        return fail(state, WORLDTIME_ERR_SYNTAX, state.p, nullptr);
+    }
+    skip_whitespace(state);
+    if (state.p >= state.end) {
+        return fail(state, WORLDTIME_ERR_SYNTAX, state.p, nullptr);
+    }
+
+    char c = *state.p;
+    if (c == '"') {
+        worldtime_text ignored;
+        return parse_string(state, &ignored, nullptr);
+    }
+    if (c == '-' || is_digit(c)) {
+        int64_t ignored;
+        bool is_integer;
+        return parse_number(state, &ignored, &is_integer, nullptr);
+    }
+    if (match_literal(state, "true") || match_literal(state, "false") || match_literal(state, "null")) {
+        return true;
+    }
+    if (c == '{' || c == '[') {
+        char close = c == '{' ? '}' : ']';
+        state.p++;
+        skip_whitespace(state);
+        if (state.p < state.end && *state.p == close) {
+            state.p++;
+            return true;
+        }
+        for (;;) {
+            if (c == '{') {
+                skip_whitespace(state);
+                worldtime_text key;
+                if (state.p >= state.end || *state.p != '"' || !parse_string(state, &key, nullptr)) {
+                    return fail(state, WORLDTIME_ERR_SYNTAX, state.p, nullptr);
+                }
+                skip_whitespace(state);
+                if (state.p >= state.end || *state.p != ':') {
+                    return fail(state, WORLDTIME_ERR_SYNTAX, state.p, nullptr);
+                }
+                state.p++;
+            }
+            if (!skip_value(state, depth + 1)) {
+                return false;
+            }
+            skip_whitespace(state);
+            if (state.p < state.end && *state.p == ',') {
+                state.p++;
+                continue;
+            }
+            if (state.p < state.end && *state.p == close) {
+                state.p++;
+                return true;
+            }
+            return fail(state, WORLDTIME_ERR_SYNTAX, state.p, nullptr);
+        }
+    }
+    return fail(state, WORLDTIME_ERR_SYNTAX, state.p, nullptr);
+}
+
+
+/**
+ * Lê `count` dígitos decimais a partir de `p`.
+ */
+static bool read_digits(const char* p, int count, int* value) {
+    int result = 0;
+    for (int i = 0; i < count; i++) {
+        if (!is_digit(p[i])) {
+            return false;
+        }
+        result = result * 10 + (p[i] - '0');
+    }
+    *value = result;
+    return true;
+}
+
+
+/**
+ * Valida um deslocamento "+HH:MM"/"-HH:MM" e o converte para segundos.
+ */
+static bool parse_offset(const char* p, size_t length, int32_t* seconds) {
+    int hours, minutes;
+    if (length != 6 || (p[0] != '+' && p[0] != '-') || p[3] != ':' || !read_digits(p + 1, 2, &hours) ||
+        !read_digits(p + 4, 2, &minutes) || hours > 23 || minutes > 59) {
+        return false;
+    }
+    *seconds = (p[0] == '-' ? -1 : 1) * (hours * 3600 + minutes * 60);
+    return true;
+}
+
+
+/**
+ * Valida um instante ISO 8601 "YYYY-MM-DDTHH:MM:SS[.fração](Z|±HH:MM)".
+ * Devolve a fração de segundo em nanossegundos e o deslocamento em segundos.
+ */
+static bool parse_datetime(const worldtime_text& text, int64_t* fraction_ns, int32_t* offset_seconds) {
+    const char* p = text.data;
+    size_t length = text.length;
+    int year, month, day, hour, minute, second;
+    if (length < 20 || !read_digits(p, 4, &year) || p[4] != '-' || !read_digits(p + 5, 2, &month) || p[7] != '-' ||
+        !read_digits(p + 8, 2, &day) || p[10] != 'T' || !read_digits(p + 11, 2, &hour) || p[13] != ':' ||
+        !read_digits(p + 14, 2, &minute) || p[16] != ':' || !read_digits(p + 17, 2, &second)) {
+        return false;
+    }
+    if (month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60) {
+        return false;
+    }
+
+    size_t i = 19;
+    *fraction_ns = 0;
+    if (p[i] == '.') {
+        i++;
+        size_t first = i;
+        int64_t scale = 100000000;
+        while (i < length && is_digit(p[i])) {
+            *fraction_ns += (p[i] - '0') * scale;
+            scale /= 10;
+            i++;
+        }
+        if (i == first) {
+            return false;
+        }
+    }
+
+    if (i + 1 == length && p[i] == 'Z') {
+        *offset_seconds = 0;
+        return true;
+    }
+    return parse_offset(p + i, length - i, offset_seconds);
+}
+
+
+/**
+ * Lê o valor de um campo inteiro e verifica o intervalo.
+ */
+static bool read_integer(parse_state& state, const char* field, int64_t min, int64_t max, int64_t* out) {
+    const char* at = state.p;
+    if (state.p >= state.end || (*state.p != '-' && !is_digit(*state.p))) {
+        return fail(state, WORLDTIME_ERR_TYPE, at, field);
+    }
+    bool is_integer = false;
+    if (!parse_number(state, out, &is_integer, field)) {
+        return false;
+    }
+    if (!is_integer || *out < min || *out > max) {
+        return fail(state, WORLDTIME_ERR_VALUE, at, field);
+    }
+    return true;
+}
+
+
+/**
+ * Lê o valor de um campo de texto; `nullable` aceita null (o texto fica vazio, com data == nullptr).
+ */
+static bool read_text(parse_state& state, const char* field, bool nullable, worldtime_text* out) {
+    if (state.p < state.end && *state.p == '"') {
+        return parse_string(state, out, field);
+    }
+    if (nullable && match_literal(state, "null")) {
+        *out = worldtime_text{nullptr, 0, false};
+        return true;
+    }
+    return fail(state, WORLDTIME_ERR_TYPE, state.p, field);
+}
+
+
+/**
+ * Interpreta o valor de um campo conhecido (o cursor está no início do valor).
+ * Retorna false em erro; campos desconhecidos são pulados.
+ */
+static bool parse_field(parse_state& state, const worldtime_text& key, worldtime_info* info) {
+    const char* at = state.p;
+    int64_t number = 0;
+
+#define WORLDTIME_KEY(name) (key.length == sizeof(name) - 1 && memcmp(key.data, name, sizeof(name) - 1) == 0)
+
+    if (WORLDTIME_KEY("timezone")) {
+        if (!read_text(state, "timezone", false, &info->timezone)) {
+            return false;
+        }
+        if (info->timezone.length == 0) {
+            return fail(state, WORLDTIME_ERR_VALUE, at, "timezone");
+        }
+        info->present |= WORLDTIME_FIELD_TIMEZONE;
+    } else if (WORLDTIME_KEY("datetime")) {
+        if (!read_text(state, "datetime", false, &info->datetime)) {
+            return false;
+        }
+        info->present |= WORLDTIME_FIELD_DATETIME;
+    } else if (WORLDTIME_KEY("utc_datetime")) {
+        if (!read_text(state, "utc_datetime", false, &info->utc_datetime)) {
+            return false;
+        }
+        info->present |= WORLDTIME_FIELD_UTC_DATETIME;
+    } else if (WORLDTIME_KEY("utc_offset")) {
+        if (!read_text(state, "utc_offset", false, &info->utc_offset)) {
+            return false;
+        }
+        if (!parse_offset(info->utc_offset.data, info->utc_offset.length, &info->utc_offset_seconds)) {
+            return fail(state, WORLDTIME_ERR_VALUE, at, "utc_offset");
+        }
+        info->present |= WORLDTIME_FIELD_UTC_OFFSET;
+    } else if (WORLDTIME_KEY("unixtime")) {
+        if (!read_integer(state, "unixtime", 0, INT64_MAX / 1000000000, &number)) {
+            return false;
+        }
+        info->unixtime = number;
+        info->present |= WORLDTIME_FIELD_UNIXTIME;
+    } else if (WORLDTIME_KEY("dst")) {
+        if (match_literal(state, "true")) {
+            info->dst = true;
+        } else if (match_literal(state, "false")) {
+            info->dst = false;
+        } else {
+            return fail(state, WORLDTIME_ERR_TYPE, at, "dst");
+        }
+        info->present |= WORLDTIME_FIELD_DST;
+    } else if (WORLDTIME_KEY("dst_offset")) {
+        if (!read_integer(state, "dst_offset", -86400, 86400, &number)) {
+            return false;
+        }
+        info->dst_offset = static_cast<int32_t>(number);
+        info->present |= WORLDTIME_FIELD_DST_OFFSET;
+    } else if (WORLDTIME_KEY("raw_offset")) {
+        if (!read_integer(state, "raw_offset", -86400, 86400, &number)) {
+            return false;
+        }
+        info->raw_offset = static_cast<int32_t>(number);
+        info->present |= WORLDTIME_FIELD_RAW_OFFSET;
+    } else if (WORLDTIME_KEY("dst_from")) {
+        if (!read_text(state, "dst_from", true, &info->dst_from)) {
+            return false;
+        }
+        info->present |= WORLDTIME_FIELD_DST_FROM;
+    } else if (WORLDTIME_KEY("dst_until")) {
+        if (!read_text(state, "dst_until", true, &info->dst_until)) {
+            return false;
+        }
+        info->present |= WORLDTIME_FIELD_DST_UNTIL;
+    } else if (WORLDTIME_KEY("abbreviation")) {
+        if (!read_text(state, "abbreviation", false, &info->abbreviation)) {
+            return false;
+        }
+        info->present |= WORLDTIME_FIELD_ABBREVIATION;
+    } else if (WORLDTIME_KEY("client_ip")) {
+        if (!read_text(state, "client_ip", false, &info->client_ip)) {
+            return false;
+        }
+        info->present |= WORLDTIME_FIELD_CLIENT_IP;
+    } else if (WORLDTIME_KEY("day_of_week")) {
+        if (!read_integer(state, "day_of_week", 0, 6, &number)) {
+            return false;
+        }
+        info->day_of_week = static_cast<int>(number);
+        info->present |= WORLDTIME_FIELD_DAY_OF_WEEK;
+    } else if (WORLDTIME_KEY("day_of_year")) {
+        if (!read_integer(state, "day_of_year", 1, 366, &number)) {
+            return false;
+        }
+        info->day_of_year = static_cast<int>(number);
+        info->present |= WORLDTIME_FIELD_DAY_OF_YEAR;
+    } else if (WORLDTIME_KEY("week_number")) {
+        if (!read_integer(state, "week_number", 1, 53, &number)) {
+            return false;
+        }
+        info->week_number = static_cast<int>(number);
+        info->present |= WORLDTIME_FIELD_WEEK_NUMBER;
+    } else {
+        return skip_value(state, 1);
+    }
+
+#undef WORLDTIME_KEY
+    return true;
+}
+
+
+/**
+ * Confere formatos e coerência entre campos depois que o objeto inteiro foi lido.
+ */
+static bool validate(parse_state& state, worldtime_info* info) {
+    static const struct {
+        uint32_t bit;
+        const char* name;
+    } required[] = {
+        {WORLDTIME_FIELD_TIMEZONE, "timezone"},
+        {WORLDTIME_FIELD_DATETIME, "datetime"},
+        {WORLDTIME_FIELD_UNIXTIME, "unixtime"},
+        {WORLDTIME_FIELD_UTC_OFFSET, "utc_offset"},
+        {WORLDTIME_FIELD_DST, "dst"},
+    };
+    for (const auto& field : required) {
+        if (!(info->present & field.bit)) {
+            return fail(state, WORLDTIME_ERR_MISSING, state.end, field.name);
+        }
+    }
+
+    int64_t fraction_ns = 0;
+    int32_t datetime_offset = 0;
+    if (!parse_datetime(info->datetime, &fraction_ns, &datetime_offset)) {
+        return fail(state, WORLDTIME_ERR_VALUE, info->datetime.data, "datetime");
+    }
+    if (datetime_offset != info->utc_offset_seconds) {
+        return fail(state, WORLDTIME_ERR_INCONSISTENT, info->datetime.data, "datetime");
+    }
+    if (info->present & WORLDTIME_FIELD_UTC_DATETIME) {
+        int32_t utc_offset = 0;
+        if (!parse_datetime(info->utc_datetime, &fraction_ns, &utc_offset)) {
+            return fail(state, WORLDTIME_ERR_VALUE, info->utc_datetime.data, "utc_datetime");
+        }
+        if (utc_offset != 0) {
+            return fail(state, WORLDTIME_ERR_INCONSISTENT, info->utc_datetime.data, "utc_datetime");
+        }
+    }
+    const uint32_t offsets = WORLDTIME_FIELD_RAW_OFFSET | WORLDTIME_FIELD_DST_OFFSET;
+    if ((info->present & offsets) == offsets && info->raw_offset + info->dst_offset != info->utc_offset_seconds) {
+        return fail(state, WORLDTIME_ERR_INCONSISTENT, state.end, "raw_offset");
+    }
+
+    info->unix_ns = info->unixtime * 1000000000LL + fraction_ns;
+    return true;
+}
+
+
+bool worldtime_parse(const char* json, size_t length, worldtime_info* info, worldtime_error* error) {
+    parse_state state{json, json, json + length, {WORLDTIME_OK, 0, nullptr}};
+    memset(info, 0, sizeof(*info));
+
+    bool ok = false;
+    skip_whitespace(state);
+    if (state.p >= state.end || *state.p != '{') {
+        fail(state, WORLDTIME_ERR_SYNTAX, state.p, nullptr);
+    } else {
+        state.p++;
+        skip_whitespace(state);
+        bool empty = state.p < state.end && *state.p == '}';
+        if (empty) {
+            state.p++;
+        }
+        ok = true;
+        while (!empty) {
+            skip_whitespace(state);
+            worldtime_text key;
+            if (state.p >= state.end || *state.p != '"' || !parse_string(state, &key, nullptr)) {
+                ok = fail(state, WORLDTIME_ERR_SYNTAX, state.p, nullptr);
+                break;
+            }
+            skip_whitespace(state);
+            if (state.p >= state.end || *state.p != ':') {
+                ok = fail(state, WORLDTIME_ERR_SYNTAX, state.p, nullptr);
+                break;
+            }
+            state.p++;
+            skip_whitespace(state);
+            if (!parse_field(state, key, info)) {
+                ok = false;
+                break;
+            }
+            skip_whitespace(state);
+            if (state.p < state.end && *state.p == ',') {
+                state.p++;
+                continue;
+            }
+            if (state.p < state.end && *state.p == '}') {
+                state.p++;
+                break;
+            }
+            ok = fail(state, WORLDTIME_ERR_SYNTAX, state.p, nullptr);
+            break;
+        }
+        if (ok) {
+            skip_whitespace(state);
+            if (state.p != state.end) {
+                ok = fail(state, WORLDTIME_ERR_SYNTAX, state.p, nullptr);
+            }
+        }
+        if (ok) {
+            ok = validate(state, info);
+        }
+    }
+
+    if (error) {
+        *error = state.error;
+    }
+    return ok;
+}
+
+
+const char* worldtime_error_message(worldtime_error_code code) {
+    switch (code) {
+        case WORLDTIME_OK:
+            return "sem erro";
+        case WORLDTIME_ERR_SYNTAX:
+            return "JSON malformado";
+        case WORLDTIME_ERR_TYPE:
+            return "campo com tipo inesperado";
+        case WORLDTIME_ERR_VALUE:
+            return "valor fora do formato esperado";
+        case WORLDTIME_ERR_MISSING:
+            return "campo obrigatório ausente";
+        case WORLDTIME_ERR_INCONSISTENT:
+            return "campos inconsistentes entre si";
+    }
+    return "erro desconhecido";
+}
@@ -0,0 +1,102 @@
+#ifndef WORLDTIME_H
+#define WORLDTIME_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Trecho de texto dentro da resposta original (sem cópia nem '\0' próprio).
+ * Sequências de escape JSON não são decodificadas; `escaped` indica se há alguma.
+ */
+struct worldtime_text {
+    const char* data;
+    size_t length;
+    bool escaped;
+};
+
+// Campos encontrados na resposta (bits de worldtime_info::present)
+enum {
+    WORLDTIME_FIELD_ABBREVIATION = 1u << 0,
+    WORLDTIME_FIELD_CLIENT_IP = 1u << 1,
+    WORLDTIME_FIELD_DATETIME = 1u << 2,
+    WORLDTIME_FIELD_DAY_OF_WEEK = 1u << 3,
+    WORLDTIME_FIELD_DAY_OF_YEAR = 1u << 4,
+    WORLDTIME_FIELD_DST = 1u << 5,
+    WORLDTIME_FIELD_DST_FROM = 1u << 6,
+    WORLDTIME_FIELD_DST_OFFSET = 1u << 7,
+    WORLDTIME_FIELD_DST_UNTIL = 1u << 8,
+    WORLDTIME_FIELD_RAW_OFFSET = 1u << 9,
+    WORLDTIME_FIELD_TIMEZONE = 1u << 10,
+    WORLDTIME_FIELD_UNIXTIME = 1u << 11,
+    WORLDTIME_FIELD_UTC_DATETIME = 1u << 12,
+    WORLDTIME_FIELD_UTC_OFFSET = 1u << 13,
+    WORLDTIME_FIELD_WEEK_NUMBER = 1u << 14,
+};
+
+// Campos sem os quais a resposta é rejeitada
+static const uint32_t WORLDTIME_REQUIRED_FIELDS = WORLDTIME_FIELD_TIMEZONE | WORLDTIME_FIELD_DATETIME |
+                                                  WORLDTIME_FIELD_UNIXTIME | WORLDTIME_FIELD_UTC_OFFSET |
+                                                  WORLDTIME_FIELD_DST;
+
+/**
+ * Resposta da worldtimeapi já interpretada. Os textos apontam para o buffer analisado, que deve
+ * permanecer vivo enquanto eles forem usados. Campos ausentes (ver `present`) ficam zerados;
+ * dst_from/dst_until nulos no JSON ficam com data == nullptr.
+ */
+struct worldtime_info {
+    uint32_t present;
+    worldtime_text abbreviation;
+    worldtime_text client_ip;
+    worldtime_text timezone;
+    worldtime_text datetime;            // Horário local, ISO 8601 com deslocamento
+    worldtime_text utc_datetime;
+    worldtime_text utc_offset;          // Ex.: "-04:00"
+    worldtime_text dst_from;
+    worldtime_text dst_until;
+    int64_t unixtime;                   // Segundos desde a época Unix
+    int64_t unix_ns;                    // unixtime com a fração de segundo de datetime/utc_datetime
+    int32_t utc_offset_seconds;         // utc_offset convertido
+    int32_t raw_offset;                 // Deslocamento padrão do fuso, em segundos
+    int32_t dst_offset;                 // Deslocamento adicional do horário de verão, em segundos
+    bool dst;
+    int day_of_week;                    // 0 (domingo) a 6
+    int day_of_year;                    // 1 a 366
+    int week_number;                    // 1 a 53
+};
+
+enum worldtime_error_code {
+    WORLDTIME_OK = 0,
+    WORLDTIME_ERR_SYNTAX,               // JSON malformado
+    WORLDTIME_ERR_TYPE,                 // Campo conhecido com tipo inesperado
+    WORLDTIME_ERR_VALUE,                // Valor fora do formato ou do intervalo esperado
+    WORLDTIME_ERR_MISSING,              // Campo obrigatório ausente
+    WORLDTIME_ERR_INCONSISTENT,         // Campos que se contradizem (ex.: datetime e utc_offset)
+};
+
+/**
+ * Motivo da rejeição: código, posição do byte no JSON e o campo envolvido (nullptr se não se aplica).
+ */
+struct worldtime_error {
+    worldtime_error_code code;
+    size_t offset;
+    const char* field;
+};
+
+/**
+ * Interpreta uma resposta da worldtimeapi em uma única passada, sem alocação e sem copiar os textos.
+ * Campos desconhecidos são ignorados.
+ *
+ * @param json Resposta (não precisa terminar em '\0')
+ * @param length Tamanho da resposta
+ * @param info Destino
+ * @param error Se não nulo, recebe o motivo da rejeição
+ * @return true se a resposta é válida
+ */
+bool worldtime_parse(const char* json, size_t length, worldtime_info* info, worldtime_error* error);
+
+/**
+ * Descrição legível de um código de erro.
+ */
+const char* worldtime_error_message(worldtime_error_code code);
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+/**
+ * Uma medição: nome do benchmark, nome da métrica, valor e unidade.
+ */
+struct Metric {
+    std::string bench;
+    std::string metric;
+    double value;
+    std::string unit;
+};
+
+/**
+ * Acumula as medições de todos os benchmarks executados e as exporta em JSON,
+ * para que resultados de builds diferentes possam ser comparados com diff.
+ */
+class Reporter {
+public:
+    void record(const std::string& bench, const std::string& metric, double value, const std::string& unit);
+    void write_json(std::ostream& out) const;
+
+private:
+    std::vector<Metric> metrics;
+};
+
+// Assinatura de um caso de benchmark
+using CaseFn = void (*)(Reporter&);
+
+struct Case {
+    const char* name;
+    CaseFn run;
+};
+
+/**
+ * Lista global de casos, preenchida pelos registradores estáticos de cada arquivo bench_*.cpp.
+ */
+std::vector<Case>& registry();
+
+struct Registrar {
+    Registrar(const char* name, CaseFn fn) { registry().push_back({name, fn}); }
+};
+
+/**
+ * Impede que o compilador elimine o cálculo que produziu o valor apontado.
+ */
+inline void do_not_optimize(const void* p) {
+    asm volatile("" : : "g"(p) : "memory");
+}
+
+/**
+ * Executa f `repeats` vezes e retorna o menor tempo, em segundos.
+ * O melhor tempo é o menos afetado por ruído do sistema e torna os resultados reproduzíveis.
+ */
+template <class F>
+double best_seconds(int repeats, F&& f) {
+    double best = 0.0;
+    for (int i = 0; i < repeats; i++) {
+        auto begin = std::chrono::steady_clock::now();
+        f();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+        if (i == 0 || elapsed.count() < best) {
+            best = elapsed.count();
+        }
+    }
+    return best;
+}
+
+}  // namespace bench
+
+// Declara e registra um caso de benchmark. O corpo recebe `reporter` para registrar as métricas.
+#define BENCH_CASE(name)                                                   \
+    static void name(bench::Reporter& reporter);                           \
+    static bench::Registrar name##_registrar(#name, name);                 \
+    static void name(bench::Reporter& reporter)
+
+#endif
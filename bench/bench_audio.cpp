@@ -0,0 +1,193 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench.h"
+#include "audio_mixer.h"
+
+using namespace std;
+
+static const int AUDIO_RATE = 44100;
+static const int AUDIO_BLOCK_FRAMES = 441;      // 10 ms
+static const int AUDIO_BLOCKS = 20000;
+static const int AUDIO_REPEATS = 3;
+// Saída simulada: blocos de 20 ms (o buffer do QtAudioCues) puxados em tempo real, com um bloco já entregue
+static const int AUDIO_OUTPUT_BLOCK_FRAMES = 882;
+static const int64_t AUDIO_OUTPUT_QUEUED_NS = 20000000;
+static const int AUDIO_LATENCY_CUES = 100;
+
+
+/**
+ * WAV de 1 s em 48 kHz mono (formato diferente do mixer, para exercitar a conversão) com um tom.
+ */
+static vector<uint8_t> build_wav() {
+    const uint32_t rate = 48000;
+    const uint32_t frames = rate;
+    vector<uint8_t> wav(44 + frames * 2);
+    auto put32 = [&](size_t at, uint32_t value) { memcpy(&wav[at], &value, 4); };
+    auto put16 = [&](size_t at, uint16_t value) { memcpy(&wav[at], &value, 2); };
+    memcpy(&wav[0], "RIFF", 4);
+    put32(4, static_cast<uint32_t>(wav.size() - 8));
+    memcpy(&wav[8], "WAVEfmt ", 8);
+    put32(16, 16);
+    put16(20, 1);
+    put16(22, 1);
+    put32(24, rate);
+    put32(28, rate * 2);
+    put16(32, 2);
+    put16(34, 16);
+    memcpy(&wav[36], "data", 4);
+    put32(40, frames * 2);
+    for (uint32_t i = 0; i < frames; i++) {
+        // Onda triangular de ~440 Hz
+        int phase = static_cast<int>(i % 109);
+        int16_t sample = static_cast<int16_t>((phase < 55 ? phase : 109 - phase) * 400 - 11000);
+        put16(44 + i * 2, static_cast<uint16_t>(sample));
+    }
+    return wav;
+}
+
+
+/**
+ * Mixer de efeitos sonoros: decodificação/conversão do WAV (feita uma vez no carregamento), custo de um
+ * disparo (o que a thread da interface paga) e custo de gerar um bloco de 10 ms com 1 e com 8 vozes
+ * (o que a thread de áudio paga), comparado com a duração do bloco.
+ */
+BENCH_CASE(audio_cues) {
+    vector<uint8_t> wav = build_wav();
+    audio_clip clip;
+    double decode = bench::best_seconds(AUDIO_REPEATS, [&]() {
+        audio_clip decoded;
+        audio_clip_decode_wav(wav.data(), wav.size(), AUDIO_RATE, 2, &decoded);
+        audio_clip_free(&decoded);
+    });
+    if (!audio_clip_decode_wav(wav.data(), wav.size(), AUDIO_RATE, 2, &clip)) {
+        reporter.record("audio_cues", "decoded", 0.0, "bool");
+        return;
+    }
+    reporter.record("audio_cues/decode_wav", "ms_per_second_of_audio", decode * 1e3, "ms");
+
+    audio_mixer* mixer = audio_mixer_create(AUDIO_RATE, 2, 8);
+    vector<int16_t> block(AUDIO_BLOCK_FRAMES * 2);
+
+    // Disparo: medido em lotes que cabem na fila, esvaziada por um render fora da medição
+    const int triggers = 32;
+    double trigger_total = 0.0;
+    for (int batch = 0; batch < AUDIO_BLOCKS / triggers; batch++) {
+        trigger_total += bench::best_seconds(1, [&]() {
+            for (int i = 0; i < triggers; i++) {
+                audio_mixer_trigger(mixer, &clip, 0.5f);
+            }
+        });
+        audio_mixer_render(mixer, block.data(), AUDIO_BLOCK_FRAMES, 0);
+    }
+    reporter.record("audio_cues/trigger", "ns_per_trigger", trigger_total * 1e9 / (AUDIO_BLOCKS / triggers * triggers),
+                    "ns");
+
+    const int voice_counts[] = {1, 8};
+    for (int voices : voice_counts) {
+        double seconds = bench::best_seconds(AUDIO_REPEATS, [&]() {
+            for (int b = 0; b < AUDIO_BLOCKS; b++) {
+                // Mantém `voices` vozes ativas (o clip dura 100 blocos)
+                if (audio_mixer_active_voices(mixer) < voices) {
+                    for (int v = audio_mixer_active_voices(mixer); v < voices; v++) {
+                        audio_mixer_trigger(mixer, &clip, 0.5f);
+                    }
+                }
+                audio_mixer_render(mixer, block.data(), AUDIO_BLOCK_FRAMES, 0);
+                bench::do_not_optimize(block.data());
+            }
+        });
+        string name = "audio_cues/render_voices_" + to_string(voices);
+        double per_block = seconds / AUDIO_BLOCKS;
+        reporter.record(name, "ns_per_block", per_block * 1e9, "ns");
+        reporter.record(name, "realtime_fraction", per_block / (AUDIO_BLOCK_FRAMES / static_cast<double>(AUDIO_RATE)),
+                        "x");
+        // Esvazia as vozes antes da próxima configuração
+        for (int b = 0; b < 200; b++) {
+            audio_mixer_render(mixer, block.data(), AUDIO_BLOCK_FRAMES, 0);
+        }
+    }
+
+    audio_mixer_destroy(mixer);
+    audio_clip_free(&clip);
+}
+
+
+struct latency_samples {
+    vector<int64_t> trigger_to_render;
+    vector<int64_t> output_delay;
+    atomic<int> count{0};
+};
+
+
+/**
+ * Latência de um disparo com a saída puxando blocos em tempo real, como no QtAudioCues: uma thread
+ * gera um bloco de 20 ms a cada 20 ms, e a thread principal dispara sons em instantes que não coincidem
+ * com os blocos. O callback de latência (que no frontend emite cueLatency) deve chegar uma vez por disparo.
+ */
+BENCH_CASE(audio_cues_latency) {
+    vector<uint8_t> wav = build_wav();
+    audio_clip clip;
+    if (!audio_clip_decode_wav(wav.data(), wav.size(), AUDIO_RATE, 2, &clip)) {
+        reporter.record("audio_cues_latency", "decoded", 0.0, "bool");
+        return;
+    }
+    audio_mixer* mixer = audio_mixer_create(AUDIO_RATE, 2, 8);
+    latency_samples samples;
+    samples.trigger_to_render.resize(AUDIO_LATENCY_CUES);
+    samples.output_delay.resize(AUDIO_LATENCY_CUES);
+    audio_mixer_set_latency_hook(mixer, [](void* user, const audio_cue_latency* latency) {
+        latency_samples* target = static_cast<latency_samples*>(user);
+        int index = target->count.load(memory_order_relaxed);
+        if (index < AUDIO_LATENCY_CUES) {
+            target->trigger_to_render[index] = latency->trigger_to_render_ns;
+            target->output_delay[index] = latency->output_delay_ns;
+            target->count.store(index + 1, memory_order_release);
+        }
+    }, &samples);
+
+    atomic<bool> running{true};
+    thread output([&]() {
+        vector<int16_t> block(AUDIO_OUTPUT_BLOCK_FRAMES * 2);
+        auto period = chrono::nanoseconds(AUDIO_OUTPUT_QUEUED_NS);
+        auto next = chrono::steady_clock::now();
+        while (running.load(memory_order_relaxed)) {
+            audio_mixer_render(mixer, block.data(), AUDIO_OUTPUT_BLOCK_FRAMES, AUDIO_OUTPUT_QUEUED_NS);
+            next += period;
+            this_thread::sleep_until(next);
+        }
+    });
+
+    int triggered = 0;
+    for (int i = 0; i < AUDIO_LATENCY_CUES; i++) {
+        // 37 ms entre disparos: a posição do disparo dentro do bloco varia
+        this_thread::sleep_for(chrono::milliseconds(37));
+        if (audio_mixer_trigger(mixer, &clip, 0.5f)) {
+            triggered++;
+        }
+    }
+    this_thread::sleep_for(chrono::nanoseconds(3 * AUDIO_OUTPUT_QUEUED_NS));
+    running.store(false, memory_order_relaxed);
+    output.join();
+
+    int fired = samples.count.load(memory_order_acquire);
+    reporter.record("audio_cues_latency", "triggers", triggered, "count");
+    reporter.record("audio_cues_latency", "hooks_fired", fired, "count");
+    if (fired > 0) {
+        vector<int64_t> render(samples.trigger_to_render.begin(), samples.trigger_to_render.begin() + fired);
+        sort(render.begin(), render.end());
+        int64_t delay_max = *max_element(samples.output_delay.begin(), samples.output_delay.begin() + fired);
+        reporter.record("audio_cues_latency", "trigger_to_render_p50", render[render.size() / 2] / 1e6, "ms");
+        reporter.record("audio_cues_latency", "trigger_to_render_max", render.back() / 1e6, "ms");
+        reporter.record("audio_cues_latency", "output_delay_max", delay_max / 1e6, "ms");
+    }
+
+    audio_mixer_destroy(mixer);
+    audio_clip_free(&clip);
+}
@@ -0,0 +1,29 @@
+#include <climits>
+#include <string>
+#include <unistd.h>
+
+#include "bench_backend.h"
+#include "backend.h"
+
+using namespace std;
+
+namespace bench {
+
+bool setup_backend_corpus(int num_texts, uint64_t seed) {
+    backend_set_seed(seed);
+    backend_init();
+    backend_configure_corpus(num_texts, 0);
+
+    char exe[PATH_MAX];
+    ssize_t length = readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+    if (length > 0) {
+        string directory(exe, static_cast<size_t>(length));
+        directory.resize(directory.rfind('/') + 1);
+        if (backend_scan_generators(directory.c_str()) > 0) {
+            backend_select_generator("gentexts");
+        }
+    }
+    return get_corpus_count() > 0;
+}
+
+}  // namespace bench
@@ -0,0 +1,19 @@
+#ifndef BENCH_BACKEND_H
+#define BENCH_BACKEND_H
+
+#include <cstdint>
+
+namespace bench {
+
+/**
+ * Prepara o backend com um corpus de tamanho e semente fixos, para resultados reproduzíveis.
+ * O gerador é procurado no diretório do executável (onde o CMake grava libgentexts.so);
+ * se não estiver lá, vale o caminho padrão do backend.
+ *
+ * @return true se o corpus está disponível
+ */
+bool setup_backend_corpus(int num_texts, uint64_t seed);
+
+}  // namespace bench
+
+#endif
@@ -0,0 +1,125 @@
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "bench.h"
+#include "lib_gentexts.h"
+
+using namespace std;
+
+static const int SCALING_TEXTS = 2000000;
+static const int SCALING_REPEATS = 3;
+static const uint64_t SCALING_SEED = 2024;
+
+
+/**
+ * Hash FNV-1a do corpus inteiro, usado para confirmar que o resultado não depende do número de threads.
+ */
+static uint64_t corpus_hash(const text_corpus* corpus) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < corpus->size; i++) {
+        hash = (hash ^ (unsigned char)corpus->arena[i]) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+
+/**
+ * Escalabilidade de generate_corpus_parallel() de 1 até N threads (dobrando a cada passo),
+ * comparada com a geração sequencial de generate_corpus().
+ */
+BENCH_CASE(gentexts_parallel_scaling) {
+    double serial = bench::best_seconds(SCALING_REPEATS, [&]() {
+        text_corpus* corpus = generate_corpus(SCALING_TEXTS);
+        bench::do_not_optimize(corpus);
+        free_corpus(corpus);
+    });
+    reporter.record("gentexts_parallel_scaling/serial", "texts_per_second", SCALING_TEXTS / serial, "texts/s");
+
+    int max_threads = (int)thread::hardware_concurrency();
+    if (max_threads < 1) {
+        max_threads = 1;
+    }
+
+    vector<int> thread_counts;
+    for (int threads = 1; threads < max_threads; threads *= 2) {
+        thread_counts.push_back(threads);
+    }
+    thread_counts.push_back(max_threads);
+
+    uint64_t reference = 0;
+    double single = 0.0;
+    for (int threads : thread_counts) {
+        double seconds = bench::best_seconds(SCALING_REPEATS, [&]() {
+            text_corpus* corpus = generate_corpus_parallel(SCALING_TEXTS, SCALING_SEED, threads);
+            bench::do_not_optimize(corpus);
+            free_corpus(corpus);
+        });
+
+        text_corpus* corpus = generate_corpus_parallel(SCALING_TEXTS, SCALING_SEED, threads);
+        uint64_t hash = corpus_hash(corpus);
+        free_corpus(corpus);
+
+        if (threads == 1) {
+            reference = hash;
+            single = seconds;
+        }
+
+        string name = "gentexts_parallel_scaling/threads_" + to_string(threads);
+        reporter.record(name, "texts_per_second", SCALING_TEXTS / seconds, "texts/s");
+        reporter.record(name, "speedup", single / seconds, "x");
+        reporter.record(name, "deterministic", hash == reference ? 1.0 : 0.0, "bool");
+    }
+}
+
+
+static const int LIST_CALLS = 20000;
+static const int SIZES_REPEATS = 3;
+
+
+/**
+ * Geração em tamanhos diferentes. generate_list_random_texts() não recebe a quantidade (usa o padrão
+ * da biblioteca, poucos textos), então é medida por chamada, incluindo a liberação da lista; os tamanhos
+ * grande e enorme usam generate_corpus(), que é o caminho que ela própria usa por baixo.
+ */
+BENCH_CASE(gentexts_sizes) {
+    long list_texts = 0;
+    double list = bench::best_seconds(SIZES_REPEATS, [&]() {
+        list_texts = 0;
+        for (int call = 0; call < LIST_CALLS; call++) {
+            int count = 0;
+            char** texts = generate_list_random_texts(&count);
+            bench::do_not_optimize(texts);
+            if (texts) {
+                for (int i = 0; i < count; i++) {
+                    free(texts[i]);
+                }
+                free(texts);
+            }
+            list_texts += count;
+        }
+    });
+    reporter.record("gentexts_sizes/list_small", "ns_per_call", list * 1e9 / LIST_CALLS, "ns");
+    reporter.record("gentexts_sizes/list_small", "texts_per_second", list_texts / list, "texts/s");
+
+    const struct {
+        const char* name;
+        int texts;
+    } sizes[] = {
+        {"gentexts_sizes/corpus_small", 1000},
+        {"gentexts_sizes/corpus_large", 100000},
+        {"gentexts_sizes/corpus_huge", 2000000},
+    };
+    for (const auto& size : sizes) {
+        size_t bytes = 0;
+        double seconds = bench::best_seconds(SIZES_REPEATS, [&]() {
+            text_corpus* corpus = generate_corpus(size.texts);
+            bench::do_not_optimize(corpus);
+            bytes = corpus ? corpus->size : 0;
+            free_corpus(corpus);
+        });
+        reporter.record(size.name, "texts_per_second", size.texts / seconds, "texts/s");
+        reporter.record(size.name, "throughput", bytes / seconds / 1e6, "MB/s");
+        reporter.record(size.name, "arena_bytes", static_cast<double>(bytes), "bytes");
+    }
+}
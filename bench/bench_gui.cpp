@@ -0,0 +1,293 @@
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QLabel>
+#include <QScrollBar>
+#include <QtGlobal>
+
+#include "bench.h"
+#include "bench_backend.h"
+#include "backend.h"
+#include "gui.h"
+#include "scheduler.h"
+#include "startup.h"
+#include "stub_http_server.h"
+#include "text_view.h"
+
+using namespace std;
+
+static const int GUI_CORPUS_TEXTS = 100000;
+static const uint64_t GUI_SEED = 2024;
+static const int GUI_UPDATES = 500;
+static const int GUI_STARTUP_TIMEOUT_MS = 10000;
+static const int GUI_LAYOUT_TIMEOUT_MS = 60000;
+static const int GUI_TEXT_REPEATS = 3;
+// Observação das tarefas periódicas: mais de um período do texto (10 s)
+static const int64_t GUI_TICK_WINDOW_NS = 12000000000LL;
+static const int64_t GUI_TEXT_PERIOD_NS = 10000000000LL;
+
+// Resposta no formato da worldtimeapi.org, servida localmente para a janela não depender da rede
+static const char* const GUI_WORLDTIME_BODY =
+    "{\"abbreviation\":\"-04\",\"client_ip\":\"127.0.0.1\",\"datetime\":\"2024-05-01T10:00:00.123456-04:00\","
+    "\"day_of_week\":3,\"day_of_year\":122,\"dst\":false,\"dst_from\":null,\"dst_offset\":0,\"dst_until\":null,"
+    "\"raw_offset\":-14400,\"timezone\":\"America/Manaus\",\"unixtime\":1714572000,"
+    "\"utc_datetime\":\"2024-05-01T14:00:00.123456+00:00\",\"utc_offset\":\"-04:00\",\"week_number\":18}";
+
+
+/**
+ * Caminho completo de troca de texto da interface, sem servidor gráfico (QT_QPA_PLATFORM=offscreen):
+ * tempo de cada fase da inicialização (primeiro quadro, corpus, busca do horário no servidor local,
+ * imagem e som), desde a criação da janela, e latência de
+ * MainWindow::updateText() seguida do repaint síncrono da janela, como a cada tick do timer.
+ */
+BENCH_CASE(gui_update_text) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    static int argc = 1;
+    static char name[] = "bench_gui";
+    static char* argv[] = {name, nullptr};
+    QApplication app(argc, argv);
+
+    bench::StubHttpServer server([]() { return string(GUI_WORLDTIME_BODY); });
+    if (!server.start()) {
+        reporter.record("gui_update_text", "server_started", 0.0, "bool");
+        return;
+    }
+    backend_configure_worldtime_url(server.url("/api/timezone/America/Manaus").c_str());
+    if (!bench::setup_backend_corpus(GUI_CORPUS_TEXTS, GUI_SEED)) {
+        reporter.record("gui_update_text", "corpus_available", 0.0, "bool");
+        backend_cleanup();
+        return;
+    }
+
+    {
+        QElapsedTimer startup;
+        startup.start();
+        StartupOrchestrator::markProcessStart();
+        MainWindow window;
+        window.resize(550, 350);
+        window.show();
+        // A janela aparece de imediato; as tarefas da inicialização terminam em paralelo
+        while (!window.startup()->isFinished() && startup.elapsed() < GUI_STARTUP_TIMEOUT_MS) {
+            app.processEvents(QEventLoop::AllEvents, 10);
+        }
+        if (!window.startup()->isFinished()) {
+            reporter.record("gui_update_text", "startup_finished", 0.0, "bool");
+        } else {
+            for (const StartupOrchestrator::Phase& phase : window.startup()->phases()) {
+                reporter.record("gui_update_text/startup", string(phase.name) + "_end", phase.endNs / 1e6, "ms");
+            }
+            reporter.record("gui_update_text/startup", "all_tasks", startup.nsecsElapsed() / 1e6, "ms");
+
+            vector<double> latencies;
+            latencies.reserve(GUI_UPDATES);
+            for (int i = 0; i < GUI_UPDATES; i++) {
+                auto start = chrono::steady_clock::now();
+                window.updateText();
+                window.repaint();
+                chrono::duration<double, micro> elapsed = chrono::steady_clock::now() - start;
+                latencies.push_back(elapsed.count());
+                // Entrega os eventos pendentes entre as trocas, como o laço de eventos faria
+                app.processEvents();
+            }
+            sort(latencies.begin(), latencies.end());
+            reporter.record("gui_update_text/update", "latency_p50", latencies[latencies.size() / 2], "us");
+            reporter.record("gui_update_text/update", "latency_p99", latencies[latencies.size() * 99 / 100], "us");
+            reporter.record("gui_update_text/update", "latency_max", latencies.back(), "us");
+        }
+    }
+
+    backend_cleanup();
+    server.stop();
+}
+
+
+/**
+ * Tarefas periódicas da janela no laço de eventos, sem chamadas diretas: o relógio deve mudar a cada
+ * segundo e o texto a cada 10 s, nos múltiplos contados do início do backend. Informa quantas vezes cada
+ * um disparou em GUI_TICK_WINDOW_NS e o maior atraso observado em relação ao prazo.
+ */
+BENCH_CASE(gui_scheduler_ticks) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    static int argc = 1;
+    static char name[] = "bench_gui";
+    static char* argv[] = {name, nullptr};
+    QApplication app(argc, argv);
+
+    bench::StubHttpServer server([]() { return string(GUI_WORLDTIME_BODY); });
+    if (!server.start()) {
+        reporter.record("gui_scheduler_ticks", "server_started", 0.0, "bool");
+        return;
+    }
+    backend_configure_worldtime_url(server.url("/api/timezone/America/Manaus").c_str());
+    if (!bench::setup_backend_corpus(GUI_CORPUS_TEXTS, GUI_SEED)) {
+        reporter.record("gui_scheduler_ticks", "corpus_available", 0.0, "bool");
+        backend_cleanup();
+        return;
+    }
+
+    {
+        MainWindow window;
+        window.resize(550, 350);
+        window.show();
+        QElapsedTimer startup;
+        startup.start();
+        while (!window.startup()->isFinished() && startup.elapsed() < GUI_STARTUP_TIMEOUT_MS) {
+            app.processEvents(QEventLoop::AllEvents, 10);
+        }
+        const QLabel* clock = window.findChild<QLabel*>("elapsedLabel");
+        const TextView* view = window.findChild<TextView*>();
+        if (!window.startup()->isFinished() || !clock || !view) {
+            reporter.record("gui_scheduler_ticks", "startup_finished", 0.0, "bool");
+        } else {
+            // Mesma origem dos prazos da janela
+            int64_t origin = monotonic_now_ns() - get_elapsed_ns();
+            QString clockText = clock->text();
+            QString text = view->text();
+            int clockTicks = 0;
+            int textTicks = 0;
+            double clockLateMax = 0;
+            double textLateMax = 0;
+            int64_t end = monotonic_now_ns() + GUI_TICK_WINDOW_NS;
+            while (monotonic_now_ns() < end) {
+                // O relógio arma um timer por segundo: a espera sempre termina
+                app.processEvents(QEventLoop::AllEvents | QEventLoop::WaitForMoreEvents);
+                int64_t now = monotonic_now_ns();
+                // A última espera pode terminar até um segundo depois da janela: esse disparo não conta
+                if (now >= end) {
+                    break;
+                }
+                if (clock->text() != clockText) {
+                    clockText = clock->text();
+                    clockTicks++;
+                    // "Tempo decorrido: Ns": o prazo é o segundo N contado da origem
+                    int64_t seconds = clockText.section(' ', -1).chopped(1).toLongLong();
+                    clockLateMax = max(clockLateMax, (now - origin - seconds * 1000000000LL) / 1e6);
+                }
+                if (view->text() != text) {
+                    text = view->text();
+                    textTicks++;
+                    textLateMax = max(textLateMax, ((now - origin) % GUI_TEXT_PERIOD_NS) / 1e6);
+                }
+            }
+            reporter.record("gui_scheduler_ticks/clock", "ticks", clockTicks, "count");
+            reporter.record("gui_scheduler_ticks/clock", "late_max", clockLateMax, "ms");
+            reporter.record("gui_scheduler_ticks/text", "ticks", textTicks, "count");
+            reporter.record("gui_scheduler_ticks/text", "late_max", textLateMax, "ms");
+        }
+    }
+
+    backend_cleanup();
+    server.stop();
+}
+
+
+/**
+ * Texto de um único parágrafo (como os dos geradores) com `bytes` caracteres, em palavras de tamanhos variados.
+ */
+static QString make_long_text(int bytes) {
+    static const char* const words[] = {"lorem", "ipsum", "dolor", "sit", "amet", "consectetur", "adipiscing",
+                                        "elit", "sed", "do", "eiusmod", "tempor", "incididunt", "ut", "labore"};
+    QString text;
+    text.reserve(bytes + 16);
+    for (int i = 0; text.size() < bytes; i++) {
+        text += QLatin1String(words[(i * 7) % 15]);
+        text += QLatin1Char(' ');
+    }
+    text.truncate(bytes);
+    return text;
+}
+
+
+/**
+ * Troca de um texto longo no QLabel com quebra de linha (o widget usado antes) e na TextView: custo na
+ * thread da interface (setText seguido do repaint) e, na TextView, tempo até o layout feito em segundo
+ * plano ficar pronto, no texto novo e após um redimensionamento (largura nova e de volta a uma já usada).
+ */
+BENCH_CASE(gui_text_view) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    static int argc = 1;
+    static char name[] = "bench_gui";
+    static char* argv[] = {name, nullptr};
+    QApplication app(argc, argv);
+
+    auto wait_layout = [&app](TextView& view) {
+        QElapsedTimer timer;
+        timer.start();
+        while (!view.isLayoutReady() && timer.elapsed() < GUI_LAYOUT_TIMEOUT_MS) {
+            app.processEvents(QEventLoop::AllEvents, 1);
+        }
+        return timer.nsecsElapsed() / 1e6;
+    };
+
+    for (int bytes : {1 << 10, 64 << 10, 1 << 20}) {
+        string size = "gui_text_view/" + to_string(bytes / 1024) + "KiB";
+        QString text = make_long_text(bytes);
+
+        {
+            QLabel label;
+            label.setWordWrap(true);
+            label.resize(500, 300);
+            label.show();
+            double best = 1e300;
+            for (int i = 0; i < GUI_TEXT_REPEATS; i++) {
+                label.setText(QString());
+                label.repaint();
+                QElapsedTimer timer;
+                timer.start();
+                label.setText(text);
+                label.repaint();
+                best = min(best, timer.nsecsElapsed() / 1e3);
+            }
+            reporter.record(size + "/label", "set_and_paint", best, "us");
+        }
+
+        TextView view;
+        view.resize(500, 300);
+        view.show();
+        wait_layout(view);
+        double best_gui = 1e300;
+        double best_layout = 1e300;
+        for (int i = 0; i < GUI_TEXT_REPEATS; i++) {
+            // Texto diferente a cada repetição: nenhum layout guardado é aproveitado
+            QString variant = text;
+            variant[0] = QChar('a' + i);
+            QElapsedTimer timer;
+            timer.start();
+            view.setText(variant);
+            view.repaint();
+            best_gui = min(best_gui, timer.nsecsElapsed() / 1e3);
+            best_layout = min(best_layout, wait_layout(view));
+        }
+        reporter.record(size + "/text_view", "set_and_paint", best_gui, "us");
+        reporter.record(size + "/text_view", "layout_ready", best_layout, "ms");
+        if (!view.isLayoutReady()) {
+            reporter.record(size + "/text_view", "layout_finished", 0.0, "bool");
+            continue;
+        }
+
+        // Rolagem até o fim: só as linhas visíveis são desenhadas
+        QElapsedTimer timer;
+        timer.start();
+        view.verticalScrollBar()->setValue(view.verticalScrollBar()->maximum());
+        view.repaint();
+        reporter.record(size + "/text_view", "scroll_end_and_paint", timer.nsecsElapsed() / 1e3, "us");
+
+        view.resize(420, 300);
+        reporter.record(size + "/text_view", "resize_new_width_ready", wait_layout(view), "ms");
+        timer.restart();
+        view.resize(500, 300);
+        view.repaint();
+        reporter.record(size + "/text_view", "resize_cached_width_and_paint", timer.nsecsElapsed() / 1e3, "us");
+    }
+}
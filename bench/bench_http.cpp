@@ -0,0 +1,204 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+#include <curl/curl.h>
+
+#include "bench.h"
+#include "backend.h"
+#include "fetch_engine.h"
+#include "http_client.h"
+#include "stub_http_server.h"
+
+using namespace std;
+
+static const int HTTP_REQUESTS = 2000;
+static const int HTTP_THREADS = 4;
+static const int HTTP_ASYNC_BATCH = 16;
+
+// Resposta no formato da worldtimeapi.org, com tamanho realista
+static const char* const WORLDTIME_BODY =
+    "{\"abbreviation\":\"-04\",\"client_ip\":\"127.0.0.1\",\"datetime\":\"2024-05-01T10:00:00.123456-04:00\","
+    "\"day_of_week\":3,\"day_of_year\":122,\"dst\":false,\"dst_from\":null,\"dst_offset\":0,\"dst_until\":null,"
+    "\"raw_offset\":-14400,\"timezone\":\"America/Manaus\",\"unixtime\":1714572000,"
+    "\"utc_datetime\":\"2024-05-01T14:00:00.123456+00:00\",\"utc_offset\":\"-04:00\",\"week_number\":18}";
+
+
+/**
+ * Requisição sem reutilização, como no cliente antigo: um handle novo (e uma conexão nova) por chamada.
+ */
+static bool fresh_handle_get(const string& url, http_buffer* response) {
+    CURL* curl = curl_easy_init();
+    if (!curl) {
+        return false;
+    }
+    http_buffer_clear(response);
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, +[](void* data, size_t size, size_t nmemb, void* user) -> size_t {
+        return http_buffer_append(static_cast<http_buffer*>(user), static_cast<const char*>(data), size * nmemb)
+                   ? size * nmemb
+                   : 0;
+    });
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, response);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    CURLcode res = curl_easy_perform(curl);
+    curl_easy_cleanup(curl);
+    return res == CURLE_OK;
+}
+
+
+/**
+ * Executa `requests` requisições em cada uma de `threads` threads e registra a vazão total e as latências
+ * p50/p99 (de todas as requisições).
+ */
+template <class F>
+static void measure_requests(bench::Reporter& reporter, const string& name, int threads, int requests, F&& get) {
+    vector<vector<double>> latencies(threads);
+    int failures = 0;
+
+    auto begin = chrono::steady_clock::now();
+    vector<thread> workers;
+    vector<int> worker_failures(threads, 0);
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            http_buffer response;
+            latencies[t].reserve(requests);
+            for (int i = 0; i < requests; i++) {
+                auto start = chrono::steady_clock::now();
+                if (!get(&response)) {
+                    worker_failures[t]++;
+                }
+                chrono::duration<double, micro> elapsed = chrono::steady_clock::now() - start;
+                latencies[t].push_back(elapsed.count());
+            }
+            http_buffer_free(&response);
+        });
+    }
+    for (thread& worker : workers) {
+        worker.join();
+    }
+    chrono::duration<double> total = chrono::steady_clock::now() - begin;
+
+    vector<double> all;
+    for (int t = 0; t < threads; t++) {
+        all.insert(all.end(), latencies[t].begin(), latencies[t].end());
+        failures += worker_failures[t];
+    }
+    sort(all.begin(), all.end());
+
+    reporter.record(name, "requests_per_second", all.size() / total.count(), "req/s");
+    reporter.record(name, "latency_p50", all[all.size() / 2], "us");
+    reporter.record(name, "latency_p99", all[all.size() * 99 / 100], "us");
+    reporter.record(name, "failures", failures, "count");
+}
+
+
+/**
+ * Cliente HTTP contra um servidor local: handle novo por requisição (comportamento antigo) versus
+ * o cliente com handles por thread, keep-alive e cache compartilhado, em uma e em várias threads.
+ */
+BENCH_CASE(http_client) {
+    bench::StubHttpServer server([]() { return string(WORLDTIME_BODY); });
+    if (!server.start()) {
+        reporter.record("http_client", "server_started", 0.0, "bool");
+        return;
+    }
+    const string url = server.url("/api/timezone/America/Manaus");
+
+    measure_requests(reporter, "http_client/fresh_handle", 1, HTTP_REQUESTS, [&](http_buffer* response) {
+        return fresh_handle_get(url, response);
+    });
+
+    uint64_t connections_before = server.connections();
+    measure_requests(reporter, "http_client/pooled", 1, HTTP_REQUESTS, [&](http_buffer* response) {
+        return http_get(url.c_str(), response);
+    });
+    reporter.record("http_client/pooled", "connections", server.connections() - connections_before, "count");
+
+    measure_requests(reporter, "http_client/pooled_threads_" + to_string(HTTP_THREADS), HTTP_THREADS, HTTP_REQUESTS,
+                     [&](http_buffer* response) { return http_get(url.c_str(), response); });
+
+    http_client_cleanup();
+    server.stop();
+}
+
+
+/**
+ * get_worldtime_json() de ponta a ponta (requisição, cópia da resposta e liberação pelo chamador)
+ * com a URL do backend apontada para o servidor local, em uma e em várias threads.
+ */
+BENCH_CASE(worldtime_fetch) {
+    bench::StubHttpServer server([]() { return string(WORLDTIME_BODY); });
+    if (!server.start()) {
+        reporter.record("worldtime_fetch", "server_started", 0.0, "bool");
+        return;
+    }
+    const string url = server.url("/api/timezone/America/Manaus");
+    backend_configure_worldtime_url(url.c_str());
+
+    auto fetch = [](http_buffer*) {
+        char* json = get_worldtime_json();
+        bool ok = json && json[0] != '\0';
+        free(json);
+        return ok;
+    };
+    measure_requests(reporter, "worldtime_fetch/threads_1", 1, HTTP_REQUESTS, fetch);
+    measure_requests(reporter, "worldtime_fetch/threads_" + to_string(HTTP_THREADS), HTTP_THREADS, HTTP_REQUESTS,
+                     fetch);
+
+    http_client_cleanup();
+    server.stop();
+}
+
+
+/**
+ * Motor assíncrono (curl_multi) com o laço epoll: `HTTP_ASYNC_BATCH` requisições simultâneas por rodada,
+ * todas em uma única thread. As conexões abertas na primeira rodada são reutilizadas nas seguintes.
+ */
+BENCH_CASE(http_async) {
+    bench::StubHttpServer server([]() { return string(WORLDTIME_BODY); });
+    if (!server.start()) {
+        reporter.record("http_async", "server_started", 0.0, "bool");
+        return;
+    }
+    const string url = server.url("/api/timezone/America/Manaus");
+
+    fetch_epoll_loop* loop = fetch_epoll_create();
+    if (!loop) {
+        reporter.record("http_async", "loop_created", 0.0, "bool");
+        return;
+    }
+
+    int completed = 0;
+    int failures = 0;
+    vector<double> latencies;
+    latencies.reserve(HTTP_REQUESTS);
+    auto begin = chrono::steady_clock::now();
+    for (int round = 0; round < HTTP_REQUESTS / HTTP_ASYNC_BATCH; round++) {
+        for (int i = 0; i < HTTP_ASYNC_BATCH; i++) {
+            auto start = chrono::steady_clock::now();
+            fetch_engine_get(fetch_epoll_engine(loop), url.c_str(), [&, start](const fetch_result& result) {
+                chrono::duration<double, micro> elapsed = chrono::steady_clock::now() - start;
+                latencies.push_back(elapsed.count());
+                completed++;
+                if (!result.ok || result.status != 200) {
+                    failures++;
+                }
+            });
+        }
+        fetch_epoll_run(loop);
+    }
+    chrono::duration<double> total = chrono::steady_clock::now() - begin;
+    fetch_epoll_destroy(loop);
+    server.stop();
+
+    sort(latencies.begin(), latencies.end());
+    string name = "http_async/batch_" + to_string(HTTP_ASYNC_BATCH);
+    reporter.record(name, "requests_per_second", completed / total.count(), "req/s");
+    reporter.record(name, "latency_p50", latencies[latencies.size() / 2], "us");
+    reporter.record(name, "latency_p99", latencies[latencies.size() * 99 / 100], "us");
+    reporter.record(name, "failures", failures + (HTTP_REQUESTS - completed), "count");
+    reporter.record(name, "connections", server.connections(), "count");
+}
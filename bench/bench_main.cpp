@@ -0,0 +1,75 @@
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "bench.h"
+
+using namespace std;
+
+namespace bench {
+
+vector<Case>& registry() {
+    static vector<Case> cases;
+    return cases;
+}
+
+void Reporter::record(const string& bench, const string& metric, double value, const string& unit) {
+    metrics.push_back({bench, metric, value, unit});
+    cerr << "[bench] " << bench << " " << metric << " = " << value << " " << unit << endl;
+}
+
+void Reporter::write_json(ostream& out) const {
+    out << "{\n  \"results\": [\n";
+    for (size_t i = 0; i < metrics.size(); i++) {
+        const Metric& m = metrics[i];
+        out << "    {\"bench\": \"" << m.bench << "\", \"metric\": \"" << m.metric
+            << "\", \"value\": " << m.value << ", \"unit\": \"" << m.unit << "\"}"
+            << (i + 1 < metrics.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+}  // namespace bench
+
+
+/**
+ * Executa os benchmarks registrados e escreve os resultados em JSON.
+ *
+ * Uso: bench [--filter <trecho do nome>] [--out <arquivo.json>]
+ * Sem --out, o JSON é escrito na saída padrão (o progresso vai para a saída de erro).
+ */
+int main(int argc, char* argv[]) {
+    const char* filter = nullptr;
+    const char* out_path = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            out_path = argv[++i];
+        } else {
+            cerr << "Uso: " << argv[0] << " [--filter <nome>] [--out <arquivo.json>]" << endl;
+            return 1;
+        }
+    }
+
+    bench::Reporter reporter;
+    for (const bench::Case& c : bench::registry()) {
+        if (filter && !strstr(c.name, filter)) {
+            continue;
+        }
+        c.run(reporter);
+    }
+
+    if (out_path) {
+        ofstream out(out_path);
+        if (!out) {
+            cerr << "Erro ao abrir " << out_path << endl;
+            return 1;
+        }
+        reporter.write_json(out);
+    } else {
+        reporter.write_json(cout);
+    }
+    return 0;
+}
@@ -0,0 +1,88 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench.h"
+#include "metrics.h"
+
+using namespace std;
+
+static const int METRICS_OPS = 10000000;
+static const int METRICS_REPEATS = 5;
+
+// Contador compartilhado do caso de referência, em uma linha de cache própria
+struct alignas(64) shared_counter {
+    atomic<uint64_t> value{0};
+};
+
+
+/**
+ * Executa `body(iterations)` em `threads` threads ao mesmo tempo e devolve o melhor tempo entre as repetições.
+ */
+template <typename Body>
+static double run_threads(int threads, Body body) {
+    return bench::best_seconds(METRICS_REPEATS, [&]() {
+        vector<thread> workers;
+        for (int t = 0; t < threads; t++) {
+            workers.emplace_back([&]() { body(METRICS_OPS); });
+        }
+        for (thread& worker : workers) {
+            worker.join();
+        }
+    });
+}
+
+
+/**
+ * Custo de gravação das métricas (metrics.h) em uma e em várias threads: contador no bloco da thread,
+ * comparado a um fetch_add em um contador compartilhado por todas (a linha de cache disputada que o
+ * bloco por thread evita), e registro em histograma. Também mede a exportação no formato do Prometheus.
+ */
+BENCH_CASE(metrics_record) {
+    metric_counter counter = metrics_counter("bench_metrics_ops_total", "Operações do benchmark de métricas");
+    metric_histogram histogram = metrics_histogram("bench_metrics_values", "Valores do benchmark de métricas", 1e-9);
+    shared_counter shared;
+
+    int max_threads = max(4, static_cast<int>(thread::hardware_concurrency()));
+    for (int threads : {1, max_threads}) {
+        string suffix = "/threads_" + to_string(threads);
+        double total = static_cast<double>(threads) * METRICS_OPS;
+
+        uint64_t before = metrics_counter_value(counter);
+        double local = run_threads(threads, [counter](int iterations) {
+            for (int i = 0; i < iterations; i++) {
+                metrics_add(counter);
+            }
+        });
+        uint64_t counted = metrics_counter_value(counter) - before;
+        reporter.record("metrics_record/counter" + suffix, "ns_per_op", local * 1e9 / total, "ns");
+        reporter.record("metrics_record/counter" + suffix, "count_exact",
+                        counted == static_cast<uint64_t>(total) * METRICS_REPEATS ? 1 : 0, "bool");
+
+        double contended = run_threads(threads, [&shared](int iterations) {
+            for (int i = 0; i < iterations; i++) {
+                shared.value.fetch_add(1, memory_order_relaxed);
+            }
+        });
+        reporter.record("metrics_record/shared_atomic" + suffix, "ns_per_op", contended * 1e9 / total, "ns");
+
+        double observed = run_threads(threads, [histogram](int iterations) {
+            // Valores espalhados por vários intervalos, como latências reais
+            uint64_t value = 1000;
+            for (int i = 0; i < iterations; i++) {
+                metrics_observe(histogram, value);
+                value = value * 6364136223846793005ull + 1442695040888963407ull;
+                value = (value >> 40) + 100;
+            }
+        });
+        reporter.record("metrics_record/histogram" + suffix, "ns_per_op", observed * 1e9 / total, "ns");
+    }
+
+    string text;
+    double export_seconds = bench::best_seconds(METRICS_REPEATS, [&]() { text = metrics_export_prometheus(); });
+    reporter.record("metrics_record/export", "us", export_seconds * 1e6, "us");
+    reporter.record("metrics_record/export", "bytes", static_cast<double>(text.size()), "bytes");
+}
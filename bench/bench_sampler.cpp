@@ -0,0 +1,174 @@
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench.h"
+#include "bench_backend.h"
+#include "backend.h"
+#include "sampler.h"
+#include "lib_gentexts.h"
+
+using namespace std;
+
+static const int SAMPLER_CORPUS_TEXTS = 200000;
+static const int SAMPLER_DRAWS = 1000000;
+static const int SAMPLER_REPEATS = 3;
+static const uint64_t SAMPLER_SEED = 2024;
+static const int SAMPLER_LARGE_TEXTS = 2000000;
+static const size_t SAMPLER_WINDOW = 1000;
+
+
+/**
+ * Executa `draws` sorteios em cada uma de `threads` threads e retorna o tempo total (melhor de N).
+ */
+template <class F>
+static double run_draws(int threads, int draws, F&& draw) {
+    return bench::best_seconds(SAMPLER_REPEATS, [&]() {
+        vector<thread> workers;
+        for (int t = 0; t < threads; t++) {
+            workers.emplace_back([&]() {
+                for (int i = 0; i < draws; i++) {
+                    draw();
+                }
+            });
+        }
+        for (thread& worker : workers) {
+            worker.join();
+        }
+    });
+}
+
+
+/**
+ * Vazão dos sorteios do backend em uma e em várias threads (dobrando até o número de processadores,
+ * com no mínimo 4): cópia alocada (get_random_text), cópia para buffer do chamador (get_random_text_into)
+ * e visão sem cópia dentro de uma seção de leitura (get_random_text_view).
+ */
+BENCH_CASE(random_text) {
+    if (!bench::setup_backend_corpus(SAMPLER_CORPUS_TEXTS, SAMPLER_SEED)) {
+        reporter.record("random_text", "corpus_available", 0, "bool");
+        backend_cleanup();
+        return;
+    }
+    reporter.record("random_text", "corpus_texts", static_cast<double>(get_corpus_count()), "count");
+
+    int max_threads = max(4, static_cast<int>(thread::hardware_concurrency()));
+    vector<int> thread_counts;
+    for (int threads = 1; threads < max_threads; threads *= 2) {
+        thread_counts.push_back(threads);
+    }
+    thread_counts.push_back(max_threads);
+
+    for (int threads : thread_counts) {
+        string suffix = "/threads_" + to_string(threads);
+        double total = static_cast<double>(threads) * SAMPLER_DRAWS;
+
+        double copy = run_draws(threads, SAMPLER_DRAWS, []() {
+            char* text = get_random_text();
+            bench::do_not_optimize(text);
+            free(text);
+        });
+        reporter.record("random_text/copy" + suffix, "draws_per_second", total / copy, "draws/s");
+        reporter.record("random_text/copy" + suffix, "ns_per_draw", copy * 1e9 / total, "ns");
+
+        double into = run_draws(threads, SAMPLER_DRAWS, []() {
+            char buffer[GENTEXTS_MAX_TEXT_BYTES + 1];
+            size_t length = get_random_text_into(buffer, sizeof(buffer));
+            bench::do_not_optimize(buffer);
+            bench::do_not_optimize(&length);
+        });
+        reporter.record("random_text/into" + suffix, "draws_per_second", total / into, "draws/s");
+        reporter.record("random_text/into" + suffix, "ns_per_draw", into * 1e9 / total, "ns");
+
+        double view = run_draws(threads, SAMPLER_DRAWS, []() {
+            corpus_read_guard guard;
+            text_view text;
+            get_random_text_view(&text);
+            bench::do_not_optimize(text.data);
+        });
+        reporter.record("random_text/view" + suffix, "draws_per_second", total / view, "draws/s");
+        reporter.record("random_text/view" + suffix, "ns_per_draw", view * 1e9 / total, "ns");
+    }
+
+    backend_cleanup();
+}
+
+
+/**
+ * Modos do amostrador (sampler.h) sobre um corpus com milhões de textos: tempo de montagem do estado
+ * (primeiro sorteio) e custo por sorteio de índice em uma thread e com um amostrador por thread.
+ * O uniforme serve de referência para os demais.
+ */
+BENCH_CASE(sampler_modes) {
+    if (!bench::setup_backend_corpus(SAMPLER_LARGE_TEXTS, SAMPLER_SEED)) {
+        reporter.record("sampler_modes", "corpus_available", 0, "bool");
+        backend_cleanup();
+        return;
+    }
+    reporter.record("sampler_modes", "corpus_texts", static_cast<double>(get_corpus_count()), "count");
+
+    struct mode_case {
+        const char* name;
+        sampler_config config;
+    };
+    vector<mode_case> modes(4);
+    modes[0].name = "uniform";
+    modes[1].name = "weighted";
+    modes[1].config.mode = SAMPLER_WEIGHTED;
+    // Textos mais longos saem mais
+    modes[1].config.weight = [](uint32_t, text_view text) { return static_cast<double>(text.length); };
+    modes[2].name = "shuffle_bag";
+    modes[2].config.mode = SAMPLER_SHUFFLE_BAG;
+    modes[3].name = "no_repeat";
+    modes[3].config.mode = SAMPLER_NO_REPEAT;
+    modes[3].config.window = SAMPLER_WINDOW;
+
+    int max_threads = max(4, static_cast<int>(thread::hardware_concurrency()));
+    for (mode_case& mode : modes) {
+        string name = string("sampler_modes/") + mode.name;
+        mode.config.seed = SAMPLER_SEED;
+
+        double build = bench::best_seconds(SAMPLER_REPEATS, [&]() {
+            text_sampler* sampler = sampler_create(&mode.config);
+            uint32_t index;
+            sampler_next_index(sampler, &index);
+            sampler_destroy(sampler);
+        });
+        reporter.record(name, "build_ms", build * 1e3, "ms");
+
+        for (int threads : {1, max_threads}) {
+            // Amostradores montados fora da medição, um por thread
+            vector<text_sampler*> samplers;
+            for (int t = 0; t < threads; t++) {
+                mode.config.seed = SAMPLER_SEED + static_cast<uint64_t>(t);
+                samplers.push_back(sampler_create(&mode.config));
+                uint32_t index;
+                sampler_next_index(samplers.back(), &index);
+            }
+            double seconds = bench::best_seconds(SAMPLER_REPEATS, [&]() {
+                vector<thread> workers;
+                for (int t = 0; t < threads; t++) {
+                    workers.emplace_back([&, t]() {
+                        uint32_t index = 0;
+                        for (int i = 0; i < SAMPLER_DRAWS; i++) {
+                            sampler_next_index(samplers[static_cast<size_t>(t)], &index);
+                        }
+                        bench::do_not_optimize(&index);
+                    });
+                }
+                for (thread& worker : workers) {
+                    worker.join();
+                }
+            });
+            for (text_sampler* sampler : samplers) {
+                sampler_destroy(sampler);
+            }
+            double total = static_cast<double>(threads) * SAMPLER_DRAWS;
+            reporter.record(name + "/threads_" + to_string(threads), "ns_per_draw", seconds * 1e9 / total, "ns");
+        }
+    }
+
+    backend_cleanup();
+}
@@ -0,0 +1,87 @@
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "bench.h"
+#include "scheduler.h"
+
+using namespace std;
+
+static const int SCHEDULER_JOBS = 10000;
+static const int SCHEDULER_REPEATS = 3;
+static const int64_t SCHEDULER_TICK_NS = 2000000;     // 2 ms
+static const int SCHEDULER_TICKS = 500;
+
+
+static void no_timer(void*, int64_t) {}
+
+
+/**
+ * Agendador por prazos: custo de agendar e de despachar muitas tarefas vencidas de uma vez (heap e
+ * reagendamento das periódicas, sem laço real), e atraso de despertar de uma tarefa periódica curta no
+ * laço timerfd, medido pelo próprio tick (now_ns - deadline_ns).
+ */
+BENCH_CASE(scheduler_deadlines) {
+    scheduler_loop_ops ops{nullptr, no_timer};
+    uint64_t runs = 0;
+
+    double add = bench::best_seconds(SCHEDULER_REPEATS, [&]() {
+        scheduler* sched = scheduler_create(&ops, 0);
+        for (int i = 0; i < SCHEDULER_JOBS; i++) {
+            scheduler_add_periodic(sched, i, 1000000000LL + i, [&runs](const scheduler_tick&) { runs++; });
+        }
+        scheduler_destroy(sched);
+    });
+    reporter.record("scheduler_deadlines/add", "ns_per_job", add * 1e9 / SCHEDULER_JOBS, "ns");
+
+    // Todas as tarefas vencidas (prazos no passado): um despacho roda e reagenda cada uma.
+    // O heap é montado de novo a cada repetição, fora da medição
+    double dispatch = 0.0;
+    for (int repeat = 0; repeat < SCHEDULER_REPEATS; repeat++) {
+        scheduler* sched = scheduler_create(&ops, 0);
+        for (int i = 0; i < SCHEDULER_JOBS; i++) {
+            scheduler_add_periodic(sched, i, 1000000000LL + i, [&runs](const scheduler_tick&) { runs++; });
+        }
+        double seconds = bench::best_seconds(1, [&]() {
+            scheduler_run_due(sched);
+        });
+        scheduler_destroy(sched);
+        dispatch = repeat == 0 ? seconds : min(dispatch, seconds);
+    }
+    reporter.record("scheduler_deadlines/run_due", "ns_per_job", dispatch * 1e9 / SCHEDULER_JOBS, "ns");
+    bench::do_not_optimize(&runs);
+
+    scheduler_timerfd_loop* loop = scheduler_timerfd_create(0);
+    if (!loop) {
+        reporter.record("scheduler_deadlines/timerfd", "created", 0.0, "bool");
+        return;
+    }
+    vector<double> lateness;
+    lateness.reserve(SCHEDULER_TICKS);
+    uint64_t missed = 0;
+    scheduler* timer_sched = scheduler_timerfd_scheduler(loop);
+    int64_t start = monotonic_now_ns();
+    scheduler_add_periodic(timer_sched, start + SCHEDULER_TICK_NS, SCHEDULER_TICK_NS, [&](const scheduler_tick& tick) {
+        lateness.push_back((tick.now_ns - tick.deadline_ns) / 1e3);
+        missed += tick.missed;
+    });
+    while (lateness.size() < static_cast<size_t>(SCHEDULER_TICKS)) {
+        if (scheduler_timerfd_run_once(loop, 1000) < 0) {
+            break;
+        }
+    }
+    int64_t elapsed = monotonic_now_ns() - start;
+    scheduler_timerfd_destroy(loop);
+    if (lateness.empty()) {
+        return;
+    }
+
+    sort(lateness.begin(), lateness.end());
+    reporter.record("scheduler_deadlines/timerfd", "lateness_p50", lateness[lateness.size() / 2], "us");
+    reporter.record("scheduler_deadlines/timerfd", "lateness_p99", lateness[lateness.size() * 99 / 100], "us");
+    reporter.record("scheduler_deadlines/timerfd", "lateness_max", lateness.back(), "us");
+    reporter.record("scheduler_deadlines/timerfd", "missed", static_cast<double>(missed), "ticks");
+    // Deriva: duração total comparada com os ticks esperados (0 sem acúmulo de atrasos)
+    double expected = static_cast<double>(SCHEDULER_TICKS + missed) * SCHEDULER_TICK_NS;
+    reporter.record("scheduler_deadlines/timerfd", "drift", (elapsed - expected) / 1e3, "us");
+}
@@ -0,0 +1,48 @@
+#include <vector>
+
+#include "bench.h"
+#include "lib_textkernel.h"
+
+using namespace std;
+
+// Tamanho do buffer gerado em cada repetição
+static const size_t KERNEL_BYTES = 64u << 20;
+static const int KERNEL_REPEATS = 5;
+static const uint64_t KERNEL_SEED = 12345;
+
+
+/**
+ * Caminho escalar anterior ao kernel: uma chamada ao gerador por caractere.
+ */
+static void fill_per_char(prng_state* rng, char* dst, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        dst[i] = (char)('a' + prng_bounded(rng, 26));
+    }
+}
+
+
+/**
+ * Mede a vazão (GB/s de texto gerado) do caminho por caractere e de cada implementação do kernel
+ * suportada por esta CPU.
+ */
+BENCH_CASE(textkernel_fill) {
+    vector<char> buffer(KERNEL_BYTES);
+
+    auto measure = [&](const string& name, textkernel_fill_fn fill) {
+        prng_state rng;
+        prng_seed(&rng, KERNEL_SEED);
+        double seconds = bench::best_seconds(KERNEL_REPEATS, [&]() {
+            fill(&rng, buffer.data(), buffer.size());
+            bench::do_not_optimize(buffer.data());
+        });
+        reporter.record("textkernel_fill/" + name, "throughput", KERNEL_BYTES / seconds / 1e9, "GB/s");
+    };
+
+    measure("per_char", fill_per_char);
+    for (textkernel_isa isa : {TEXTKERNEL_SCALAR, TEXTKERNEL_SSE2, TEXTKERNEL_AVX2}) {
+        textkernel_fill_fn fill = textkernel_select(isa);
+        if (fill) {
+            measure(textkernel_isa_name(isa), fill);
+        }
+    }
+}
@@ -0,0 +1,91 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <string>
+
+#include "bench.h"
+#include "http_client.h"
+#include "stub_http_server.h"
+#include "time_service.h"
+#include "worldtime.h"
+
+using namespace std;
+
+static const int TIME_QUERIES = 10000000;
+static const int TIME_FETCHES = 2000;
+
+
+/**
+ * Resposta da worldtimeapi com o relógio do sistema, para que o servidor local se comporte como o real.
+ */
+static string worldtime_now_body() {
+    int64_t now = chrono::duration_cast<chrono::nanoseconds>(chrono::system_clock::now().time_since_epoch()).count();
+    time_t seconds = static_cast<time_t>(now / 1000000000);
+    long long micros = now % 1000000000 / 1000;
+    tm utc;
+    gmtime_r(&seconds, &utc);
+    char stamp[32];
+    strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%S", &utc);
+
+    char body[256];
+    snprintf(body, sizeof(body),
+             "{\"datetime\":\"%s.%06lld+00:00\",\"dst\":false,\"timezone\":\"Etc/UTC\",\"unixtime\":%lld,"
+             "\"utc_datetime\":\"%s.%06lld+00:00\",\"utc_offset\":\"+00:00\"}",
+             stamp, micros, static_cast<long long>(seconds), stamp, micros);
+    return body;
+}
+
+
+/**
+ * Custo de obter o horário remoto: consulta local ao relógio extrapolado versus uma requisição
+ * por consulta (mesmo com conexão reutilizada), contra um servidor local.
+ */
+BENCH_CASE(time_service) {
+    bench::StubHttpServer server(worldtime_now_body);
+    if (!server.start()) {
+        reporter.record("time_service", "server_started", 0.0, "bool");
+        return;
+    }
+    const string url = server.url("/api/timezone/America/Manaus");
+
+    if (!time_service_start(url.c_str(), 60000)) {
+        reporter.record("time_service", "synced", 0.0, "bool");
+        server.stop();
+        return;
+    }
+
+    int64_t sink = 0;
+    double local = bench::best_seconds(3, [&]() {
+        for (int i = 0; i < TIME_QUERIES; i++) {
+            int64_t now;
+            time_service_now_ns(&now);
+            sink += now;
+        }
+    });
+    bench::do_not_optimize(&sink);
+    reporter.record("time_service/local", "ns_per_query", local * 1e9 / TIME_QUERIES, "ns");
+
+    http_buffer response;
+    double network = bench::best_seconds(3, [&]() {
+        for (int i = 0; i < TIME_FETCHES; i++) {
+            worldtime_info info;
+            http_get(url.c_str(), &response);
+            worldtime_parse(response.data, response.length, &info, nullptr);
+            sink += info.unix_ns;
+        }
+    });
+    http_buffer_free(&response);
+    bench::do_not_optimize(&sink);
+    reporter.record("time_service/fetch_per_query", "ns_per_query", network * 1e9 / TIME_FETCHES, "ns");
+
+    // Erro da extrapolação em relação ao relógio do servidor (aqui, o mesmo relógio do sistema)
+    int64_t extrapolated = 0;
+    time_service_now_ns(&extrapolated);
+    int64_t reference = chrono::duration_cast<chrono::nanoseconds>(chrono::system_clock::now().time_since_epoch()).count();
+    reporter.record("time_service/local", "abs_error", static_cast<double>(llabs(extrapolated - reference)) / 1000.0, "us");
+
+    time_service_stop();
+    http_client_cleanup();
+    server.stop();
+}
@@ -0,0 +1,46 @@
+#include <cstdint>
+
+#include "bench.h"
+#include "trace.h"
+
+using namespace std;
+
+static const int TRACE_SCOPES = 10000000;
+static const int TRACE_REPEATS = 5;
+
+
+/**
+ * Laço com um ponto de rastreamento por iteração; o acumulador impede que o laço seja eliminado.
+ */
+static uint64_t traced_loop(int iterations) {
+    uint64_t sum = 0;
+    for (int i = 0; i < iterations; i++) {
+        TRACE_SCOPE("bench_scope");
+        sum += static_cast<uint64_t>(i) * 2654435761u;
+        bench::do_not_optimize(&sum);
+    }
+    return sum;
+}
+
+
+/**
+ * Custo de TRACE_SCOPE desligado (deve ficar próximo do laço vazio) e ligado (duas leituras do relógio
+ * e uma gravação no buffer da thread).
+ */
+BENCH_CASE(trace_overhead) {
+    bool was_active = trace_enabled();
+
+    trace_enable(false);
+    double disabled = bench::best_seconds(TRACE_REPEATS, []() { traced_loop(TRACE_SCOPES); });
+
+    trace_enable(true);
+    double enabled = bench::best_seconds(TRACE_REPEATS, []() { traced_loop(TRACE_SCOPES); });
+    trace_enable(was_active);
+    if (!was_active) {
+        trace_clear();
+    }
+
+    reporter.record("trace_overhead/disabled", "ns_per_scope", disabled * 1e9 / TRACE_SCOPES, "ns");
+    reporter.record("trace_overhead/enabled", "ns_per_scope", enabled * 1e9 / TRACE_SCOPES, "ns");
+    reporter.record("trace_overhead", "tsc_clock", trace_use_tsc ? 1 : 0, "bool");
+}
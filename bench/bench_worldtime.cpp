@@ -0,0 +1,114 @@
+#include <cstdio>
+#include <regex>
+#include <string>
+#include <vector>
+
+#ifdef BENCH_HAVE_QT
+#include <QRegularExpression>
+#include <QString>
+#endif
+
+#include "bench.h"
+#include "worldtime.h"
+
+using namespace std;
+
+static const int WORLDTIME_PAYLOADS = 20000;
+static const int WORLDTIME_REPEATS = 3;
+
+
+/**
+ * Log de respostas da worldtimeapi, como o de uma repetição de log (horários consecutivos).
+ */
+static vector<string> build_payloads() {
+    vector<string> payloads;
+    payloads.reserve(WORLDTIME_PAYLOADS);
+    for (int i = 0; i < WORLDTIME_PAYLOADS; i++) {
+        int seconds = i % 60;
+        int minutes = i / 60 % 60;
+        char body[512];
+        snprintf(body, sizeof(body),
+                 "{\"abbreviation\":\"-04\",\"client_ip\":\"127.0.0.1\",\"datetime\":\"2024-05-01T10:%02d:%02d.%06d-04:00\","
+                 "\"day_of_week\":3,\"day_of_year\":122,\"dst\":false,\"dst_from\":null,\"dst_offset\":0,\"dst_until\":null,"
+                 "\"raw_offset\":-14400,\"timezone\":\"America/Manaus\",\"unixtime\":%d,"
+                 "\"utc_datetime\":\"2024-05-01T14:%02d:%02d.%06d+00:00\",\"utc_offset\":\"-04:00\",\"week_number\":18}",
+                 minutes, seconds, i * 37 % 1000000, 1714572000 + i, minutes, seconds, i * 37 % 1000000);
+        payloads.push_back(body);
+    }
+    return payloads;
+}
+
+
+/**
+ * Registra vazão (respostas/s e MB/s) e o número de respostas válidas de um caminho de análise.
+ */
+static void record(bench::Reporter& reporter, const string& name, double seconds, size_t bytes, int valid) {
+    reporter.record(name, "payloads_per_second", WORLDTIME_PAYLOADS / seconds, "payloads/s");
+    reporter.record(name, "ns_per_payload", seconds * 1e9 / WORLDTIME_PAYLOADS, "ns");
+    reporter.record(name, "throughput", bytes / seconds / 1e6, "MB/s");
+    reporter.record(name, "valid", valid, "count");
+}
+
+
+/**
+ * Extração de timezone/datetime: analisador estruturado (sem alocação) versus o caminho por expressões
+ * regulares usado antes na interface (cópia para string e duas regex construídas por resposta).
+ */
+BENCH_CASE(worldtime_parse) {
+    vector<string> payloads = build_payloads();
+    size_t bytes = 0;
+    for (const string& payload : payloads) {
+        bytes += payload.size();
+    }
+
+    int valid = 0;
+    double parser = bench::best_seconds(WORLDTIME_REPEATS, [&]() {
+        valid = 0;
+        for (const string& payload : payloads) {
+            worldtime_info info;
+            if (worldtime_parse(payload.data(), payload.size(), &info, nullptr)) {
+                valid++;
+            }
+            bench::do_not_optimize(&info);
+        }
+    });
+    record(reporter, "worldtime_parse/parser", parser, bytes, valid);
+
+    double std_regex = bench::best_seconds(WORLDTIME_REPEATS, [&]() {
+        valid = 0;
+        for (const string& payload : payloads) {
+            string json(payload.c_str());
+            regex tz_regex("\"timezone\"\\s*:\\s*\"([^\"]+)\"");
+            regex dt_regex("\"datetime\"\\s*:\\s*\"([^\"]+)\"");
+            smatch tz_match, dt_match;
+            if (regex_search(json, tz_match, tz_regex) && regex_search(json, dt_match, dt_regex)) {
+                string title = tz_match[1].str() + ", " + dt_match[1].str();
+                bench::do_not_optimize(title.data());
+                valid++;
+            }
+        }
+    });
+    record(reporter, "worldtime_parse/std_regex", std_regex, bytes, valid);
+    reporter.record("worldtime_parse/parser", "speedup_vs_std_regex", std_regex / parser, "x");
+
+#ifdef BENCH_HAVE_QT
+    // O mesmo código que a interface executava a cada resposta
+    double qt_regex = bench::best_seconds(WORLDTIME_REPEATS, [&]() {
+        valid = 0;
+        for (const string& payload : payloads) {
+            QString jsonStr(payload.c_str());
+            QRegularExpression tzRegex(QStringLiteral("\"timezone\"\\s*:\\s*\"([^\"]+)\""));
+            QRegularExpression dtRegex(QStringLiteral("\"datetime\"\\s*:\\s*\"([^\"]+)\""));
+            QRegularExpressionMatch tzMatch = tzRegex.match(jsonStr);
+            QRegularExpressionMatch dtMatch = dtRegex.match(jsonStr);
+            if (tzMatch.hasMatch() && dtMatch.hasMatch()) {
+                QString title = tzMatch.captured(1) + ", " + dtMatch.captured(1);
+                bench::do_not_optimize(title.constData());
+                valid++;
+            }
+        }
+    });
+    record(reporter, "worldtime_parse/qt_regex", qt_regex, bytes, valid);
+    reporter.record("worldtime_parse/parser", "speedup_vs_qt_regex", qt_regex / parser, "x");
+#endif
+}
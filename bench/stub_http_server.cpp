@@ -0,0 +1,129 @@
+#include <cstring>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "stub_http_server.h"
+
+using namespace std;
+
+namespace bench {
+
+StubHttpServer::StubHttpServer(function<string()> body) : body(move(body)) {}
+
+StubHttpServer::~StubHttpServer() {
+    stop();
+}
+
+bool StubHttpServer::start() {
+    listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd < 0) {
+        return false;
+    }
+    int one = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    socklen_t len = sizeof(addr);
+    if (bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(listen_fd, 128) != 0 ||
+        getsockname(listen_fd, reinterpret_cast<sockaddr*>(&addr), &len) != 0) {
+        close(listen_fd);
+        listen_fd = -1;
+        return false;
+    }
+    listen_port = ntohs(addr.sin_port);
+
+    running = true;
+    acceptor = thread(&StubHttpServer::accept_loop, this);
+    return true;
+}
+
+void StubHttpServer::stop() {
+    if (!running.exchange(false)) {
+        return;
+    }
+    // shutdown() acorda o accept() e os read() bloqueados
+    shutdown(listen_fd, SHUT_RDWR);
+    acceptor.join();
+    close(listen_fd);
+    listen_fd = -1;
+
+    unique_lock<mutex> lock(clients_mutex);
+    for (int fd : client_fds) {
+        shutdown(fd, SHUT_RDWR);
+    }
+    clients_done.wait(lock, [this]() { return active_clients == 0; });
+}
+
+string StubHttpServer::url(const string& path) const {
+    return "http://127.0.0.1:" + to_string(listen_port) + path;
+}
+
+void StubHttpServer::accept_loop() {
+    while (running) {
+        int fd = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (!running) {
+                break;
+            }
+            continue;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        accepted.fetch_add(1, memory_order_relaxed);
+
+        lock_guard<mutex> lock(clients_mutex);
+        client_fds.push_back(fd);
+        active_clients++;
+        thread(&StubHttpServer::serve, this, fd).detach();
+    }
+}
+
+void StubHttpServer::serve(int fd) {
+    string pending;
+    char buffer[4096];
+    for (;;) {
+        ssize_t n = read(fd, buffer, sizeof(buffer));
+        if (n <= 0) {
+            break;
+        }
+        pending.append(buffer, static_cast<size_t>(n));
+
+        // Responde a cada requisição completa (cabeçalhos terminados por linha em branco)
+        size_t end;
+        while ((end = pending.find("\r\n\r\n")) != string::npos) {
+            bool close_after = pending.substr(0, end).find("Connection: close") != string::npos;
+            pending.erase(0, end + 4);
+
+            string content = body();
+            string response = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: " +
+                              to_string(content.size()) + "\r\n" +
+                              (close_after ? "Connection: close\r\n" : "Connection: keep-alive\r\n") + "\r\n" + content;
+            served.fetch_add(1, memory_order_relaxed);
+            if (write(fd, response.data(), response.size()) != static_cast<ssize_t>(response.size()) || close_after) {
+                pending.clear();
+                shutdown(fd, SHUT_RDWR);
+                break;
+            }
+        }
+    }
+
+    lock_guard<mutex> lock(clients_mutex);
+    for (int& client : client_fds) {
+        if (client == fd) {
+            client = client_fds.back();
+            client_fds.pop_back();
+            break;
+        }
+    }
+    close(fd);
+    active_clients--;
+    clients_done.notify_all();
+}
+
+}  // namespace bench
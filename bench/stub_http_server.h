@@ -0,0 +1,55 @@
+#ifndef STUB_HTTP_SERVER_H
+#define STUB_HTTP_SERVER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace bench {
+
+/**
+ * Servidor HTTP/1.1 mínimo em 127.0.0.1 (porta efêmera), para medir o cliente HTTP sem depender da rede.
+ * Responde a qualquer GET com o corpo produzido por `body` e mantém a conexão aberta (keep-alive),
+ * com uma thread (desanexada) por conexão.
+ */
+class StubHttpServer {
+public:
+    explicit StubHttpServer(std::function<std::string()> body);
+    ~StubHttpServer();
+
+    // Abre a porta e começa a aceitar conexões. Retorna false em caso de erro.
+    bool start();
+    // Fecha a porta e todas as conexões, esperando as threads terminarem.
+    void stop();
+
+    int port() const { return listen_port; }
+    std::string url(const std::string& path = "/") const;
+
+    uint64_t requests() const { return served.load(std::memory_order_relaxed); }
+    uint64_t connections() const { return accepted.load(std::memory_order_relaxed); }
+
+private:
+    void accept_loop();
+    void serve(int fd);
+
+    std::function<std::string()> body;
+    int listen_fd = -1;
+    int listen_port = 0;
+    std::atomic<bool> running{false};
+    std::atomic<uint64_t> served{0};
+    std::atomic<uint64_t> accepted{0};
+    std::thread acceptor;
+    std::mutex clients_mutex;
+    std::vector<int> client_fds;
+    std::condition_variable clients_done;
+    int active_clients = 0;
+};
+
+}  // namespace bench
+
+#endif
@@ -0,0 +1,269 @@
+#include <memory>
+
+#include <QAudioDecoder>
+#include <QAudioDeviceInfo>
+#include <QAudioFormat>
+#include <QAudioOutput>
+#include <QFile>
+#include <QFutureWatcher>
+#include <QIODevice>
+#include <QVector>
+#include <QtConcurrent>
+
+#include "audio_qt.h"
+#include "../backend/trace.h"
+
+// Formato único do mixer: os sons são convertidos para ele no carregamento
+static const int AUDIO_SAMPLE_RATE = 44100;
+static const int AUDIO_CHANNELS = 2;
+static const int AUDIO_MAX_VOICES = 8;
+// Áudio mantido no dispositivo: limita a latência de um disparo sem arriscar falhas de reprodução
+static const int AUDIO_BUFFER_MS = 20;
+
+static QAudioFormat mixerFormat() {
+    QAudioFormat format;
+    format.setSampleRate(AUDIO_SAMPLE_RATE);
+    format.setChannelCount(AUDIO_CHANNELS);
+    format.setSampleSize(16);
+    format.setCodec("audio/pcm");
+    format.setByteOrder(QAudioFormat::LittleEndian);
+    format.setSampleType(QAudioFormat::SignedInt);
+    return format;
+}
+
+
+/**
+ * Dispositivo lido pela saída de áudio (modo pull): cada leitura gera um bloco do mixer.
+ * Sem sons tocando, entrega silêncio, então a saída nunca para e um disparo não espera reabri-la.
+ */
+class MixerDevice : public QIODevice {
+public:
+    MixerDevice(audio_mixer* mixer, QAudioOutput* output, QObject* parent)
+        : QIODevice(parent), mixer(mixer), output(output) {}
+
+    bool isSequential() const override { return true; }
+
+    qint64 bytesAvailable() const override {
+        return output->periodSize() + QIODevice::bytesAvailable();
+    }
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) override {
+        const qint64 frameBytes = AUDIO_CHANNELS * sizeof(int16_t);
+        qint64 frames = maxSize / frameBytes;
+        if (frames <= 0) {
+            return 0;
+        }
+        // Áudio já entregue e ainda não tocado: o bloco gerado agora só será ouvido depois dele
+        qint64 queuedBytes = output->bufferSize() - output->bytesFree();
+        int64_t delayNs = queuedBytes > 0 ? queuedBytes * 1000000000LL / (frameBytes * AUDIO_SAMPLE_RATE) : 0;
+        audio_mixer_render(mixer, reinterpret_cast<int16_t*>(data), static_cast<size_t>(frames), delayNs);
+        return frames * frameBytes;
+    }
+
+    qint64 writeData(const char*, qint64) override { return -1; }
+
+private:
+    audio_mixer* mixer;
+    QAudioOutput* output;
+};
+
+
+QtAudioCues::QtAudioCues(QObject* parent) : QObject(parent) {
+    mixer = audio_mixer_create(AUDIO_SAMPLE_RATE, AUDIO_CHANNELS, AUDIO_MAX_VOICES);
+    audio_mixer_set_latency_hook(mixer, &QtAudioCues::latencyHook, this);
+    startOutput();
+}
+
+
+QtAudioCues::~QtAudioCues() {
+    // Decodificações ainda não entregues: espera e descarta o resultado (os watchers são filhos e
+    // são destruídos com o objeto, junto com o finished pendente)
+    for (QFutureWatcher<audio_clip*>* watcher : pendingDecodes) {
+        watcher->waitForFinished();
+        if (audio_clip* clip = watcher->result()) {
+            audio_clip_free(clip);
+            delete clip;
+        }
+    }
+    stopOutput();
+    for (audio_clip* clip : clips) {
+        audio_clip_free(clip);
+        delete clip;
+    }
+    audio_mixer_destroy(mixer);
+}
+
+
+/**
+ * Abre a saída na thread de áudio, com um buffer curto, e deixa o mixer tocando silêncio.
+ * Não espera a abertura (que pode levar dezenas de ms no servidor de som): outputStarted informa o fim.
+ */
+void QtAudioCues::startOutput() {
+    QAudioFormat format = mixerFormat();
+    QAudioDeviceInfo deviceInfo = QAudioDeviceInfo::defaultOutputDevice();
+    if (deviceInfo.isNull()) {
+        qWarning("Nenhuma saída de áudio disponível: efeitos sonoros desativados");
+        outputStatus.store(OUTPUT_FAILED, std::memory_order_release);
+        return;
+    }
+    if (!deviceInfo.isFormatSupported(format)) {
+        qWarning("Saída de áudio não anuncia suporte a %d Hz/%d canais/16 bits; tentando mesmo assim",
+                 AUDIO_SAMPLE_RATE, AUDIO_CHANNELS);
+    }
+
+    audioThread.setObjectName("audio");
+    audioThread.start(QThread::TimeCriticalPriority);
+    audioContext = new QObject;
+    audioContext->moveToThread(&audioThread);
+
+    QMetaObject::invokeMethod(audioContext, [this, format, deviceInfo]() {
+        trace_set_thread_name("audio");
+        output = new QAudioOutput(deviceInfo, format, audioContext);
+        output->setBufferSize(format.bytesForDuration(AUDIO_BUFFER_MS * 1000));
+        device = new MixerDevice(mixer, output, audioContext);
+        device->open(QIODevice::ReadOnly);
+        output->start(device);
+        bool ok = output->error() == QAudio::NoError;
+        if (!ok) {
+            qWarning("Falha ao abrir a saída de áudio (erro %d)", static_cast<int>(output->error()));
+        }
+        outputStatus.store(ok ? OUTPUT_READY : OUTPUT_FAILED, std::memory_order_release);
+        emit outputStarted(ok);
+    }, Qt::QueuedConnection);
+}
+
+
+void QtAudioCues::stopOutput() {
+    if (!audioContext) {
+        return;
+    }
+    // Enfileirada depois da abertura: roda mesmo que ela ainda não tenha terminado
+    QMetaObject::invokeMethod(audioContext, [this]() {
+        output->stop();
+        delete audioContext;
+    }, Qt::BlockingQueuedConnection);
+    audioContext = nullptr;
+    output = nullptr;
+    device = nullptr;
+    audioThread.quit();
+    audioThread.wait();
+}
+
+
+bool QtAudioCues::load(const QString& key, const QString& path) {
+    if (clips.contains(key)) {
+        return true;
+    }
+    if (!QFile::exists(path)) {
+        qWarning("Som não encontrado: %s", qPrintable(path));
+        return false;
+    }
+    if (!path.endsWith(".wav", Qt::CaseInsensitive)) {
+        return loadDecoded(key, path);
+    }
+    return loadWav(key, path);
+}
+
+
+/**
+ * Lê e converte o WAV para o formato do mixer no pool de threads do Qt; o som é registrado
+ * na thread da interface, quando a conversão termina.
+ */
+bool QtAudioCues::loadWav(const QString& key, const QString& path) {
+    QFutureWatcher<audio_clip*>* watcher = new QFutureWatcher<audio_clip*>(this);
+    pendingDecodes.insert(watcher);
+    connect(watcher, &QFutureWatcher<audio_clip*>::finished, this, [this, watcher, key, path]() {
+        audio_clip* clip = watcher->result();
+        // Entregue: o destrutor não descarta mais este resultado
+        pendingDecodes.remove(watcher);
+        watcher->deleteLater();
+        if (!clip) {
+            qWarning("Falha ao decodificar o som: %s", qPrintable(path));
+            emit cueFailed(key);
+            return;
+        }
+        clips.insert(key, clip);
+        emit cueLoaded(key);
+    });
+    watcher->setFuture(QtConcurrent::run([path]() -> audio_clip* {
+        TRACE_SCOPE("audio_decode_wav");
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            return nullptr;
+        }
+        QByteArray data = file.readAll();
+        audio_clip* clip = new audio_clip;
+        if (!audio_clip_decode_wav(reinterpret_cast<const uint8_t*>(data.constData()), static_cast<size_t>(data.size()),
+                                   AUDIO_SAMPLE_RATE, AUDIO_CHANNELS, clip)) {
+            delete clip;
+            return nullptr;
+        }
+        return clip;
+    }));
+    return true;
+}
+
+
+/**
+ * Decodifica formatos compactados (MP3, ...) com o QAudioDecoder, já no formato do mixer.
+ * O som fica disponível quando cueLoaded(key) for emitido.
+ */
+bool QtAudioCues::loadDecoded(const QString& key, const QString& path) {
+    QAudioDecoder* decoder = new QAudioDecoder(this);
+    decoder->setAudioFormat(mixerFormat());
+    decoder->setSourceFilename(path);
+
+    auto samples = std::make_shared<QVector<qint16>>();
+    connect(decoder, &QAudioDecoder::bufferReady, this, [decoder, samples, path]() {
+        QAudioBuffer buffer = decoder->read();
+        QAudioFormat format = buffer.format();
+        if (format.sampleRate() != AUDIO_SAMPLE_RATE || format.channelCount() != AUDIO_CHANNELS ||
+            format.sampleSize() != 16 || format.sampleType() != QAudioFormat::SignedInt) {
+            qWarning("Decodificador entregou um formato inesperado para %s", qPrintable(path));
+            return;
+        }
+        const qint16* data = buffer.constData<qint16>();
+        samples->append(QVector<qint16>(data, data + buffer.sampleCount()));
+    });
+    connect(decoder, &QAudioDecoder::finished, this, [this, decoder, samples, key]() {
+        audio_clip* clip = new audio_clip;
+        if (audio_clip_from_pcm(samples->constData(), static_cast<size_t>(samples->size() / AUDIO_CHANNELS),
+                                AUDIO_SAMPLE_RATE, AUDIO_CHANNELS, clip)) {
+            clips.insert(key, clip);
+            emit cueLoaded(key);
+        } else {
+            delete clip;
+            emit cueFailed(key);
+        }
+        decoder->deleteLater();
+    });
+    connect(decoder, QOverload<QAudioDecoder::Error>::of(&QAudioDecoder::error), this, [this, decoder, key, path]() {
+        qWarning("Falha ao decodificar o som %s: %s", qPrintable(path), qPrintable(decoder->errorString()));
+        emit cueFailed(key);
+        decoder->deleteLater();
+    });
+    decoder->start();
+    return true;
+}
+
+
+bool QtAudioCues::play(const QString& key, qreal volume) {
+    audio_clip* clip = clips.value(key, nullptr);
+    if (!clip || outputStatus.load(std::memory_order_acquire) != OUTPUT_READY) {
+        return false;
+    }
+    return audio_mixer_trigger(mixer, clip, static_cast<float>(volume));
+}
+
+
+/**
+ * Executado na thread de áudio, na mixagem da primeira amostra de cada disparo.
+ */
+void QtAudioCues::latencyHook(void* user, const audio_cue_latency* latency) {
+    QtAudioCues* cues = static_cast<QtAudioCues*>(user);
+    qint64 total = latency->trigger_to_render_ns + latency->output_delay_ns;
+    cues->lastLatency.store(total, std::memory_order_relaxed);
+    TRACE_COUNTER("audio_cue_latency_us", total / 1000);
+    emit cues->cueLatency(latency->trigger_to_render_ns, latency->output_delay_ns);
+}
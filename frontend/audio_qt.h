@@ -0,0 +1,78 @@
+#ifndef AUDIO_QT_H
+#define AUDIO_QT_H
+
+#include <atomic>
+
+#include <QFutureWatcher>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QThread>
+
+#include "../backend/audio_mixer.h"
+
+class QAudioOutput;
+class QIODevice;
+
+/**
+ * Efeitos sonoros de baixa latência para a interface, sobre o mixer do backend (audio_mixer.h).
+ *
+ * Os arquivos são decodificados uma única vez para PCM em memória (WAV diretamente; outros formatos,
+ * como MP3, pelo QAudioDecoder), fora da thread da interface. A saída de áudio é aberta sem bloquear
+ * quem cria o objeto e fica aberta o tempo todo em uma thread própria, puxando blocos curtos do mixer,
+ * de modo que play() só enfileira o disparo: não há reabertura de mídia, e vários disparos tocam
+ * sobrepostos. Travamentos da thread da interface não interrompem o som.
+ */
+class QtAudioCues : public QObject {
+    Q_OBJECT
+
+public:
+    explicit QtAudioCues(QObject* parent = nullptr);
+    ~QtAudioCues() override;
+
+    // Decodifica um arquivo em segundo plano e o registra com o nome `key`; cueLoaded ou cueFailed
+    // informam o resultado. Retorna false se o arquivo não existe
+    bool load(const QString& key, const QString& path);
+
+    // Dispara o som sem bloquear (só enfileira para a thread de áudio); false se ele não estiver carregado
+    bool play(const QString& key, qreal volume = 1.0);
+
+    // true enquanto a saída de áudio ainda está sendo aberta (ver outputStarted)
+    bool outputStarting() const { return outputStatus.load(std::memory_order_acquire) == OUTPUT_STARTING; }
+
+    // Latência do último disparo, do play() até a primeira amostra ser tocada (estimada), em ns
+    qint64 lastLatencyNs() const { return lastLatency.load(std::memory_order_relaxed); }
+
+signals:
+    void cueLoaded(const QString& key);
+    void cueFailed(const QString& key);
+
+    // Emitido na thread de áudio quando a abertura da saída termina (conectar com fila)
+    void outputStarted(bool ok);
+
+    // Emitido na thread de áudio quando a primeira amostra de um disparo é mixada (conectar com fila)
+    void cueLatency(qint64 triggerToRenderNs, qint64 outputDelayNs);
+
+private:
+    enum OutputStatus { OUTPUT_STARTING, OUTPUT_READY, OUTPUT_FAILED };
+
+    static void latencyHook(void* user, const audio_cue_latency* latency);
+
+    bool loadWav(const QString& key, const QString& path);
+    bool loadDecoded(const QString& key, const QString& path);
+    void startOutput();
+    void stopOutput();
+
+    audio_mixer* mixer = nullptr;
+    QThread audioThread;
+    QObject* audioContext = nullptr;    // Vive na thread de áudio; dono da saída e do dispositivo
+    QAudioOutput* output = nullptr;
+    QIODevice* device = nullptr;
+    QHash<QString, audio_clip*> clips;
+    QSet<QFutureWatcher<audio_clip*>*> pendingDecodes;     // Conversões de WAV ainda não entregues
+    std::atomic<qint64> lastLatency{0};
+    std::atomic<int> outputStatus{OUTPUT_STARTING};
+};
+
+#endif
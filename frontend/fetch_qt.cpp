@@ -0,0 +1,100 @@
+#include <QSocketNotifier>
+
+#include "fetch_qt.h"
+
+QtFetchLoop::QtFetchLoop(QObject* parent) : QObject(parent) {
+    timeoutTimer.setSingleShot(true);
+    connect(&timeoutTimer, SIGNAL(timeout()), this, SLOT(timerExpired()));
+
+    fetch_loop_ops ops{this, &QtFetchLoop::watchSocket, &QtFetchLoop::setTimer};
+    fetchEngine = fetch_engine_create(&ops);
+}
+
+
+QtFetchLoop::~QtFetchLoop() {
+    // O motor ainda pode remover sockets ao ser destruído, então os notifiers são liberados depois dele
+    fetch_engine_destroy(fetchEngine);
+    fetchEngine = nullptr;
+    for (Watch& watch : watches) {
+        releaseWatch(watch);
+    }
+}
+
+
+void QtFetchLoop::watchSocket(void* user, int fd, int events) {
+    static_cast<QtFetchLoop*>(user)->updateWatch(fd, events);
+}
+
+
+void QtFetchLoop::setTimer(void* user, long timeoutMs) {
+    QtFetchLoop* loop = static_cast<QtFetchLoop*>(user);
+    if (timeoutMs < 0) {
+        loop->timeoutTimer.stop();
+    } else {
+        // Timeout 0 vira um disparo na próxima volta do laço, fora do callback da libcurl
+        loop->timeoutTimer.start(static_cast<int>(timeoutMs));
+    }
+}
+
+
+/**
+ * Cria, troca ou remove os notifiers de leitura e escrita de um socket.
+ */
+void QtFetchLoop::updateWatch(int fd, int events) {
+    Watch& watch = watches[fd];
+
+    bool wantRead = events & FETCH_EVENT_READ;
+    bool wantWrite = events & FETCH_EVENT_WRITE;
+
+    if (wantRead && !watch.read) {
+        watch.read = new QSocketNotifier(fd, QSocketNotifier::Read, this);
+        connect(watch.read, SIGNAL(activated(int)), this, SLOT(socketActivated(int)));
+    } else if (!wantRead && watch.read) {
+        // O notifier pode estar emitindo o sinal agora: desativa e libera depois
+        watch.read->setEnabled(false);
+        watch.read->deleteLater();
+        watch.read = nullptr;
+    }
+
+    if (wantWrite && !watch.write) {
+        watch.write = new QSocketNotifier(fd, QSocketNotifier::Write, this);
+        connect(watch.write, SIGNAL(activated(int)), this, SLOT(socketActivated(int)));
+    } else if (!wantWrite && watch.write) {
+        watch.write->setEnabled(false);
+        watch.write->deleteLater();
+        watch.write = nullptr;
+    }
+
+    if (!watch.read && !watch.write) {
+        watches.remove(fd);
+    }
+}
+
+
+void QtFetchLoop::releaseWatch(Watch& watch) {
+    for (QSocketNotifier* notifier : {watch.read, watch.write}) {
+        if (notifier) {
+            notifier->setEnabled(false);
+            notifier->deleteLater();
+        }
+    }
+    watch.read = nullptr;
+    watch.write = nullptr;
+}
+
+
+void QtFetchLoop::socketActivated(int fd) {
+    QSocketNotifier* notifier = qobject_cast<QSocketNotifier*>(sender());
+    if (!notifier || !fetchEngine) {
+        return;
+    }
+    int events = notifier->type() == QSocketNotifier::Read ? FETCH_EVENT_READ : FETCH_EVENT_WRITE;
+    fetch_engine_socket_action(fetchEngine, fd, events);
+}
+
+
+void QtFetchLoop::timerExpired() {
+    if (fetchEngine) {
+        fetch_engine_timeout(fetchEngine);
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef FETCH_QT_H
+#define FETCH_QT_H
+
+#include <QHash>
+#include <QObject>
+#include <QTimer>
+
+#include "../backend/fetch_engine.h"
+
+class QSocketNotifier;
+
+/**
+ * Integra o motor de requisições assíncronas (fetch_engine) ao laço de eventos do Qt.
+ * Os sockets da libcurl são observados com QSocketNotifier e o timeout dela com um QTimer,
+ * então as requisições avançam sem nenhuma thread bloqueada e os callbacks de conclusão
+ * executam na thread da interface.
+ */
+class QtFetchLoop : public QObject {
+    Q_OBJECT
+
+public:
+    explicit QtFetchLoop(QObject* parent = nullptr);
+    ~QtFetchLoop() override;
+
+    // Motor associado, para fetch_engine_get() ou get_worldtime_json_async()
+    fetch_engine* engine() const { return fetchEngine; }
+
+private slots:
+    void socketActivated(int fd);
+    void timerExpired();
+
+private:
+    struct Watch {
+        QSocketNotifier* read = nullptr;
+        QSocketNotifier* write = nullptr;
+    };
+
+    static void watchSocket(void* user, int fd, int events);
+    static void setTimer(void* user, long timeoutMs);
+
+    void updateWatch(int fd, int events);
+    void releaseWatch(Watch& watch);
+
+    fetch_engine* fetchEngine = nullptr;
+    QTimer timeoutTimer;
+    QHash<int, Watch> watches;
+};
+
+#endif
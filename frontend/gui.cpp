@@ -5,15 +5,26 @@
 #include <QThread>
 #include <QGroupBox>
 #include <QFont>
-#include <QRegularExpression>
-#include <QMediaPlayer>
-#include <QAudioOutput>
-#include <QUrl>
 #include <QPixmap>
-#include <QtConcurrent>
+#include <QResizeEvent>
+#include <cstring>
+#include <memory>
 
 #include "gui.h"
+#include "audio_qt.h"
+#include "fetch_qt.h"
+#include "image_cache.h"
+#include "scheduler_qt.h"
+#include "startup.h"
+#include "text_view.h"
+#include "../backend/worldtime.h"
 #include "../backend/backend.h"
+#include "../backend/trace.h"
+#include "../lib/lib_gentexts.h"
+
+// Períodos do relógio exibido e da troca de texto
+static const int64_t ELAPSED_PERIOD_NS = 1000000000LL;
+static const int64_t TEXT_PERIOD_NS = 10 * ELAPSED_PERIOD_NS;
 
 MainWindow::MainWindow(QWidget* parent) : QWidget(parent) {
     QVBoxLayout* mainLayout = new QVBoxLayout(this);
@@ -26,7 +37,7 @@ MainWindow::MainWindow(QWidget* parent) : QWidget(parent) {
     QGroupBox* jsonBox = new QGroupBox("Horário Atual (WorldTimeAPI)", this);
     QVBoxLayout* jsonLayout = new QVBoxLayout(jsonBox);
 
-    QLabel* jsonLabel = new QLabel("Horário não disponível", this);
+    QLabel* jsonLabel = new QLabel("Consultando a WorldTimeAPI...", this);
     jsonLabel->setWordWrap(true);
     jsonLabel->setFont(contentFont);
     jsonLayout->addWidget(jsonLabel);
@@ -35,10 +46,11 @@ MainWindow::MainWindow(QWidget* parent) : QWidget(parent) {
     QGroupBox* textBox = new QGroupBox("Texto Aleatório", this);
     QVBoxLayout* textLayout = new QVBoxLayout(textBox);
 
-    QLabel* textLabel = new QLabel("Gerando texto...", this);
-    textLabel->setWordWrap(true);
-    textLabel->setFont(contentFont);
-    textLayout->addWidget(textLabel);
+    // Layout do texto em segundo plano e só as linhas visíveis desenhadas: textos longos não travam a troca
+    textView = new TextView(this);
+    textView->setFont(contentFont);
+    textView->setText("Carregando textos...");
+    textLayout->addWidget(textView);
     mainLayout->addWidget(textBox);
 
     // Bloco para imagem
@@ -46,7 +58,7 @@ MainWindow::MainWindow(QWidget* parent) : QWidget(parent) {
 
     QVBoxLayout* imageLayout = new QVBoxLayout(imageBox);
 
-    QLabel* imageLabel = new QLabel(this);
+    imageLabel = new QLabel(this);
     imageLabel->setAlignment(Qt::AlignCenter);
     imageLabel->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
     imageLabel->setFixedHeight(120);
@@ -56,6 +68,7 @@ MainWindow::MainWindow(QWidget* parent) : QWidget(parent) {
     mainLayout->addWidget(imageBox);
 
     QLabel* elapsedLabel = new QLabel("Tempo decorrido: 0s", this);
+    elapsedLabel->setObjectName("elapsedLabel");
     elapsedLabel->setAlignment(Qt::AlignCenter);
     elapsedLabel->setFont(titleFont);
     mainLayout->addWidget(elapsedLabel);
@@ -77,103 +90,180 @@ MainWindow::MainWindow(QWidget* parent) : QWidget(parent) {
             font-weight: bold;
             color: #2c3e50;
         }
-        QLabel {
+        QLabel, TextView {
             color: #333;
         }
     )");
 
-    // Inicialização assíncrona: só abrir interface após resposta da API
-    this->hide();
+    // A janela aparece já com os textos provisórios; cada parte é preenchida quando sua tarefa termina.
+    // Corpus, API, imagem e som são preparados ao mesmo tempo (ver StartupOrchestrator)
+    startupTasks = new StartupOrchestrator(this);
+    startupTasks->watchFirstFrame(this);
+
+    // Relógio em prazos absolutos contados do início do backend (backend_init() em main): atrasos de um
+    // disparo não se acumulam. Ele anda desde já, sem esperar a rede nem o corpus
+    scheduler = new QtScheduler(this);
+    int64_t start = monotonic_now_ns() - get_elapsed_ns();
+    scheduler_add_periodic(scheduler->get(), start + ELAPSED_PERIOD_NS, ELAPSED_PERIOD_NS,
+                           [elapsedLabel, start](const scheduler_tick& tick) {
+        // Se o laço travou, mostra o último segundo vencido em vez de recuperar os perdidos um a um
+        int64_t latest = tick.deadline_ns + static_cast<int64_t>(tick.missed) * ELAPSED_PERIOD_NS;
+        int64_t elapsed = (latest - start) / 1000000000LL;
+        elapsedLabel->setText(QString("Tempo decorrido: %1s").arg(elapsed));
+    });
 
-    QtConcurrent::run([this, jsonLabel, elapsedLabel, textLabel, imageLabel]() {
+    // Corpus (dlopen do gerador e geração dos textos) fora da thread da interface
+    auto corpusCount = std::make_shared<size_t>(0);
+    startupTasks->run("corpus", [corpusCount]() {
+        *corpusCount = get_corpus_count();
+    }, [this, corpusCount, start]() {
+        if (*corpusCount == 0) {
+            textView->setText("Falha ao carregar os textos.");
+            return;
+        }
+        startTextRotation(start);
+    });
+
+    // Requisição assíncrona integrada ao laço do Qt: nenhuma thread fica bloqueada esperando a API,
+    // e a resposta chega diretamente na thread da interface
+    int worldtimePhase = startupTasks->begin("worldtime");
+    QtFetchLoop* fetchLoop = new QtFetchLoop(this);
+    get_worldtime_json_async(fetchLoop->engine(), [this, jsonLabel, worldtimePhase](char* json) {
+        if (json) {
+            size_t length = strlen(json);
+            jsonLabel->setText(QString::fromUtf8(json, static_cast<int>(length)));
+
+            // Análise estruturada em uma passada, sem cópia: os campos apontam para o próprio json
+            worldtime_info info;
+            worldtime_error error;
+            if (worldtime_parse(json, length, &info, &error)) {
+                QString title = QString::fromUtf8(info.timezone.data, static_cast<int>(info.timezone.length)) + ", " +
+                                QString::fromUtf8(info.datetime.data, static_cast<int>(info.datetime.length));
+                setWindowTitle(title);
+            } else {
+                qWarning("Resposta da WorldTimeAPI rejeitada: %s (%s, byte %zu)", worldtime_error_message(error.code),
+                         error.field ? error.field : "-", error.offset);
+                setWindowTitle("Desafio FPF Tech (dados inválidos)");
+            }
 
-        char* json = get_worldtime_json();
+            free(json);
+        } else {
+            jsonLabel->setText("Falha ao requisitar worldtimeapi.");
+            setWindowTitle("Desafio FPF Tech (erro na API)");
+        }
+        startupTasks->finish(worldtimePhase);
+    });
 
-        QMetaObject::invokeMethod(this, [=]() {
+    // Imagem decodificada uma única vez, em segundo plano; as versões no tamanho do bloco são
+    // preparadas a cada redimensionamento da janela (resizeEvent)
+    int imagePhase = startupTasks->begin("image");
+    imageCache = new ImageCache(this);
+    connect(imageCache, &ImageCache::loaded, this, [this, imagePhase]() {
+        startupTasks->finish(imagePhase);
+    });
+    imageCache->load("image", "frontend/assets/image.jpg");
+
+    // Som da troca de texto decodificado para a memória em segundo plano, enquanto a saída de áudio
+    // é aberta na thread de áudio
+    int audioPhase = startupTasks->begin("audio");
+    int audioOutputPhase = startupTasks->begin("audio_output");
+    audioCues = new QtAudioCues(this);
+    connect(audioCues, &QtAudioCues::cueLoaded, this, [this, audioPhase]() {
+        startupTasks->finish(audioPhase);
+    });
+    connect(audioCues, &QtAudioCues::cueFailed, this, [this, audioPhase]() {
+        startupTasks->finish(audioPhase);
+    });
+    connect(audioCues, &QtAudioCues::outputStarted, this, [this, audioOutputPhase]() {
+        startupTasks->finish(audioOutputPhase);
+    });
+    // A abertura pode ter terminado (ou falhado) antes da conexão acima
+    if (!audioCues->outputStarting()) {
+        startupTasks->finish(audioOutputPhase);
+    }
+    if (!audioCues->load("tick", "/app/frontend/assets/sound.wav")) {
+        startupTasks->finish(audioPhase);
+    }
+
+    startupTasks->seal();
+}
 
-            if (json) {
-                QString jsonStr(json);
-                jsonLabel->setText(jsonStr);
 
-                QString timezone, datetime;
-                QRegularExpression tzRegex(QStringLiteral("\"timezone\"\\s*:\\s*\"([^\"]+)\""));
-                QRegularExpression dtRegex(QStringLiteral("\"datetime\"\\s*:\\s*\"([^\"]+)\""));
-                QRegularExpressionMatch tzMatch = tzRegex.match(jsonStr);
-                QRegularExpressionMatch dtMatch = dtRegex.match(jsonStr);
+/**
+ * Primeiro texto assim que o corpus fica pronto; as trocas seguintes caem nos múltiplos de 10 s
+ * do relógio exibido.
+ */
+void MainWindow::startTextRotation(int64_t start) {
+    updateText();
+
+    int64_t now = monotonic_now_ns();
+    int64_t next = start + TEXT_PERIOD_NS;
+    if (next <= now) {
+        next += ((now - next) / TEXT_PERIOD_NS + 1) * TEXT_PERIOD_NS;
+    }
+    scheduler_add_periodic(scheduler->get(), next, TEXT_PERIOD_NS, [this](const scheduler_tick&) {
+        updateText();
+    });
+}
 
-                if (tzMatch.hasMatch() && dtMatch.hasMatch()) {
-                    timezone = tzMatch.captured(1);
-                    datetime = dtMatch.captured(1);
-                    QString title = timezone + ", " + datetime;
-                    setWindowTitle(title);
-                } else {
-                    setWindowTitle("Desafio FPF Tech (dados inválidos)");
-                }
 
-                free(json);
-            } else {
-                jsonLabel->setText("Falha ao requisitar worldtimeapi.");
-                setWindowTitle("Desafio FPF Tech (erro na API)");
+/**
+ * Troca o texto exibido por um novo sorteio, toca o som e mostra a imagem por um segundo.
+ */
+void MainWindow::updateText() {
+    TRACE_SCOPE("updateText");
+    {
+        TRACE_SCOPE("updateText/text");
+        // Visão emprestada do corpus: sem cópia intermediária nem free.
+        // A seção de leitura mantém o corpus vivo até o texto ser copiado para a visão.
+        corpus_read_guard guard;
+        text_view new_text;
+        if (get_random_text_view(&new_text)) {
+            textView->setText(QString::fromUtf8(new_text.data, static_cast<int>(new_text.length)));
+        } else {
+            // Corpus compactado: decodifica o texto em um buffer local
+            char buffer[GENTEXTS_MAX_TEXT_BYTES + 1];
+            size_t length = get_random_text_into(buffer, sizeof(buffer));
+            if (length > 0) {
+                textView->setText(QString::fromUtf8(buffer, static_cast<int>(length)));
             }
+        }
+    }
+
+    TRACE_SCOPE("updateText/media");
+    // Só enfileira o disparo: o som toca inteiro, sobreposto a um anterior se ainda estiver tocando
+    audioCues->play("tick");
+
+    // Só troca por uma versão já preparada: sem disco, decodificação nem redimensionamento aqui
+    QPixmap pixmap = imageCache->pixmap("image", imageTargetSize());
+    if (!pixmap.isNull()) {
+        imageLabel->setPixmap(pixmap);
+        imageLabel->setVisible(true);
+        QTimer::singleShot(1000, this, [this]() {
+            imageLabel->clear();
+            imageLabel->setVisible(false);
+        });
+    }
+}
 
-            this->show();
-
-            // Inicializa o timer ANTES da primeira escolha de string aleatória
-            backend_init();
-
-
-            // Função para atualizar texto, som e imagem
-            auto updateText = [textLabel, imageLabel, this]() {
-                char* new_text = get_random_text();
-                if (new_text) {
-                    textLabel->setText(new_text);
-                    free(new_text);
-                }
-
-                static QMediaPlayer* player = nullptr;
-                if (!player) {
-                    player = new QMediaPlayer(this);
-                    player->setMedia(QUrl::fromLocalFile("/app/frontend/assets/sound.wav"));
-                }
-
-                player->stop();
-                player->play();
-                player->setVolume(100);
-                QTimer::singleShot(1000, this, [player]() { player->stop(); });
-
-                QPixmap pixmap("frontend/assets/image.jpg");
-                if (!pixmap.isNull()) {
-                    int maxWidth = imageLabel->parentWidget()->width() - 40;
-                    QPixmap scaledPixmap = pixmap.scaled(maxWidth, imageLabel->height(), Qt::KeepAspectRatio, Qt::SmoothTransformation);
-                    imageLabel->setPixmap(scaledPixmap);
-                    imageLabel->setVisible(true);
-                    QTimer::singleShot(1000, this, [imageLabel]() {
-                        imageLabel->clear();
-                        imageLabel->setVisible(false);
-                    });
-                }
-            };
-
-            // Atualiza texto na inicialização
-            updateText();
-
-            // Timer único para relógio e troca de texto sincronizada
-            QTimer* elapsedTimer = new QTimer(this);
-            int lastTextUpdate = -1;
-            connect(elapsedTimer, &QTimer::timeout, [elapsedLabel, updateText, &lastTextUpdate]() mutable {
-                double elapsed = get_elapsed_seconds();
-                elapsedLabel->setText(QString("Tempo decorrido: %1s").arg((int)elapsed));
-                int elapsedInt = static_cast<int>(elapsed);
-                if (elapsedInt % 10 == 0 && elapsedInt != lastTextUpdate) {
-                    updateText();
-                    lastTextUpdate = elapsedInt;
-                }
-            });
-            elapsedTimer->start(1000);
 
-        });
 
-    });
+/**
+ * Tamanho em que a imagem é exibida: a largura do bloco (menos a margem) e a altura fixa do label.
+ */
+QSize MainWindow::imageTargetSize() const {
+    return QSize(imageLabel->parentWidget()->width() - 40, imageLabel->height());
+}
+
+
+/**
+ * Pede ao cache a versão da imagem no novo tamanho; ela é preparada fora da thread da interface.
+ */
+void MainWindow::resizeEvent(QResizeEvent* event) {
+    QWidget::resizeEvent(event);
+    if (imageCache) {
+        imageCache->prepare("image", imageTargetSize());
+    }
 }
 
 
@@ -184,44 +274,51 @@ MainWindow::MainWindow(QWidget* parent) : QWidget(parent) {
 
 - QGroupBox : Widget de agrupamento com título. Usado para separar visualmente seções: JSON, texto, imagem.
 
-- QLabel : Widget para exibir texto ou imagem. Usado para mostrar o JSON, texto aleatório, tempo decorrido e imagem.
+- QLabel : Widget para exibir texto ou imagem. Usado para mostrar o JSON, tempo decorrido e imagem.
+
+- TextView : Exibe o texto aleatório. Quebra as linhas (QTextLayout) em uma thread de trabalho, guarda o layout por largura e desenha só as linhas visíveis, com rolagem para textos longos.
 
 - QFont : Define fonte usada nos títulos e conteúdos.
 
-- QRegularExpression / QRegularExpressionMatch : Usados para extrair campos do JSON retornado pela API (timezone, datetime).
+- worldtime_parse() : Função do backend que interpreta o JSON retornado pela API (timezone, datetime, unixtime, utc_offset, dst...) sem cópia, rejeitando respostas inválidas.
+
+- QtAudioCues : Reproduz o som (wav) ao trocar texto. O arquivo é decodificado uma vez para PCM e tocado por uma saída de áudio sempre aberta, em thread própria.
+
+- QPixmap : Exibe a imagem ao trocar texto, já no tamanho do widget.
 
-- QMediaPlayer : Reproduz áudio (wav) ao trocar texto. Instanciado uma vez, reutilizado a cada troca.
+- ImageCache : Decodifica a imagem uma vez e prepara as versões redimensionadas em uma thread de trabalho (QtConcurrent); updateText só troca o QPixmap pronto.
 
-- QPixmap : Carrega e exibe imagem ao trocar texto. Escala imagem para caber no widget.
+- QtScheduler : Agendador por prazos absolutos (scheduler.h) sobre um único QTimer de precisão. Atualiza o relógio a cada segundo e troca o texto a cada 10 segundos, sem deriva.
 
-- QTimer : Timer para atualizar relógio e sincronizar troca de texto a cada 10 segundos. Executa função de atualização a cada segundo.
+- StartupOrchestrator : Executa as tarefas da inicialização (corpus, API, imagem, som) ao mesmo tempo, com a janela já visível, e informa o tempo de cada fase e do primeiro quadro.
 
-- QtConcurrent::run : Executa chamada à API e inicialização do backend em thread separada, evitando travar a interface.
+- QtFetchLoop : Integra o motor assíncrono do backend (curl_multi) ao laço do Qt com QSocketNotifier e QTimer. A chamada à API não bloqueia nenhuma thread e a resposta chega na thread principal do Qt.
 
-- QMetaObject::invokeMethod : Garante que atualizações visuais ocorram na thread principal do Qt.
+- get_corpus_count() : Função do backend que carrega o gerador e o conjunto de textos aleatórios (chamada em uma thread de trabalho).
 
-- backend_init() : Função do backend que inicializa o conjunto de textos aleatórios.
+- get_worldtime_json_async() : Função do backend que requisita o JSON da API WorldTime sem bloquear e o entrega a um callback.
 
-- get_worldtime_json() : Função do backend que retorna JSON da API WorldTime.
+- get_random_text_view() : Função do backend que retorna uma visão (sem cópia) de um texto aleatório do conjunto gerado.
 
-- get_random_text() : Função do backend que retorna um texto aleatório do conjunto gerado.
+- get_random_text_into() : Função do backend que decodifica um texto aleatório em um buffer (usada com o corpus compactado).
 
-- get_elapsed_seconds() : Função do backend que retorna o tempo decorrido desde inicialização.
+- get_elapsed_ns() : Função do backend que retorna o tempo decorrido desde inicialização (backend_init(), em main).
 
 ================================================================================
 Fluxo geral:
-1. Interface é criada, mas fica oculta até obter resposta da API.
-2. Chama backend para obter JSON da WorldTimeAPI (thread separada).
-3. Atualiza título e label com dados do JSON.
-4. Inicializa backend (gera textos aleatórios).
-5. Atualiza texto, som e imagem na interface.
-6. Timer atualiza relógio e troca texto a cada 10 segundos, sincronizado com uptime.
+1. Interface é criada e exibida imediatamente, com textos provisórios; o relógio já começa a andar.
+2. Ao mesmo tempo: corpus carregado em uma thread de trabalho, JSON da WorldTimeAPI requisitado (assíncrono, no laço de eventos do Qt), imagem e som decodificados em segundo plano e saída de áudio aberta na thread de áudio.
+3. Cada bloco é preenchido quando sua tarefa termina: título e label com dados do JSON; primeiro texto quando o corpus fica pronto.
+4. Agendador troca texto, som e imagem a cada 10 segundos, em prazos contados do início do backend.
+5. Ao fim de todas as tarefas, os tempos de cada fase são informados no log.
 
 ================================================================================
 Parâmetros principais:
 - parent (QWidget*): Widget pai, padrão do Qt.
-- textLabel, jsonLabel, imageLabel, elapsedLabel: Labels para exibir dados.
-- updateText: Função lambda para atualizar texto, som e imagem.
-- elapsedTimer: Timer para atualizar relógio e sincronizar troca de texto.
+- jsonLabel, imageLabel, elapsedLabel: Labels para exibir dados.
+- textView: Visão do texto aleatório.
+- updateText(): Método de MainWindow que troca o texto, o som e a imagem (chamado pelo agendador e na primeira exibição do corpus).
+- scheduler: Agendador das tarefas periódicas de relógio e troca de texto.
+- startupTasks: Orquestrador das tarefas de inicialização.
 ================================================================================
 */
@@ -1,11 +1,41 @@
 #ifndef GUI_H
 #define GUI_H
 
+#include <cstdint>
+
 #include <QWidget>
 
+class ImageCache;
+class QLabel;
+class QResizeEvent;
+class QtAudioCues;
+class QtScheduler;
+class StartupOrchestrator;
+class TextView;
+
 class MainWindow : public QWidget {
 public:
     MainWindow(QWidget* parent = nullptr);
+
+    // Troca o texto (e toca o som e mostra a imagem); chamado pelo timer e pelos benchmarks
+    void updateText();
+
+    // Fases da inicialização (corpus, API, imagem, som, primeiro quadro) e seus tempos
+    const StartupOrchestrator* startup() const { return startupTasks; }
+
+protected:
+    void resizeEvent(QResizeEvent* event) override;
+
+private:
+    QSize imageTargetSize() const;
+    void startTextRotation(int64_t start);
+
+    TextView* textView = nullptr;
+    QLabel* imageLabel = nullptr;
+    QtAudioCues* audioCues = nullptr;
+    ImageCache* imageCache = nullptr;
+    QtScheduler* scheduler = nullptr;
+    StartupOrchestrator* startupTasks = nullptr;
 };
 
 #endif
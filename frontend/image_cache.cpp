@@ -0,0 +1,155 @@
+#include <QImageReader>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include "image_cache.h"
+
+// Versões guardadas por imagem (tamanhos recentes da janela); a mais antiga é descartada
+static const int IMAGE_CACHE_MAX_VARIANTS = 4;
+
+ImageCache::ImageCache(QObject* parent) : QObject(parent) {
+    connect(&watcher, SIGNAL(finished()), this, SLOT(jobFinished()));
+}
+
+
+ImageCache::~ImageCache() {
+    // O trabalho em andamento só usa cópias das imagens, mas não deve sobreviver ao cache
+    queue.clear();
+    watcher.waitForFinished();
+}
+
+
+void ImageCache::load(const QString& key, const QString& path) {
+    Asset& asset = assets[key];
+    asset.generation++;
+    asset.path = path;
+    asset.source = QImage();
+    asset.variants.clear();
+
+    Job job;
+    job.key = key;
+    job.generation = asset.generation;
+    job.path = path;
+    queue.append(job);
+    startNext();
+}
+
+
+void ImageCache::prepare(const QString& key, const QSize& size) {
+    auto it = assets.find(key);
+    if (it == assets.end() || size.isEmpty()) {
+        return;
+    }
+    Asset& asset = it.value();
+    asset.wanted = size;
+    for (const Variant& variant : asset.variants) {
+        if (variant.size == size) {
+            return;
+        }
+    }
+    // Um pedido já na fila usa o tamanho mais recente quando começar
+    if (!asset.queued) {
+        asset.queued = true;
+        Job job;
+        job.key = key;
+        queue.append(job);
+        startNext();
+    }
+}
+
+
+QPixmap ImageCache::pixmap(const QString& key, const QSize& size) const {
+    auto it = assets.constFind(key);
+    if (it == assets.constEnd() || it->variants.isEmpty()) {
+        return QPixmap();
+    }
+    for (const Variant& variant : it->variants) {
+        if (variant.size == size) {
+            return variant.pixmap;
+        }
+    }
+    // Um tamanho um pouco diferente é melhor que travar a interface redimensionando aqui
+    return it->variants.last().pixmap;
+}
+
+
+/**
+ * Executado na thread de trabalho: decodifica o arquivo ou redimensiona a imagem do job.
+ */
+ImageCache::Job ImageCache::runJob(Job job) {
+    if (!job.path.isEmpty()) {
+        QImageReader reader(job.path);
+        job.image = reader.read();
+        // Formato nativo de desenho do Qt: evita conversões ao redimensionar e ao exibir
+        if (!job.image.isNull()) {
+            job.image = job.image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+        }
+    } else {
+        job.image = job.image.scaled(job.size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+    return job;
+}
+
+
+/**
+ * Inicia o próximo job da fila, se a thread de trabalho estiver livre.
+ */
+void ImageCache::startNext() {
+    while (!watcher.isRunning() && !queue.isEmpty()) {
+        Job job = queue.takeFirst();
+        auto it = assets.find(job.key);
+        if (it == assets.end()) {
+            continue;
+        }
+        Asset& asset = it.value();
+
+        if (job.path.isEmpty()) {
+            // A decodificação ainda não terminou: o pedido é refeito quando ela terminar
+            if (asset.source.isNull()) {
+                continue;
+            }
+            asset.queued = false;
+            bool ready = false;
+            for (const Variant& variant : asset.variants) {
+                ready = ready || variant.size == asset.wanted;
+            }
+            if (ready) {
+                continue;
+            }
+            job.size = asset.wanted;
+            job.image = asset.source;
+            job.generation = asset.generation;
+        }
+        watcher.setFuture(QtConcurrent::run(&ImageCache::runJob, job));
+    }
+}
+
+
+/**
+ * Recebe o resultado na thread da interface. A conversão para QPixmap acontece aqui, uma vez por versão,
+ * e não a cada exibição. Resultados de uma imagem substituída por outro load() são descartados.
+ */
+void ImageCache::jobFinished() {
+    Job job = watcher.result();
+    auto it = assets.find(job.key);
+    if (it != assets.end() && it->generation == job.generation) {
+        Asset& asset = it.value();
+        if (!job.path.isEmpty()) {
+            if (job.image.isNull()) {
+                qWarning("Falha ao decodificar a imagem: %s", qPrintable(job.path));
+            }
+            asset.source = job.image;
+            if (!asset.source.isNull() && asset.wanted.isValid()) {
+                asset.queued = false;
+                prepare(job.key, asset.wanted);
+            }
+            emit loaded(job.key, !asset.source.isNull());
+        } else if (!job.image.isNull()) {
+            if (asset.variants.size() >= IMAGE_CACHE_MAX_VARIANTS) {
+                asset.variants.removeFirst();
+            }
+            asset.variants.append({job.size, QPixmap::fromImage(job.image)});
+            emit pixmapReady(job.key, job.size);
+        }
+    }
+    startNext();
+}
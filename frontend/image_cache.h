@@ -0,0 +1,79 @@
+#ifndef IMAGE_CACHE_H
+#define IMAGE_CACHE_H
+
+#include <QFutureWatcher>
+#include <QHash>
+#include <QImage>
+#include <QList>
+#include <QObject>
+#include <QPixmap>
+#include <QSize>
+#include <QString>
+#include <QVector>
+
+/**
+ * Cache das imagens exibidas pela interface. Cada arquivo é decodificado uma única vez e mantido em
+ * memória; as versões redimensionadas (por tamanho de destino) são preparadas em uma thread de trabalho
+ * e guardadas prontas, de modo que a thread da interface só troca o QPixmap exibido, sem leitura
+ * de disco, decodificação ou redimensionamento.
+ *
+ * Pedidos para a mesma imagem são agrupados: durante um redimensionamento da janela, apenas o tamanho
+ * mais recente é preparado quando a thread fica livre.
+ */
+class ImageCache : public QObject {
+    Q_OBJECT
+
+public:
+    explicit ImageCache(QObject* parent = nullptr);
+    ~ImageCache() override;
+
+    // Registra uma imagem e agenda sua decodificação em segundo plano
+    void load(const QString& key, const QString& path);
+
+    // Agenda a preparação da imagem no tamanho (mantendo a proporção); não faz nada se já estiver pronta
+    void prepare(const QString& key, const QSize& size);
+
+    // Versão pronta no tamanho pedido; sem ela, a preparada mais recentemente (ou nula, se nenhuma)
+    QPixmap pixmap(const QString& key, const QSize& size) const;
+
+signals:
+    // Fim da decodificação de um arquivo registrado com load()
+    void loaded(const QString& key, bool ok);
+    void pixmapReady(const QString& key, const QSize& size);
+
+private slots:
+    void jobFinished();
+
+private:
+    struct Job {
+        QString key;
+        quint64 generation = 0; // Asset::generation no início: resultados de um load() anterior são descartados
+        QString path;           // Decodificação (vazio: redimensionamento)
+        QSize size;
+        QImage image;           // Entrada (redimensionamento) e resultado
+    };
+
+    struct Variant {
+        QSize size;
+        QPixmap pixmap;
+    };
+
+    struct Asset {
+        quint64 generation = 0; // Muda a cada load()
+        QString path;
+        QImage source;
+        QSize wanted;           // Tamanho mais recente pedido por prepare()
+        bool queued = false;    // Há um redimensionamento na fila ou em execução
+        QVector<Variant> variants;
+    };
+
+    static Job runJob(Job job);
+
+    void startNext();
+
+    QHash<QString, Asset> assets;
+    QList<Job> queue;
+    QFutureWatcher<Job> watcher;
+};
+
+#endif
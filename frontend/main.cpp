@@ -1,15 +1,67 @@
 #include <QApplication>
+#include <QThreadPool>
+#include <cstdlib>
 #include "gui.h"
+#include "startup.h"
 #include "../backend/backend.h"
+#include "../backend/trace.h"
+#include "../backend/metrics.h"
 
 int main(int argc, char *argv[]) {
+    // Referência dos tempos de inicialização informados pela janela (inclui a criação do QApplication)
+    StartupOrchestrator::markProcessStart();
     QApplication app(argc, argv);
 
+    // Rastreamento dos caminhos quentes, gravado em formato Chrome/Perfetto ao fechar
+    const char* trace_file = getenv("GENTEXTS_TRACE");
+    if (trace_file) {
+        trace_set_thread_name("gui");
+        trace_enable(true);
+    }
+
     backend_init();
 
-    MainWindow window;
-    window.resize(550, 350);
-    window.show();
-    
-    return app.exec();
+    // Métricas no formato do Prometheus: atendidas em um socket Unix durante a execução e/ou gravadas
+    // em arquivo ao encerrar
+    const char* metrics_socket = getenv("GENTEXTS_METRICS_SOCKET");
+    if (metrics_socket) {
+        metrics_serve_start(metrics_socket);
+    }
+
+    // Corpus pré-gerado (corpus_build): mapeado sob demanda, sem gerar os textos na inicialização
+    if (const char* corpus_file = getenv("GENTEXTS_CORPUS_FILE")) {
+        backend_configure_corpus_file(corpus_file);
+    }
+
+    // Corpus compactado em 5 bits por caractere: menos memória, com decodificação a cada sorteio
+    if (const char* packed = getenv("GENTEXTS_CORPUS_PACKED")) {
+        backend_configure_corpus_packing(packed[0] == '1');
+    }
+
+    int result;
+    {
+        MainWindow window;
+        window.resize(550, 350);
+        window.show();
+
+        result = app.exec();
+    }
+    // A janela é destruída antes: seu destrutor espera as tarefas de inicialização (ainda carregando o
+    // corpus, se a janela foi fechada cedo) e encerra o áudio e as requisições que usam o backend
+    QThreadPool::globalInstance()->waitForDone();
+
+    // Libera o corpus e a biblioteca dinâmica ao fechar a interface
+    backend_cleanup();
+    if (metrics_socket) {
+        metrics_serve_stop();
+    }
+    if (const char* metrics_file = getenv("GENTEXTS_METRICS_FILE")) {
+        metrics_write_file(metrics_file);
+    }
+
+    if (trace_file) {
+        trace_enable(false);
+        trace_export_chrome(trace_file);
+    }
+    return result;
 }
@@ -0,0 +1,35 @@
+#include "scheduler_qt.h"
+
+QtScheduler::QtScheduler(QObject* parent) : QObject(parent) {
+    deadlineTimer.setSingleShot(true);
+    // O timer padrão (CoarseTimer) pode atrasar até 5% do intervalo; os prazos já são agrupados pelo agendador
+    deadlineTimer.setTimerType(Qt::PreciseTimer);
+    connect(&deadlineTimer, SIGNAL(timeout()), this, SLOT(timerExpired()));
+
+    scheduler_loop_ops ops{this, &QtScheduler::setTimer};
+    sched = scheduler_create(&ops);
+}
+
+
+QtScheduler::~QtScheduler() {
+    scheduler_destroy(sched);
+    sched = nullptr;
+}
+
+
+void QtScheduler::setTimer(void* user, int64_t deadlineNs) {
+    QtScheduler* loop = static_cast<QtScheduler*>(user);
+    if (deadlineNs < 0) {
+        loop->deadlineTimer.stop();
+        return;
+    }
+    // O QTimer só aceita intervalos relativos em ms: arredonda para cima para não acordar antes do prazo
+    int64_t delayNs = deadlineNs - monotonic_now_ns();
+    int64_t delayMs = delayNs > 0 ? (delayNs + 999999) / 1000000 : 0;
+    loop->deadlineTimer.start(static_cast<int>(delayMs));
+}
+
+
+void QtScheduler::timerExpired() {
+    scheduler_run_due(sched);
+}
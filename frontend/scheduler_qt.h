@@ -0,0 +1,34 @@
+#ifndef SCHEDULER_QT_H
+#define SCHEDULER_QT_H
+
+#include <QObject>
+#include <QTimer>
+
+#include "../backend/scheduler.h"
+
+/**
+ * Integra o agendador por prazos (scheduler.h) ao laço de eventos do Qt.
+ * Um único QTimer de precisão é armado para o prazo mais próximo entre todas as tarefas,
+ * e os callbacks executam na thread da interface.
+ */
+class QtScheduler : public QObject {
+    Q_OBJECT
+
+public:
+    explicit QtScheduler(QObject* parent = nullptr);
+    ~QtScheduler() override;
+
+    // Agendador associado, para scheduler_add_periodic() e scheduler_add_oneshot()
+    scheduler* get() const { return sched; }
+
+private slots:
+    void timerExpired();
+
+private:
+    static void setTimer(void* user, int64_t deadlineNs);
+
+    scheduler* sched = nullptr;
+    QTimer deadlineTimer;
+};
+
+#endif
@@ -0,0 +1,115 @@
+#include <QEvent>
+#include <QFutureWatcher>
+#include <QString>
+#include <QStringList>
+#include <QWidget>
+#include <QtConcurrent>
+
+#include "startup.h"
+#include "../backend/scheduler.h"
+#include "../backend/trace.h"
+
+// Tarefas de inicialização simultâneas: elas passam boa parte do tempo em disco, dlopen e dispositivos,
+// então não são limitadas ao número de processadores como o pool global do Qt
+static const int STARTUP_MAX_THREADS = 4;
+
+static int64_t process_start_ns = -1;
+
+
+void StartupOrchestrator::markProcessStart() {
+    process_start_ns = monotonic_now_ns();
+}
+
+
+StartupOrchestrator::StartupOrchestrator(QObject* parent) : QObject(parent) {
+    if (process_start_ns < 0) {
+        markProcessStart();
+    }
+    pool.setMaxThreadCount(STARTUP_MAX_THREADS);
+}
+
+
+StartupOrchestrator::~StartupOrchestrator() {
+    // As tarefas capturam o estado da janela: terminam antes dela ser destruída
+    pool.waitForDone();
+}
+
+
+void StartupOrchestrator::run(const char* name, std::function<void()> work, std::function<void()> onDone) {
+    int phase = begin(name);
+    QFutureWatcher<void>* watcher = new QFutureWatcher<void>(this);
+    connect(watcher, &QFutureWatcher<void>::finished, this, [this, watcher, phase, onDone]() {
+        if (onDone) {
+            onDone();
+        }
+        finish(phase);
+        watcher->deleteLater();
+    });
+    watcher->setFuture(QtConcurrent::run(&pool, [name, work]() {
+        trace_set_thread_name("startup");
+        TRACE_SCOPE(name);
+        work();
+    }));
+}
+
+
+int StartupOrchestrator::begin(const char* name) {
+    phaseList.append({name, monotonic_now_ns() - process_start_ns, -1});
+    pending++;
+    return phaseList.size() - 1;
+}
+
+
+void StartupOrchestrator::finish(int phase) {
+    if (phase < 0 || phase >= phaseList.size() || phaseList[phase].endNs >= 0) {
+        return;
+    }
+    phaseList[phase].endNs = monotonic_now_ns() - process_start_ns;
+    pending--;
+    TRACE_INSTANT(phaseList[phase].name);
+    emit phaseFinished(phaseList[phase].name, phaseList[phase].endNs);
+    if (sealed && pending == 0 && !done) {
+        report();
+    }
+}
+
+
+void StartupOrchestrator::watchFirstFrame(QWidget* window) {
+    firstFramePhase = begin("first_frame");
+    window->installEventFilter(this);
+}
+
+
+void StartupOrchestrator::seal() {
+    sealed = true;
+    if (pending == 0 && !done) {
+        report();
+    }
+}
+
+
+/**
+ * O primeiro Paint da janela marca o primeiro quadro; o filtro é removido em seguida.
+ */
+bool StartupOrchestrator::eventFilter(QObject* watched, QEvent* event) {
+    if (event->type() == QEvent::Paint) {
+        watched->removeEventFilter(this);
+        finish(firstFramePhase);
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+
+void StartupOrchestrator::report() {
+    done = true;
+    QStringList parts;
+    for (const Phase& phase : phaseList) {
+        parts << QString("%1 %2 ms (%3 ms)")
+                     .arg(phase.name)
+                     .arg(phase.endNs / 1e6, 0, 'f', 1)
+                     .arg((phase.endNs - phase.startNs) / 1e6, 0, 'f', 1);
+    }
+    qInfo("Inicialização, fim de cada fase desde o início do processo (duração): %s", qPrintable(parts.join(", ")));
+    TRACE_INSTANT("startup_finished");
+    emit finished();
+}
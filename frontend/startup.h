@@ -0,0 +1,74 @@
+#ifndef STARTUP_H
+#define STARTUP_H
+
+#include <functional>
+
+#include <QObject>
+#include <QThreadPool>
+#include <QVector>
+
+class QEvent;
+class QWidget;
+
+/**
+ * Orquestra a inicialização da interface: a janela aparece imediatamente, com textos provisórios, e as
+ * tarefas lentas (corpus, requisição à API, decodificação da imagem e do som, abertura da saída de áudio)
+ * rodam ao mesmo tempo, cada uma preenchendo sua parte da janela ao terminar.
+ *
+ * Cada tarefa é uma fase com início e fim medidos em relação ao início do processo (markProcessStart()),
+ * assim como o primeiro quadro pintado da janela. Quando todas as fases terminam, os tempos são
+ * informados no log (qInfo) e finished() é emitido.
+ */
+class StartupOrchestrator : public QObject {
+    Q_OBJECT
+
+public:
+    struct Phase {
+        const char* name;       // Literal: também é o nome do evento no rastreamento
+        qint64 startNs;         // Relativos ao início do processo
+        qint64 endNs;           // -1 enquanto a fase não termina
+    };
+
+    explicit StartupOrchestrator(QObject* parent = nullptr);
+    ~StartupOrchestrator() override;
+
+    // Registra o início do processo (chamar no começo de main); sem ela, vale a criação do orquestrador
+    static void markProcessStart();
+
+    // Executa `work` em uma thread de trabalho; `onDone` roda em seguida na thread da interface
+    void run(const char* name, std::function<void()> work, std::function<void()> onDone = nullptr);
+
+    // Fase concluída por um evento externo (rede, sinal): retorna o identificador para finish()
+    int begin(const char* name);
+
+    // Conclui a fase (chamadas repetidas são ignoradas)
+    void finish(int phase);
+
+    // Mede o primeiro quadro pintado do widget como a fase "first_frame"
+    void watchFirstFrame(QWidget* window);
+
+    // Indica que todas as fases já foram registradas: finished() é emitido quando a última terminar
+    void seal();
+
+    bool isFinished() const { return done; }
+    const QVector<Phase>& phases() const { return phaseList; }
+
+signals:
+    void phaseFinished(const char* name, qint64 endNs);
+    void finished();
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
+private:
+    void report();
+
+    QThreadPool pool;
+    QVector<Phase> phaseList;
+    int pending = 0;
+    int firstFramePhase = -1;
+    bool sealed = false;
+    bool done = false;
+};
+
+#endif
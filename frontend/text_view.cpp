@@ -0,0 +1,269 @@
+#include <algorithm>
+
+#include <QEvent>
+#include <QFontMetrics>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QResizeEvent>
+#include <QScrollBar>
+#include <QStringList>
+#include <QStyle>
+#include <QTextLayout>
+#include <QTextOption>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QtMath>
+
+#include "text_view.h"
+#include "../backend/trace.h"
+
+// Layouts guardados do texto atual (larguras recentes da janela); o mais antigo é descartado
+static const int TEXT_VIEW_MAX_LAYOUTS = 4;
+
+// Espaço entre a borda e o texto, em pixels
+static const int TEXT_VIEW_MARGIN = 2;
+
+TextView::TextView(QWidget* parent) : QAbstractScrollArea(parent) {
+    setFrameShape(QFrame::NoFrame);
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+    connect(&watcher, SIGNAL(finished()), this, SLOT(jobFinished()));
+}
+
+
+TextView::~TextView() {
+    // O layout em andamento só usa cópias do texto e da fonte, mas não deve sobreviver à visão
+    wanted = false;
+    watcher.waitForFinished();
+}
+
+
+void TextView::setText(const QString& text) {
+    currentText = text;
+    generation++;
+    layouts.clear();
+    wanted = true;
+    startNext();
+}
+
+
+bool TextView::isLayoutReady() const {
+    return shown && shown->generation == generation && shown->width == layoutWidth();
+}
+
+
+QSize TextView::sizeHint() const {
+    QFontMetrics metrics(font());
+    return QSize(metrics.averageCharWidth() * 40, metrics.lineSpacing() * 6 + 2 * TEXT_VIEW_MARGIN);
+}
+
+
+QSize TextView::minimumSizeHint() const {
+    QFontMetrics metrics(font());
+    return QSize(metrics.averageCharWidth() * 10, metrics.lineSpacing() * 2 + 2 * TEXT_VIEW_MARGIN);
+}
+
+
+/**
+ * Largura das linhas. O espaço da barra de rolagem fica reservado mesmo com ela escondida, para que
+ * ela aparecer ou sumir não mude a quebra das linhas (e, com ela, a própria necessidade da barra).
+ */
+int TextView::layoutWidth() const {
+    int width = viewport()->width() - 2 * TEXT_VIEW_MARGIN;
+    if (!verticalScrollBar()->isVisibleTo(this)) {
+        width -= style()->pixelMetric(QStyle::PM_ScrollBarExtent, nullptr, this);
+    }
+    return qMax(1, width);
+}
+
+
+const QSharedPointer<TextView::Layout>* TextView::cachedLayout(int width) const {
+    for (const QSharedPointer<Layout>& layout : layouts) {
+        if (layout->width == width) {
+            return &layout;
+        }
+    }
+    return nullptr;
+}
+
+
+/**
+ * Desenha só as linhas que cruzam a área exposta, encontradas por busca binária: o custo não depende
+ * do tamanho do texto.
+ */
+void TextView::paintEvent(QPaintEvent* event) {
+    if (!shown) {
+        return;
+    }
+    TRACE_SCOPE("TextView::paint");
+    QPainter painter(viewport());
+    painter.setPen(palette().color(QPalette::WindowText));
+
+    qreal offset = TEXT_VIEW_MARGIN - verticalScrollBar()->value();
+    qreal top = event->rect().top() - offset;
+    qreal bottom = event->rect().bottom() + 1 - offset;
+    const QVector<Line>& lines = shown->lines;
+    auto line = std::partition_point(lines.begin(), lines.end(), [top](const Line& candidate) {
+        return candidate.bottom <= top;
+    });
+    for (; line != lines.end() && line->top < bottom; ++line) {
+        const Block& block = shown->blocks[line->block];
+        block.layout->lineAt(line->index).draw(&painter, QPointF(TEXT_VIEW_MARGIN, line->blockTop + offset));
+    }
+}
+
+
+/**
+ * Mantém o layout exibido até o da nova largura ficar pronto; se ela já foi usada, a troca é imediata.
+ */
+void TextView::resizeEvent(QResizeEvent* event) {
+    QAbstractScrollArea::resizeEvent(event);
+    if (!shown || shown->generation != generation || shown->width != layoutWidth()) {
+        wanted = true;
+        startNext();
+    }
+    updateScrollRange();
+}
+
+
+/**
+ * Outra fonte invalida todos os layouts do texto.
+ */
+void TextView::changeEvent(QEvent* event) {
+    QAbstractScrollArea::changeEvent(event);
+    if (event->type() == QEvent::FontChange) {
+        generation++;
+        layouts.clear();
+        wanted = true;
+        startNext();
+    }
+}
+
+
+/**
+ * Executado na thread de trabalho: divide o texto em parágrafos e quebra cada um em linhas na largura
+ * do job. Parágrafos de uma linha que cabem na nova largura vêm do layout anterior, sem nova formatação;
+ * como ele pode estar sendo desenhado, só os dados guardados no Block são lidos dele. Os demais são
+ * formatados do zero: manter o QTextLayout e repetir só a quebra de linhas não economiza nada, porque
+ * beginLayout() descarta os glifos já formatados.
+ */
+TextView::Job TextView::runJob(Job job) {
+    TRACE_SCOPE("TextView::layout");
+    QSharedPointer<Layout> layout(new Layout);
+    layout->generation = job.generation;
+    layout->width = job.width;
+
+    QTextOption option;
+    // Textos sem espaços (sequências aleatórias) também quebram, em vez de ultrapassar a largura
+    option.setWrapMode(QTextOption::WrapAtWordBoundaryOrAnywhere);
+
+    const QStringList paragraphs = job.text.split(QLatin1Char('\n'));
+    const Layout* reuse = job.reuse.data();
+    layout->blocks.reserve(paragraphs.size());
+    qreal top = 0;
+    for (int i = 0; i < paragraphs.size(); i++) {
+        Block block;
+        if (reuse && i < reuse->blocks.size() && reuse->blocks[i].lineCount == 1 &&
+            reuse->blocks[i].naturalWidth <= job.width) {
+            block = reuse->blocks[i];
+            layout->lines.append(Line{i, 0, top, top, top + block.height});
+        } else {
+            block.layout.reset(new QTextLayout(paragraphs[i], job.font));
+            block.layout->setTextOption(option);
+            block.layout->setCacheEnabled(true);
+            block.layout->beginLayout();
+            for (QTextLine line = block.layout->createLine(); line.isValid(); line = block.layout->createLine()) {
+                line.setLineWidth(job.width);
+                line.setPosition(QPointF(0, block.height));
+                layout->lines.append(Line{i, block.lineCount, top, top + block.height, top + block.height + line.height()});
+                block.height += line.height();
+                block.naturalWidth = qMax(block.naturalWidth, line.naturalTextWidth());
+                block.lineCount++;
+            }
+            block.layout->endLayout();
+        }
+        layout->blocks.append(block);
+        top += block.height;
+    }
+    layout->height = top;
+    job.result = layout;
+    job.reuse.reset();
+    return job;
+}
+
+
+/**
+ * Inicia o layout da largura atual, se a thread de trabalho estiver livre e ele ainda não existir.
+ */
+void TextView::startNext() {
+    if (!wanted || watcher.isRunning()) {
+        return;
+    }
+    wanted = false;
+    int width = layoutWidth();
+    if (const QSharedPointer<Layout>* cached = cachedLayout(width)) {
+        if (shown != *cached) {
+            display(*cached);
+            emit layoutReady(width);
+        }
+        return;
+    }
+
+    Job job;
+    job.generation = generation;
+    job.text = currentText;
+    job.font = font();
+    job.width = width;
+    if (!layouts.isEmpty()) {
+        job.reuse = layouts.last();
+    }
+    watcher.setFuture(QtConcurrent::run(&TextView::runJob, job));
+}
+
+
+/**
+ * Recebe o layout na thread da interface. Resultados de um texto ou fonte anteriores são descartados;
+ * um layout em outra largura (a janela mudou durante o job) é exibido se não houver outro do texto atual.
+ */
+void TextView::jobFinished() {
+    Job job = watcher.result();
+    if (job.generation == generation) {
+        if (layouts.size() >= TEXT_VIEW_MAX_LAYOUTS) {
+            layouts.removeFirst();
+        }
+        layouts.append(job.result);
+        bool current = job.width == layoutWidth();
+        if (current || !shown || shown->generation != generation) {
+            display(job.result);
+        }
+        if (current) {
+            emit layoutReady(job.width);
+        }
+    }
+    startNext();
+}
+
+
+/**
+ * Troca o layout exibido. No mesmo texto (outra largura), a rolagem mantém a posição relativa; um texto
+ * novo começa do topo.
+ */
+void TextView::display(const QSharedPointer<Layout>& layout) {
+    qreal position = 0;
+    if (shown && shown->generation == layout->generation && shown->height > 0) {
+        position = verticalScrollBar()->value() / shown->height;
+    }
+    shown = layout;
+    updateScrollRange();
+    verticalScrollBar()->setValue(qRound(position * layout->height));
+    viewport()->update();
+}
+
+
+void TextView::updateScrollRange() {
+    int height = viewport()->height();
+    int content = shown ? qCeil(shown->height) + 2 * TEXT_VIEW_MARGIN : 0;
+    verticalScrollBar()->setRange(0, qMax(0, content - height));
+    verticalScrollBar()->setPageStep(height);
+    verticalScrollBar()->setSingleStep(fontMetrics().lineSpacing());
+}
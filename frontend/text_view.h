@@ -0,0 +1,107 @@
+#ifndef TEXT_VIEW_H
+#define TEXT_VIEW_H
+
+#include <QAbstractScrollArea>
+#include <QFont>
+#include <QFutureWatcher>
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+
+class QEvent;
+class QPaintEvent;
+class QResizeEvent;
+class QTextLayout;
+
+/**
+ * Exibe um texto longo com quebra de linha, sem o custo do QLabel a cada troca: a formatação e a quebra
+ * das linhas (QTextLayout) são feitas em uma thread de trabalho, e a thread da interface só desenha as
+ * linhas visíveis, com rolagem vertical quando o texto não cabe.
+ *
+ * Os layouts prontos do texto atual ficam guardados por largura: voltar a uma largura já usada é
+ * imediato. Uma largura nova é um layout completo do texto, pois o QTextLayout refaz a formatação dos
+ * glifos a cada beginLayout(); só os parágrafos que cabiam inteiros em uma linha e continuam cabendo
+ * são reaproveitados, o que não se aplica a um texto de um único parágrafo longo, como os gerados.
+ * Enquanto isso o layout anterior continua sendo exibido. Pedidos seguidos (trocas de texto,
+ * redimensionamento) são agrupados: só o mais recente é preparado quando a thread fica livre.
+ */
+class TextView : public QAbstractScrollArea {
+    Q_OBJECT
+
+public:
+    explicit TextView(QWidget* parent = nullptr);
+    ~TextView() override;
+
+    // Troca o texto: o anterior continua visível até o layout do novo ficar pronto, que volta ao topo
+    void setText(const QString& text);
+    const QString& text() const { return currentText; }
+
+    // O layout exibido é o do texto atual na largura atual
+    bool isLayoutReady() const;
+
+    QSize sizeHint() const override;
+    QSize minimumSizeHint() const override;
+
+signals:
+    // Layout do texto atual pronto e exibido na largura `width`
+    void layoutReady(int width);
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+    void changeEvent(QEvent* event) override;
+
+private slots:
+    void jobFinished();
+
+private:
+    // Parágrafo formatado; compartilhado entre os layouts de larguras em que ele cabe em uma linha
+    struct Block {
+        QSharedPointer<QTextLayout> layout;
+        qreal naturalWidth = 0;         // Largura da linha mais longa
+        qreal height = 0;
+        int lineCount = 0;
+    };
+
+    struct Line {
+        int block;
+        int index;                      // Linha dentro do bloco
+        qreal blockTop;                 // Topo do bloco no texto (as linhas são posicionadas relativas a ele)
+        qreal top;                      // Topo e base da linha no texto
+        qreal bottom;
+    };
+
+    struct Layout {
+        quint64 generation = 0;
+        int width = 0;
+        QVector<Block> blocks;
+        QVector<Line> lines;            // Ordenadas por posição: a busca das visíveis é binária
+        qreal height = 0;
+    };
+
+    struct Job {
+        quint64 generation = 0;
+        QString text;
+        QFont font;
+        int width = 0;
+        QSharedPointer<const Layout> reuse;     // Layout do mesmo texto em outra largura
+        QSharedPointer<Layout> result;
+    };
+
+    static Job runJob(Job job);
+
+    int layoutWidth() const;
+    const QSharedPointer<Layout>* cachedLayout(int width) const;
+    void display(const QSharedPointer<Layout>& layout);
+    void updateScrollRange();
+    void startNext();
+
+    QString currentText;
+    quint64 generation = 0;             // Muda a cada texto ou fonte: resultados de gerações antigas são descartados
+    QVector<QSharedPointer<Layout>> layouts;    // Do texto atual, em larguras recentes
+    QSharedPointer<Layout> shown;
+    bool wanted = false;                // Falta o layout da largura atual
+    QFutureWatcher<Job> watcher;
+};
+
+#endif
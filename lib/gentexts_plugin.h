@@ -0,0 +1,60 @@
+#ifndef GENTEXTS_PLUGIN_H
+#define GENTEXTS_PLUGIN_H
+
+#include <stdint.h>
+
+#include "lib_gentexts.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * ABI dos geradores de texto carregados como plugin pelo backend.
+ *
+ * Cada biblioteca geradora exporta a função gentexts_plugin_query(), que retorna uma
+ * descrição estática com a versão do ABI, as capacidades e os pontos de entrada disponíveis.
+ * Campos novos só são adicionados ao final da estrutura; struct_size permite ao backend
+ * saber quais campos o plugin conhece. Mudanças incompatíveis incrementam GENTEXTS_PLUGIN_ABI_VERSION.
+ */
+#define GENTEXTS_PLUGIN_ABI_VERSION 1
+
+// Capacidades anunciadas pelo plugin (cada uma garante os ponteiros correspondentes não nulos)
+#define GENTEXTS_CAP_LIST      0x01u   // generate_list
+#define GENTEXTS_CAP_CORPUS    0x02u   // generate_corpus e free_corpus (obrigatória)
+#define GENTEXTS_CAP_PARALLEL  0x04u   // generate_corpus_parallel
+#define GENTEXTS_CAP_STREAM    0x08u   // stream_open, stream_next e stream_close
+#define GENTEXTS_CAP_SEED      0x10u   // seed
+
+typedef struct gentexts_plugin_api {
+    uint32_t abi_version;       // GENTEXTS_PLUGIN_ABI_VERSION com que o plugin foi compilado
+    uint32_t struct_size;       // sizeof(gentexts_plugin_api) do plugin
+    const char *name;           // Nome único do gerador (chave no registro)
+    const char *version;        // Versão do gerador, apenas informativa
+    uint32_t capabilities;      // Combinação de GENTEXTS_CAP_*
+
+    char ** (*generate_list)(int *num_texts);
+    text_corpus * (*generate_corpus)(int num_texts);
+    text_corpus * (*generate_corpus_parallel)(int num_texts, uint64_t seed, int num_threads);
+    void (*free_corpus)(text_corpus *corpus);
+    void (*seed)(uint64_t seed);
+    gentexts_stream * (*stream_open)(uint64_t num_texts, uint64_t seed);
+    size_t (*stream_next)(gentexts_stream *stream, char *buffer, size_t capacity,
+                          uint32_t *lengths, size_t max_texts);
+    void (*stream_close)(gentexts_stream *stream);
+} gentexts_plugin_api;
+
+// Assinatura e nome do símbolo exportado por cada plugin
+typedef const gentexts_plugin_api * (*gentexts_plugin_query_fn)(void);
+#define GENTEXTS_PLUGIN_QUERY_SYMBOL "gentexts_plugin_query"
+
+/**
+ * Descrição do gerador padrão da libgentexts.
+ */
+const gentexts_plugin_api * gentexts_plugin_query (void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -3,8 +3,13 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <pthread.h>
+#include <unistd.h>
 
 #include "lib_gentexts.h"
+#include "gentexts_plugin.h"
+#include "lib_prng.h"
+#include "lib_textkernel.h"
 
 // Macros que definem limites para geração de textos e strings
 // MAX_STRINGS e MIN_STRINGS: quantidade máxima e mínima de strings em um texto
@@ -20,89 +25,624 @@
 #define MIN_TEXTS 5
 
 
+// Estado do gerador pseudoaleatório, independente para cada thread
+static _Thread_local prng_state thread_rng;
+static _Thread_local int thread_rng_seeded = 0;
+
+
 /**
- * Gera um número aleatório entre min e max (inclusive).
- * Utiliza a função rand() da biblioteca padrão, que deve ser inicializada com srand() externamente.
+ * Define a semente do gerador da thread chamadora.
+ * Com a mesma semente, a mesma sequência de chamadas produz exatamente o mesmo corpus.
  *
- * @param min Valor mínimo
- * @param max Valor máximo
- * @return Número aleatório entre min e max
+ * @param seed Semente de 64 bits
  */
-int random_number(int min, int max) {
-    int number;
-    number = min + rand() % (max - min + 1);
-    return number;
+void gentexts_seed(uint64_t seed) {
+    prng_seed(&thread_rng, seed);
+    thread_rng_seeded = 1;
 }
 
 
 /**
- * Gera uma string aleatória composta apenas por letras minúsculas.
- * O tamanho da string é definido aleatoriamente entre MIN_CHARS e MAX_CHARS.
+ * Retorna o gerador da thread chamadora, inicializando-o se necessário.
+ * Se gentexts_seed() não foi chamada nesta thread, a semente é derivada do relógio
+ * e do endereço do estado (distinto por thread).
  *
- * @return Ponteiro para a string alocada dinamicamente (deve ser liberada pelo usuário)
- *         ou NULL em caso de erro de alocação.
+ * @return Ponteiro para o estado thread-local do gerador
  */
-char * generate_string() {
-    int len = random_number(MIN_CHARS, MAX_CHARS);
-    char *str = (char *)malloc((len + 1) * sizeof(char));
+static prng_state * thread_rng_get(void) {
+    if (!thread_rng_seeded) {
+        gentexts_seed((uint64_t)time(NULL) ^ (uint64_t)(uintptr_t)&thread_rng);
+    }
+    return &thread_rng;
+}
+
 
-    if (str == NULL) {
-        return NULL; 
+// MAX_TEXT_BYTES: maior tamanho possível de um texto, incluindo espaços e o terminador '\0'
+#define MAX_TEXT_BYTES (MAX_STRINGS * (MAX_CHARS + 1) + 1)
+
+_Static_assert(MAX_TEXT_BYTES == GENTEXTS_MAX_TEXT_BYTES, "GENTEXTS_MAX_TEXT_BYTES desatualizado");
+
+// AVG_TEXT_BYTES: estimativa do tamanho médio de um texto, usada na reserva inicial da arena
+#define AVG_TEXT_BYTES ((MIN_STRINGS + MAX_STRINGS) * (MIN_CHARS + MAX_CHARS + 2) / 4 + 1)
+
+
+/**
+ * Sorteia a estrutura de um texto: quantidade de palavras e tamanho de cada uma.
+ *
+ * @param rng Fluxo de estrutura do bloco
+ * @param lengths Destino dos tamanhos (MAX_STRINGS posições)
+ * @param num_strings Destino da quantidade de palavras
+ * @return Tamanho do texto em caracteres (palavras e espaços, sem o terminador)
+ */
+static size_t draw_text_layout(prng_state *rng, uint8_t *lengths, int *num_strings) {
+    size_t total = 0;
+    *num_strings = prng_range(rng, MIN_STRINGS, MAX_STRINGS);
+    for (int i = 0; i < *num_strings; i++) {
+        lengths[i] = (uint8_t)prng_range(rng, MIN_CHARS, MAX_CHARS);
+        total += lengths[i] + 1;
     }
+    return total;
+}
+
+
+/**
+ * Escreve as palavras de um texto, cuja estrutura já foi sorteada, diretamente no destino.
+ * O kernel vetorizado preenche o texto inteiro com letras de uma só vez e os espaços
+ * são gravados nas fronteiras das palavras, sem uma chamada ao gerador por caractere.
+ *
+ * @param rng Gerador usado para as letras
+ * @param dst Buffer de destino com pelo menos total + 1 bytes livres
+ * @param lengths Tamanho de cada palavra
+ * @param num_strings Quantidade de palavras
+ * @param total Tamanho do texto retornado por draw_text_layout()
+ */
+static void write_words(prng_state *rng, char *dst, const uint8_t *lengths, int num_strings, size_t total) {
+    textkernel_fill_lowercase(rng, dst, total);
 
-    // Preenche a string com caracteres aleatórios de 'a' a 'z'
-    for (int i = 0; i < len; i++) {
-        str[i] = 'a' + random_number(0, 25); 
+    size_t pos = 0;
+    for (int i = 0; i < num_strings; i++) {
+        pos += lengths[i];
+        dst[pos++] = ' '; // Adiciona espaço após cada string
     }
 
-    str[len] = '\0'; // Finaliza a string
+    dst[pos] = '\0';
+}
+
+
+/**
+ * Escreve um texto composto por várias strings aleatórias separadas por espaço diretamente no destino.
+ * O número de strings é definido aleatoriamente entre MIN_STRINGS e MAX_STRINGS, e o tamanho
+ * de cada string entre MIN_CHARS e MAX_CHARS.
+ *
+ * @param rng Gerador pseudoaleatório utilizado
+ * @param dst Buffer de destino com pelo menos MAX_TEXT_BYTES bytes livres
+ * @return Quantidade de caracteres escritos (sem terminador, que também é gravado)
+ */
+static size_t write_text(prng_state *rng, char *dst) {
+    uint8_t lengths[MAX_STRINGS];
+    int num_strings;
+    size_t total = draw_text_layout(rng, lengths, &num_strings);
 
-    return str;
+    write_words(rng, dst, lengths, num_strings, total);
+    return total;
 }
 
 
 /**
- * Gera um texto composto por várias strings aleatórias separadas por espaço.
- * O número de strings é definido aleatoriamente entre MIN_STRINGS e MAX_STRINGS.
+ * Gera um corpus de textos aleatórios em uma única arena contígua.
+ * A estrutura, a tabela de offsets e a tabela de tamanhos ficam em um único bloco;
+ * a arena cresce geometricamente, de modo que o custo total é linear no tamanho do corpus.
+ * Os números aleatórios vêm do gerador da thread chamadora (ver gentexts_seed()).
  *
- * @return Ponteiro para o texto alocado dinamicamente (deve ser liberado pelo usuário)
- *         ou NULL em caso de erro de alocação.
+ * @param num_texts Quantidade de textos; se <= 0, é sorteada entre MIN_TEXTS e MAX_TEXTS
+ * @return Ponteiro para o corpus (deve ser liberado com free_corpus) ou NULL em caso de erro de alocação.
+ */
+text_corpus * generate_corpus(int num_texts) {
+    prng_state *rng = thread_rng_get();
+    int n = num_texts > 0 ? num_texts : prng_range(rng, MIN_TEXTS, MAX_TEXTS);
+
+    text_corpus *corpus = (text_corpus *)malloc(sizeof(text_corpus)
+                                                + (size_t)n * sizeof(uint64_t)
+                                                + (size_t)n * sizeof(uint32_t));
+    if (corpus == NULL) {
+        return NULL;
+    }
+    corpus->count = n;
+    corpus->size = 0;
+    corpus->offsets = (uint64_t *)(corpus + 1);
+    corpus->lengths = (uint32_t *)(corpus->offsets + n);
+
+    size_t capacity = (size_t)n * AVG_TEXT_BYTES + MAX_TEXT_BYTES;
+    corpus->arena = (char *)malloc(capacity);
+    if (corpus->arena == NULL) {
+        free(corpus);
+        return NULL;
+    }
+
+    for (int i = 0; i < n; i++) {
+        // Garante espaço para o maior texto possível antes de escrever
+        if (capacity - corpus->size < MAX_TEXT_BYTES) {
+            size_t new_capacity = capacity * 2;
+            char *arena = (char *)realloc(corpus->arena, new_capacity);
+            if (arena == NULL) {
+                free_corpus(corpus);
+                return NULL;
+            }
+            corpus->arena = arena;
+            capacity = new_capacity;
+        }
+
+        size_t len = write_text(rng, corpus->arena + corpus->size);
+        corpus->offsets[i] = corpus->size;
+        corpus->lengths[i] = (uint32_t)len;
+        corpus->size += len + 1;
+    }
+
+    // Devolve ao alocador o excesso reservado (falha aqui não é erro: a arena antiga continua válida)
+    char *arena = (char *)realloc(corpus->arena, corpus->size);
+    if (arena != NULL) {
+        corpus->arena = arena;
+    }
+
+    return corpus;
+}
+
+
+/**
+ * Libera um corpus gerado por generate_corpus(), incluindo a arena e as tabelas.
  *
- * Observação: O texto é construído incrementalmente usando realloc, o que pode ser ineficiente
- * para textos grandes, mas é suficiente para o propósito deste gerador simples.
+ * @param corpus Corpus a ser liberado (NULL é ignorado)
  */
-char * generate_text() {
-    int num_strings = random_number(MIN_STRINGS, MAX_STRINGS);
-    char * text = (char *) malloc(1);
-    char * str;
+void free_corpus(text_corpus *corpus) {
+    if (corpus == NULL) {
+        return;
+    }
+    free(corpus->arena);
+    free(corpus);
+}
 
-    text[0] = '\0';
 
-    for (int i = 0; i < num_strings; i++) {
-        str = generate_string();
+// PARALLEL_CHUNK_TEXTS: textos por bloco de trabalho na geração paralela. Cada bloco usa
+// fluxos aleatórios próprios, derivados da semente e do número do bloco, então o resultado
+// não depende de quantas threads participam nem da ordem em que os blocos são processados.
+#define PARALLEL_CHUNK_TEXTS 4096
 
-        if (str == NULL) {
-            free(text); 
-            return NULL;
+// PARALLEL_MAX_THREADS_PER_CPU: limite de threads por processador disponível; acima dele as threads
+// só disputariam os mesmos núcleos
+#define PARALLEL_MAX_THREADS_PER_CPU 4
+
+// Parâmetros compartilhados pelas threads de uma geração paralela
+typedef struct parallel_job {
+    text_corpus *corpus;
+    uint64_t seed;
+    int num_chunks;
+    int num_threads;
+    int fill;           // 0: fase de medição (tamanhos); 1: fase de preenchimento
+} parallel_job;
+
+typedef struct parallel_worker {
+    parallel_job *job;
+    int index;
+} parallel_worker;
+
+
+/**
+ * Processa os blocos atribuídos a uma thread (faixa contígua de blocos).
+ * Na fase de medição, apenas sorteia a estrutura de cada texto e grava seu tamanho.
+ * Na fase de preenchimento, refaz o mesmo sorteio de estrutura e escreve as letras
+ * diretamente na posição final da arena, usando um segundo fluxo do bloco.
+ */
+static void * parallel_worker_run(void *arg) {
+    parallel_worker *worker = (parallel_worker *)arg;
+    parallel_job *job = worker->job;
+    text_corpus *corpus = job->corpus;
+    int first = (int)((int64_t)job->num_chunks * worker->index / job->num_threads);
+    int last = (int)((int64_t)job->num_chunks * (worker->index + 1) / job->num_threads);
+
+    for (int chunk = first; chunk < last; chunk++) {
+        prng_state layout_rng, letters_rng;
+        prng_seed_stream(&layout_rng, job->seed, 2 * (uint64_t)chunk);
+        prng_seed_stream(&letters_rng, job->seed, 2 * (uint64_t)chunk + 1);
+
+        int begin = chunk * PARALLEL_CHUNK_TEXTS;
+        int end = corpus->count - begin > PARALLEL_CHUNK_TEXTS ? begin + PARALLEL_CHUNK_TEXTS : corpus->count;
+
+        for (int i = begin; i < end; i++) {
+            uint8_t lengths[MAX_STRINGS];
+            int num_strings;
+            size_t total = draw_text_layout(&layout_rng, lengths, &num_strings);
+
+            if (!job->fill) {
+                corpus->lengths[i] = (uint32_t)total;
+                continue;
+            }
+
+            write_words(&letters_rng, corpus->arena + corpus->offsets[i], lengths, num_strings, total);
         }
+    }
+    return NULL;
+}
 
-        // Realoca o texto para acomodar a nova string e o espaço
-        text = (char *)realloc(text, strlen(text) + strlen(str) + 2);
 
-        if (text == NULL) {
-            free(str);
-            return NULL;
+/**
+ * Executa uma fase da geração paralela, usando a thread chamadora como uma das trabalhadoras.
+ *
+ * @return 0 em caso de sucesso, -1 se não foi possível criar as threads
+ */
+static int parallel_run_phase(parallel_job *job) {
+    pthread_t *threads = (pthread_t *)malloc(job->num_threads * sizeof(pthread_t));
+    parallel_worker *workers = (parallel_worker *)malloc(job->num_threads * sizeof(parallel_worker));
+    if (!threads || !workers) {
+        free(threads);
+        free(workers);
+        return -1;
+    }
+    int started = 0;
+    int status = 0;
+
+    for (int t = 1; t < job->num_threads; t++) {
+        workers[t].job = job;
+        workers[t].index = t;
+        if (pthread_create(&threads[t], NULL, parallel_worker_run, &workers[t]) != 0) {
+            status = -1;
+            break;
+        }
+        started = t;
+    }
+
+    workers[0].job = job;
+    workers[0].index = 0;
+    if (status == 0) {
+        parallel_worker_run(&workers[0]);
+    }
+
+    for (int t = 1; t <= started; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    free(threads);
+    free(workers);
+    return status;
+}
+
+
+/**
+ * Gera um corpus em paralelo, com o mesmo layout de generate_corpus() (arena única e tabela de offsets).
+ * Os textos são divididos em blocos de PARALLEL_CHUNK_TEXTS, distribuídos entre num_threads threads.
+ * Cada bloco usa fluxos aleatórios independentes derivados de seed, então o corpus gerado é
+ * idêntico para qualquer número de threads.
+ *
+ * A geração ocorre em duas fases: primeiro os tamanhos de todos os textos são calculados,
+ * o que permite alocar a arena com o tamanho exato; depois cada thread escreve seus textos
+ * diretamente na posição final, sem cópias nem realocações.
+ *
+ * @param num_texts Quantidade de textos; se <= 0, é sorteada (a partir de seed) entre MIN_TEXTS e MAX_TEXTS
+ * @param seed Semente que determina todo o conteúdo do corpus
+ * @param num_threads Quantidade de threads; se <= 0, usa o número de processadores disponíveis. Limitada a
+ *                    PARALLEL_MAX_THREADS_PER_CPU por processador e ao número de blocos
+ * @return Ponteiro para o corpus (deve ser liberado com free_corpus) ou NULL em caso de erro.
+ */
+text_corpus * generate_corpus_parallel(int num_texts, uint64_t seed, int num_threads) {
+    int n = num_texts;
+    if (n <= 0) {
+        prng_state rng;
+        prng_seed(&rng, seed);
+        n = prng_range(&rng, MIN_TEXTS, MAX_TEXTS);
+    }
+
+    // Em 64 bits: n + PARALLEL_CHUNK_TEXTS - 1 excede INT_MAX para n próximo do limite
+    int num_chunks = (int)(((int64_t)n + PARALLEL_CHUNK_TEXTS - 1) / PARALLEL_CHUNK_TEXTS);
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus <= 0) {
+        cpus = 1;
+    }
+    if (num_threads <= 0) {
+        num_threads = (int)cpus;
+    }
+    if (num_threads > cpus * PARALLEL_MAX_THREADS_PER_CPU) {
+        num_threads = (int)(cpus * PARALLEL_MAX_THREADS_PER_CPU);
+    }
+    if (num_threads > num_chunks) {
+        num_threads = num_chunks;
+    }
+
+    text_corpus *corpus = (text_corpus *)malloc(sizeof(text_corpus)
+                                                + (size_t)n * sizeof(uint64_t)
+                                                + (size_t)n * sizeof(uint32_t));
+    if (corpus == NULL) {
+        return NULL;
+    }
+    corpus->count = n;
+    corpus->size = 0;
+    corpus->offsets = (uint64_t *)(corpus + 1);
+    corpus->lengths = (uint32_t *)(corpus->offsets + n);
+    corpus->arena = NULL;
+
+    parallel_job job = { corpus, seed, num_chunks, num_threads, 0 };
+
+    // Fase 1: tamanhos de todos os textos
+    if (parallel_run_phase(&job) != 0) {
+        free_corpus(corpus);
+        return NULL;
+    }
+
+    for (int i = 0; i < n; i++) {
+        corpus->offsets[i] = corpus->size;
+        corpus->size += corpus->lengths[i] + 1;
+    }
+
+    corpus->arena = (char *)malloc(corpus->size);
+    if (corpus->arena == NULL) {
+        free_corpus(corpus);
+        return NULL;
+    }
+
+    // Fase 2: escrita dos textos nas posições finais
+    job.fill = 1;
+    if (parallel_run_phase(&job) != 0) {
+        free_corpus(corpus);
+        return NULL;
+    }
+
+    return corpus;
+}
+
+
+// Estado de um fluxo de geração: posição atual e os dois fluxos aleatórios do bloco corrente
+struct gentexts_stream {
+    uint64_t seed;
+    uint64_t count;
+    uint64_t next_index;
+    prng_state layout_rng;
+    prng_state letters_rng;
+};
+
+
+/**
+ * Abre um fluxo que gera num_texts textos sob demanda, em memória constante.
+ * Os textos são exatamente os de generate_corpus_parallel(num_texts, seed, ...), na mesma ordem.
+ *
+ * @param num_texts Quantidade de textos; se 0, é sorteada (a partir de seed) entre MIN_TEXTS e MAX_TEXTS
+ * @param seed Semente que determina o conteúdo
+ * @return Fluxo (liberar com gentexts_stream_close) ou NULL em caso de erro de alocação
+ */
+gentexts_stream * gentexts_stream_open(uint64_t num_texts, uint64_t seed) {
+    gentexts_stream *stream = (gentexts_stream *)malloc(sizeof(gentexts_stream));
+    if (stream == NULL) {
+        return NULL;
+    }
+    if (num_texts == 0) {
+        prng_state rng;
+        prng_seed(&rng, seed);
+        num_texts = (uint64_t)prng_range(&rng, MIN_TEXTS, MAX_TEXTS);
+    }
+    stream->seed = seed;
+    stream->count = num_texts;
+    stream->next_index = 0;
+    return stream;
+}
+
+
+/**
+ * Gera os próximos textos no buffer do chamador, que pode ser reutilizado a cada chamada.
+ * Os textos são gravados em sequência, cada um terminado por '\0', e seus tamanhos em lengths.
+ * Só são gravados textos inteiros: a chamada para quando o próximo texto não cabe no buffer.
+ *
+ * @param stream Fluxo aberto por gentexts_stream_open()
+ * @param buffer Buffer de destino
+ * @param capacity Tamanho do buffer (pelo menos GENTEXTS_MAX_TEXT_BYTES, o maior texto possível)
+ * @param lengths Destino dos tamanhos dos textos gerados (max_texts posições)
+ * @param max_texts Quantidade máxima de textos nesta chamada (> 0)
+ * @return Quantidade de textos gerados; 0 quando o fluxo terminou; GENTEXTS_STREAM_ERROR se
+ *         capacity ou max_texts não permitem gerar um texto
+ */
+size_t gentexts_stream_next(gentexts_stream *stream, char *buffer, size_t capacity,
+                            uint32_t *lengths, size_t max_texts) {
+    size_t produced = 0;
+    size_t used = 0;
+
+    // Com um buffer menor, um texto longo não caberia e 0 seria confundido com o fim do fluxo
+    if (stream == NULL || buffer == NULL || lengths == NULL
+        || capacity < GENTEXTS_MAX_TEXT_BYTES || max_texts == 0) {
+        return GENTEXTS_STREAM_ERROR;
+    }
+
+    while (produced < max_texts && stream->next_index < stream->count) {
+        uint64_t index = stream->next_index;
+        if (index % PARALLEL_CHUNK_TEXTS == 0) {
+            uint64_t chunk = index / PARALLEL_CHUNK_TEXTS;
+            prng_seed_stream(&stream->layout_rng, stream->seed, 2 * chunk);
+            prng_seed_stream(&stream->letters_rng, stream->seed, 2 * chunk + 1);
+        }
+
+        // Guarda o estado para desfazer o sorteio caso o texto não caiba no buffer
+        prng_state saved = stream->layout_rng;
+        uint8_t word_lengths[MAX_STRINGS];
+        int num_strings;
+        size_t total = draw_text_layout(&stream->layout_rng, word_lengths, &num_strings);
+
+        if (capacity - used < total + 1) {
+            stream->layout_rng = saved;
+            break;
         }
 
-        strcat(text, str);
-        strcat(text, " "); // Adiciona espaço após cada string
-        free(str);
+        write_words(&stream->letters_rng, buffer + used, word_lengths, num_strings, total);
+        lengths[produced++] = (uint32_t)total;
+        used += total + 1;
+        stream->next_index++;
     }
 
-    return text;
+    return produced;
+}
+
+
+/**
+ * Retorna quantos textos ainda faltam ser gerados pelo fluxo.
+ */
+uint64_t gentexts_stream_remaining(const gentexts_stream *stream) {
+    return stream->count - stream->next_index;
+}
+
+
+/**
+ * Libera o fluxo.
+ */
+void gentexts_stream_close(gentexts_stream *stream) {
+    free(stream);
 }
 
 
+// Bloco de saída da geração por callback, preenchido pela thread produtora
+typedef struct stream_slot {
+    char *buffer;
+    uint32_t *lengths;
+    size_t count;
+    int ready;
+} stream_slot;
+
+// Estado compartilhado entre a thread produtora e a consumidora (thread chamadora)
+typedef struct stream_pipeline {
+    gentexts_stream *stream;
+    size_t chunk_texts;
+    size_t capacity;
+    stream_slot slots[2];
+    int finished;       // produtora terminou (ou falhou)
+    int failed;         // produtora recebeu GENTEXTS_STREAM_ERROR
+    int stop;           // consumidora pediu para parar
+    pthread_mutex_t mutex;
+    pthread_cond_t changed;
+} stream_pipeline;
+
+
+/**
+ * Thread produtora: preenche alternadamente os dois blocos enquanto a consumidora processa o outro.
+ */
+static void * stream_producer_run(void *arg) {
+    stream_pipeline *pipeline = (stream_pipeline *)arg;
+
+    for (int slot_index = 0; ; slot_index ^= 1) {
+        stream_slot *slot = &pipeline->slots[slot_index];
+
+        pthread_mutex_lock(&pipeline->mutex);
+        while (slot->ready && !pipeline->stop) {
+            pthread_cond_wait(&pipeline->changed, &pipeline->mutex);
+        }
+        int stop = pipeline->stop;
+        pthread_mutex_unlock(&pipeline->mutex);
+        if (stop) {
+            break;
+        }
+
+        // A geração acontece fora do mutex, em paralelo com o consumo do outro bloco
+        size_t count = gentexts_stream_next(pipeline->stream, slot->buffer, pipeline->capacity,
+                                            slot->lengths, pipeline->chunk_texts);
+        if (count == 0 || count == GENTEXTS_STREAM_ERROR) {
+            pthread_mutex_lock(&pipeline->mutex);
+            pipeline->failed = count == GENTEXTS_STREAM_ERROR;
+            pthread_mutex_unlock(&pipeline->mutex);
+            break;
+        }
+
+        pthread_mutex_lock(&pipeline->mutex);
+        slot->count = count;
+        slot->ready = 1;
+        pthread_cond_broadcast(&pipeline->changed);
+        pthread_mutex_unlock(&pipeline->mutex);
+    }
+
+    pthread_mutex_lock(&pipeline->mutex);
+    pipeline->finished = 1;
+    pthread_cond_broadcast(&pipeline->changed);
+    pthread_mutex_unlock(&pipeline->mutex);
+    return NULL;
+}
+
+
+/**
+ * Gera num_texts textos e os entrega em blocos a um callback, em memória constante.
+ * Uma thread produtora gera o próximo bloco enquanto o callback processa o atual (buffer duplo),
+ * então a geração se sobrepõe ao consumo (por exemplo, gravação em disco).
+ * Os textos são os mesmos de generate_corpus_parallel(num_texts, seed, ...), na mesma ordem.
+ *
+ * @param num_texts Quantidade de textos (0 = sorteada a partir de seed)
+ * @param seed Semente que determina o conteúdo
+ * @param chunk_texts Textos por bloco entregue ao callback (0 = PARALLEL_CHUNK_TEXTS)
+ * @param callback Chamado na thread chamadora para cada bloco; retornar diferente de 0 interrompe a geração
+ * @param user Ponteiro repassado ao callback
+ * @return 0 se todos os textos foram entregues, 1 se o callback interrompeu, -1 em caso de erro
+ */
+int generate_texts_streaming(uint64_t num_texts, uint64_t seed, size_t chunk_texts,
+                             gentexts_chunk_fn callback, void *user) {
+    stream_pipeline pipeline;
+    memset(&pipeline, 0, sizeof(pipeline));
+    pipeline.chunk_texts = chunk_texts > 0 ? chunk_texts : PARALLEL_CHUNK_TEXTS;
+    pipeline.capacity = pipeline.chunk_texts * MAX_TEXT_BYTES;
+    pipeline.stream = gentexts_stream_open(num_texts, seed);
+
+    int status = pipeline.stream != NULL ? 0 : -1;
+    for (int i = 0; i < 2 && status == 0; i++) {
+        pipeline.slots[i].buffer = (char *)malloc(pipeline.capacity);
+        pipeline.slots[i].lengths = (uint32_t *)malloc(pipeline.chunk_texts * sizeof(uint32_t));
+        if (pipeline.slots[i].buffer == NULL || pipeline.slots[i].lengths == NULL) {
+            status = -1;
+        }
+    }
+
+    pthread_t producer;
+    if (status == 0) {
+        pthread_mutex_init(&pipeline.mutex, NULL);
+        pthread_cond_init(&pipeline.changed, NULL);
+        if (pthread_create(&producer, NULL, stream_producer_run, &pipeline) != 0) {
+            pthread_cond_destroy(&pipeline.changed);
+            pthread_mutex_destroy(&pipeline.mutex);
+            status = -1;
+        }
+    }
+
+    if (status == 0) {
+        for (int slot_index = 0; ; slot_index ^= 1) {
+            stream_slot *slot = &pipeline.slots[slot_index];
+
+            pthread_mutex_lock(&pipeline.mutex);
+            while (!slot->ready && !pipeline.finished) {
+                pthread_cond_wait(&pipeline.changed, &pipeline.mutex);
+            }
+            int ready = slot->ready;
+            pthread_mutex_unlock(&pipeline.mutex);
+            if (!ready) {
+                break;
+            }
+
+            int stop = callback(slot->buffer, slot->lengths, slot->count, user);
+
+            pthread_mutex_lock(&pipeline.mutex);
+            slot->ready = 0;
+            if (stop) {
+                pipeline.stop = 1;
+                status = 1;
+            }
+            pthread_cond_broadcast(&pipeline.changed);
+            pthread_mutex_unlock(&pipeline.mutex);
+            if (stop) {
+                break;
+            }
+        }
+
+        pthread_join(producer, NULL);
+        if (pipeline.failed) {
+            status = -1;
+        }
+        pthread_cond_destroy(&pipeline.changed);
+        pthread_mutex_destroy(&pipeline.mutex);
+    }
+
+    for (int i = 0; i < 2; i++) {
+        free(pipeline.slots[i].buffer);
+        free(pipeline.slots[i].lengths);
+    }
+    gentexts_stream_close(pipeline.stream);
+    return status;
+}
+
 
 /**
  * Gera uma lista de textos aleatórios.
@@ -113,27 +653,59 @@ char * generate_text() {
  * @return Ponteiro para o array de textos (cada texto é uma string alocada dinamicamente)
  *         ou NULL em caso de erro de alocação.
  *
- * Observação: Em caso de erro na geração de algum texto, todos os textos já gerados são liberados.
+ * Observação: Mantida por compatibilidade. Os textos são gerados via generate_corpus() e copiados
+ * para strings individuais, preservando o contrato antigo (cada texto e a lista liberados com free).
  */
 char ** generate_list_random_texts(int *num_texts) {
-    int n = random_number(MIN_TEXTS, MAX_TEXTS);
-    if (num_texts) *num_texts = n;
+    text_corpus *corpus = generate_corpus(0);
+    if (corpus == NULL) {
+        return NULL;
+    }
+    int n = corpus->count;
     char ** list = (char **) malloc(n * sizeof(char *));
     if (list == NULL) {
+        free_corpus(corpus);
         return NULL;
     }
     for (int i = 0; i < n; i++) {
-        list[i] = generate_text();
+        list[i] = (char *) malloc(corpus->lengths[i] + 1);
         if (list[i] == NULL) {
             // Libera todos os textos já gerados em caso de erro
             for (int j = 0; j < i; j++) {
                 free(list[j]);
             }
             free(list);
+            free_corpus(corpus);
             return NULL;
         }
+        memcpy(list[i], corpus->arena + corpus->offsets[i], corpus->lengths[i] + 1);
     }
+    free_corpus(corpus);
+    if (num_texts) *num_texts = n;
     return list;
 }
 
 
+/**
+ * Descrição da libgentexts como plugin de geração (ver gentexts_plugin.h).
+ *
+ * @return Ponteiro para a descrição estática do gerador
+ */
+const gentexts_plugin_api * gentexts_plugin_query(void) {
+    static const gentexts_plugin_api api = {
+        GENTEXTS_PLUGIN_ABI_VERSION,
+        sizeof(gentexts_plugin_api),
+        "gentexts",
+        "1.0",
+        GENTEXTS_CAP_LIST | GENTEXTS_CAP_CORPUS | GENTEXTS_CAP_PARALLEL | GENTEXTS_CAP_STREAM | GENTEXTS_CAP_SEED,
+        generate_list_random_texts,
+        generate_corpus,
+        generate_corpus_parallel,
+        free_corpus,
+        gentexts_seed,
+        gentexts_stream_open,
+        gentexts_stream_next,
+        gentexts_stream_close
+    };
+    return &api;
+}
@@ -1,7 +1,106 @@
 #ifndef LIB_GENTEXTS_H
 #define LIB_GENTEXTS_H
 
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Corpus de textos armazenado em uma única arena contígua.
+ * O texto i começa em arena + offsets[i], possui lengths[i] caracteres e é terminado por '\0',
+ * podendo ser usado diretamente como string C.
+ */
+typedef struct text_corpus {
+    int count;          // Número de textos no corpus
+    size_t size;        // Bytes ocupados na arena (incluindo os terminadores)
+    uint64_t *offsets;  // Posição inicial de cada texto na arena
+    uint32_t *lengths;  // Tamanho de cada texto, sem o '\0'
+    char *arena;        // Bloco contíguo com todos os textos
+} text_corpus;
+
+// GENTEXTS_MAX_TEXT_BYTES: maior tamanho possível de um texto gerado, incluindo o terminador '\0'
+#define GENTEXTS_MAX_TEXT_BYTES 221
+
+// Fluxo de geração sob demanda (ver gentexts_stream_open)
+typedef struct gentexts_stream gentexts_stream;
+
+// Retorno de gentexts_stream_next() para argumentos inválidos (distinto de 0, que indica o fim do fluxo)
+#define GENTEXTS_STREAM_ERROR ((size_t)-1)
+
+// Callback que recebe um bloco de textos: count textos consecutivos em texts, cada um terminado por '\0'.
+// Retornar diferente de 0 interrompe a geração.
+typedef int (*gentexts_chunk_fn)(const char *texts, const uint32_t *lengths, size_t count, void *user);
+
 // Agora sim, a biblioteca retorna uma função única, não tinha me atentado ao enunciado e a possibilidade de usar a mesma lista.
 char ** generate_list_random_texts (int * num_texts);
 
-#endif
\ No newline at end of file
+/**
+ * Gera um corpus com num_texts textos em tempo linear, usando uma única arena.
+ * Se num_texts <= 0, a quantidade é sorteada entre os limites padrão da biblioteca.
+ * Retorna NULL em caso de erro de alocação. Deve ser liberado com free_corpus().
+ */
+text_corpus * generate_corpus (int num_texts);
+
+/**
+ * Gera um corpus em paralelo, com o mesmo layout de generate_corpus().
+ * O conteúdo depende apenas de num_texts e seed: é idêntico para qualquer num_threads.
+ * Se num_threads <= 0, usa o número de processadores disponíveis; em qualquer caso, fica limitado a
+ * 4 threads por processador.
+ * Retorna NULL em caso de erro. Deve ser liberado com free_corpus().
+ */
+text_corpus * generate_corpus_parallel (int num_texts, uint64_t seed, int num_threads);
+
+/**
+ * Abre um fluxo que gera num_texts textos sob demanda, em memória constante.
+ * Produz exatamente os textos de generate_corpus_parallel(num_texts, seed, ...), na mesma ordem.
+ * num_texts = 0 sorteia a quantidade a partir da semente. Retorna NULL em caso de erro.
+ */
+gentexts_stream * gentexts_stream_open (uint64_t num_texts, uint64_t seed);
+
+/**
+ * Gera os próximos textos (inteiros, terminados por '\0') no buffer reutilizável do chamador,
+ * gravando seus tamanhos em lengths. Exige capacity >= GENTEXTS_MAX_TEXT_BYTES e max_texts > 0,
+ * o que garante ao menos um texto por chamada enquanto o fluxo não termina.
+ * Retorna a quantidade de textos gerados; 0 somente quando o fluxo terminou e
+ * GENTEXTS_STREAM_ERROR se os argumentos são inválidos (nada é gerado).
+ */
+size_t gentexts_stream_next (gentexts_stream *stream, char *buffer, size_t capacity,
+                             uint32_t *lengths, size_t max_texts);
+
+/**
+ * Retorna quantos textos ainda faltam ser gerados pelo fluxo.
+ */
+uint64_t gentexts_stream_remaining (const gentexts_stream *stream);
+
+/**
+ * Libera o fluxo.
+ */
+void gentexts_stream_close (gentexts_stream *stream);
+
+/**
+ * Gera num_texts textos e os entrega em blocos de chunk_texts ao callback, em memória constante.
+ * A geração do próximo bloco ocorre em outra thread enquanto o callback processa o atual.
+ * Retorna 0 ao concluir, 1 se o callback interrompeu e -1 em caso de erro.
+ */
+int generate_texts_streaming (uint64_t num_texts, uint64_t seed, size_t chunk_texts,
+                              gentexts_chunk_fn callback, void *user);
+
+/**
+ * Define a semente do gerador pseudoaleatório da thread chamadora.
+ * Gerações feitas depois, na mesma thread e com a mesma semente, produzem o mesmo corpus.
+ */
+void gentexts_seed (uint64_t seed);
+
+/**
+ * Libera todo o corpus (tabela de offsets e arena) com uma única chamada.
+ */
+void free_corpus (text_corpus * corpus);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
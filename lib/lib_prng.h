@@ -0,0 +1,133 @@
+#ifndef LIB_PRNG_H
+#define LIB_PRNG_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Gerador pseudoaleatório xoshiro256** com estado explícito.
+ * Cada thread deve manter o seu próprio prng_state (por exemplo, em uma variável thread-local),
+ * o que elimina o estado global compartilhado de rand()/srand().
+ * Com a mesma semente, a sequência gerada é sempre a mesma, permitindo reproduzir um corpus.
+ */
+typedef struct prng_state {
+    uint64_t s[4];
+} prng_state;
+
+
+/**
+ * Passo do gerador splitmix64, usado para expandir uma semente de 64 bits no estado do xoshiro.
+ *
+ * @param x Ponteiro para o contador do splitmix64 (é avançado a cada chamada)
+ * @return Próximo valor de 64 bits
+ */
+static inline uint64_t prng_splitmix64(uint64_t *x) {
+    uint64_t z = (*x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+
+/**
+ * Inicializa o estado a partir de uma semente de 64 bits.
+ *
+ * @param st Estado a ser inicializado
+ * @param seed Semente (qualquer valor, inclusive 0)
+ */
+static inline void prng_seed(prng_state *st, uint64_t seed) {
+    uint64_t x = seed;
+    st->s[0] = prng_splitmix64(&x);
+    st->s[1] = prng_splitmix64(&x);
+    st->s[2] = prng_splitmix64(&x);
+    st->s[3] = prng_splitmix64(&x);
+}
+
+
+/**
+ * Inicializa o estado com um fluxo independente derivado de (seed, stream).
+ * Fluxos diferentes da mesma semente não se sobrepõem na prática, o que permite
+ * dividir o trabalho entre threads mantendo o resultado determinístico.
+ *
+ * @param st Estado a ser inicializado
+ * @param seed Semente base
+ * @param stream Identificador do fluxo (por exemplo, o número do bloco de trabalho)
+ */
+static inline void prng_seed_stream(prng_state *st, uint64_t seed, uint64_t stream) {
+    uint64_t x = stream;
+    prng_seed(st, seed ^ prng_splitmix64(&x));
+}
+
+
+static inline uint64_t prng_rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+
+/**
+ * Gera o próximo número de 64 bits (xoshiro256**).
+ *
+ * @param st Estado do gerador
+ * @return Número pseudoaleatório de 64 bits
+ */
+static inline uint64_t prng_next(prng_state *st) {
+    uint64_t *s = st->s;
+    uint64_t result = prng_rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = prng_rotl(s[3], 45);
+
+    return result;
+}
+
+
+/**
+ * Sorteia um número uniforme em [0, bound) sem o viés do operador %.
+ * Utiliza o método de multiplicação com rejeição de Lemire: na grande maioria dos casos
+ * não há divisão nem nova chamada ao gerador.
+ *
+ * @param st Estado do gerador
+ * @param bound Limite superior exclusivo (deve ser > 0)
+ * @return Número uniforme em [0, bound)
+ */
+static inline uint32_t prng_bounded(prng_state *st, uint32_t bound) {
+    uint64_t m = (prng_next(st) >> 32) * (uint64_t)bound;
+    uint32_t low = (uint32_t)m;
+
+    if (low < bound) {
+        uint32_t threshold = (uint32_t)(-bound) % bound;
+        while (low < threshold) {
+            m = (prng_next(st) >> 32) * (uint64_t)bound;
+            low = (uint32_t)m;
+        }
+    }
+
+    return (uint32_t)(m >> 32);
+}
+
+
+/**
+ * Sorteia um número uniforme entre min e max (inclusive).
+ *
+ * @param st Estado do gerador
+ * @param min Valor mínimo
+ * @param max Valor máximo (deve ser >= min)
+ * @return Número uniforme entre min e max
+ */
+static inline int prng_range(prng_state *st, int min, int max) {
+    return min + (int)prng_bounded(st, (uint32_t)(max - min) + 1u);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
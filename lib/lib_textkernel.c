@@ -0,0 +1,228 @@
+#include <string.h>
+
+#include "lib_textkernel.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define TEXTKERNEL_X86 1
+#endif
+
+// BLOCK_LETTERS: letras produzidas por bloco (4 números de 64 bits, 16 lanes de 16 bits)
+#define BLOCK_LETTERS 16
+
+// REJECT_THRESHOLD: 65536 % 26. Lanes cuja parte baixa do produto fica abaixo desse valor
+// introduziriam viés e precisam ser sorteadas novamente.
+#define REJECT_THRESHOLD 16
+
+
+/**
+ * Sorteia novamente as posições rejeitadas de um bloco, na ordem das lanes.
+ *
+ * @param rng Gerador pseudoaleatório
+ * @param dst Início do bloco
+ * @param mask Bit i ligado indica que a lane i foi rejeitada
+ */
+static void redraw_rejected(prng_state *rng, char *dst, unsigned mask) {
+    while (mask) {
+        int lane = __builtin_ctz(mask);
+        dst[lane] = (char)('a' + prng_bounded(rng, 26));
+        mask &= mask - 1;
+    }
+}
+
+
+/**
+ * Converte até BLOCK_LETTERS letras de forma escalar. Também trata a cauda dos vetoriais,
+ * consumindo apenas os números de 64 bits necessários para n letras.
+ *
+ * @param rng Gerador pseudoaleatório
+ * @param dst Destino
+ * @param n Quantidade de letras (1 a BLOCK_LETTERS)
+ */
+static void fill_block_scalar(prng_state *rng, char *dst, size_t n) {
+    unsigned mask = 0;
+    size_t lane = 0;
+
+    while (lane < n) {
+        uint64_t bits = prng_next(rng);
+        for (int j = 0; j < 4 && lane < n; j++, lane++) {
+            uint32_t m = (uint32_t)(uint16_t)(bits >> (16 * j)) * 26u;
+            dst[lane] = (char)('a' + (m >> 16));
+            if ((uint16_t)m < REJECT_THRESHOLD) {
+                mask |= 1u << lane;
+            }
+        }
+    }
+
+    redraw_rejected(rng, dst, mask);
+}
+
+
+// Os kernels abaixo trabalham sobre uma cópia local do estado do gerador, gravada de volta ao final:
+// como dst é char*, o compilador precisa supor que cada escrita nele pode alterar *state, e recarregaria
+// o estado da memória a cada número sorteado.
+
+/**
+ * Implementação escalar de referência.
+ */
+static void fill_scalar(prng_state *state, char *dst, size_t n) {
+    prng_state local = *state;
+    prng_state *rng = &local;
+
+    while (n > 0) {
+        size_t chunk = n < BLOCK_LETTERS ? n : BLOCK_LETTERS;
+        fill_block_scalar(rng, dst, chunk);
+        dst += chunk;
+        n -= chunk;
+    }
+
+    *state = local;
+}
+
+
+#ifdef TEXTKERNEL_X86
+
+/**
+ * Implementação SSE2: cada metade do bloco (8 lanes de 16 bits) é convertida com mulhi/mullo,
+ * empacotada em bytes e gravada diretamente no destino.
+ */
+__attribute__((target("sse2")))
+static void fill_sse2(prng_state *state, char *dst, size_t n) {
+    prng_state local = *state;
+    prng_state *rng = &local;
+
+    const __m128i mul = _mm_set1_epi16(26);
+    const __m128i base = _mm_set1_epi16('a');
+    const __m128i low_bits = _mm_set1_epi16((short)(0xFFFF & ~(REJECT_THRESHOLD - 1)));
+    const __m128i zero = _mm_setzero_si128();
+
+    while (n >= BLOCK_LETTERS) {
+        unsigned mask = 0;
+        for (int half = 0; half < 2; half++) {
+            // Monta o vetor em registradores (evita o store-forwarding de um array temporário)
+            uint64_t w0 = prng_next(rng);
+            uint64_t w1 = prng_next(rng);
+            __m128i bits = _mm_set_epi64x((long long)w1, (long long)w0);
+            __m128i hi = _mm_add_epi16(_mm_mulhi_epu16(bits, mul), base);
+            __m128i lo = _mm_mullo_epi16(bits, mul);
+            __m128i rejected = _mm_cmpeq_epi16(_mm_and_si128(lo, low_bits), zero);
+
+            _mm_storel_epi64((__m128i *)(dst + 8 * half), _mm_packus_epi16(hi, hi));
+
+            // movemask gera 2 bits por lane de 16 bits; mantém um bit por lane
+            unsigned bytes_mask = (unsigned)_mm_movemask_epi8(_mm_packs_epi16(rejected, zero));
+            mask |= (bytes_mask & 0xFFu) << (8 * half);
+        }
+
+        redraw_rejected(rng, dst, mask);
+        dst += BLOCK_LETTERS;
+        n -= BLOCK_LETTERS;
+    }
+
+    if (n > 0) {
+        fill_block_scalar(rng, dst, n);
+    }
+
+    *state = local;
+}
+
+
+/**
+ * Implementação AVX2: o bloco inteiro (16 lanes de 16 bits) é convertido em uma única passada.
+ */
+__attribute__((target("avx2")))
+static void fill_avx2(prng_state *state, char *dst, size_t n) {
+    prng_state local = *state;
+    prng_state *rng = &local;
+
+    const __m256i mul = _mm256_set1_epi16(26);
+    const __m256i base = _mm256_set1_epi16('a');
+    const __m256i low_bits = _mm256_set1_epi16((short)(0xFFFF & ~(REJECT_THRESHOLD - 1)));
+    const __m256i zero = _mm256_setzero_si256();
+
+    while (n >= BLOCK_LETTERS) {
+        uint64_t w0 = prng_next(rng);
+        uint64_t w1 = prng_next(rng);
+        uint64_t w2 = prng_next(rng);
+        uint64_t w3 = prng_next(rng);
+        __m256i bits = _mm256_set_epi64x((long long)w3, (long long)w2, (long long)w1, (long long)w0);
+        __m256i hi = _mm256_add_epi16(_mm256_mulhi_epu16(bits, mul), base);
+        __m256i lo = _mm256_mullo_epi16(bits, mul);
+        __m256i rejected = _mm256_cmpeq_epi16(_mm256_and_si256(lo, low_bits), zero);
+
+        // packus opera dentro de cada metade de 128 bits; o permute junta as duas metades em ordem
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(hi, hi), 0x08);
+        _mm_storeu_si128((__m128i *)dst, _mm256_castsi256_si128(packed));
+
+        __m256i rejected_bytes = _mm256_permute4x64_epi64(_mm256_packs_epi16(rejected, zero), 0x08);
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm256_castsi256_si128(rejected_bytes));
+
+        redraw_rejected(rng, dst, mask);
+        dst += BLOCK_LETTERS;
+        n -= BLOCK_LETTERS;
+    }
+
+    if (n > 0) {
+        fill_block_scalar(rng, dst, n);
+    }
+
+    *state = local;
+}
+
+#endif
+
+
+textkernel_isa textkernel_best_isa(void) {
+#ifdef TEXTKERNEL_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return TEXTKERNEL_AVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return TEXTKERNEL_SSE2;
+    }
+#endif
+    return TEXTKERNEL_SCALAR;
+}
+
+
+textkernel_fill_fn textkernel_select(textkernel_isa isa) {
+    switch (isa) {
+    case TEXTKERNEL_SCALAR:
+        return fill_scalar;
+#ifdef TEXTKERNEL_X86
+    case TEXTKERNEL_SSE2:
+        return textkernel_best_isa() >= TEXTKERNEL_SSE2 ? fill_sse2 : NULL;
+    case TEXTKERNEL_AVX2:
+        return textkernel_best_isa() >= TEXTKERNEL_AVX2 ? fill_avx2 : NULL;
+#endif
+    default:
+        return NULL;
+    }
+}
+
+
+const char * textkernel_isa_name(textkernel_isa isa) {
+    switch (isa) {
+    case TEXTKERNEL_SSE2:
+        return "sse2";
+    case TEXTKERNEL_AVX2:
+        return "avx2";
+    default:
+        return "scalar";
+    }
+}
+
+
+// Implementação escolhida na primeira chamada. A escolha é idempotente, então uma corrida
+// entre threads na inicialização apenas grava o mesmo ponteiro mais de uma vez.
+static textkernel_fill_fn selected_fill = NULL;
+
+void textkernel_fill_lowercase(prng_state *rng, char *dst, size_t n) {
+    textkernel_fill_fn fill = __atomic_load_n(&selected_fill, __ATOMIC_RELAXED);
+    if (fill == NULL) {
+        fill = textkernel_select(textkernel_best_isa());
+        __atomic_store_n(&selected_fill, fill, __ATOMIC_RELAXED);
+    }
+    fill(rng, dst, n);
+}
@@ -0,0 +1,54 @@
+#ifndef LIB_TEXTKERNEL_H
+#define LIB_TEXTKERNEL_H
+
+#include <stddef.h>
+
+#include "lib_prng.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Conjuntos de instruções suportados pelo kernel de geração de letras.
+ */
+typedef enum textkernel_isa {
+    TEXTKERNEL_SCALAR = 0,
+    TEXTKERNEL_SSE2 = 1,
+    TEXTKERNEL_AVX2 = 2
+} textkernel_isa;
+
+// Assinatura comum das implementações do kernel
+typedef void (*textkernel_fill_fn)(prng_state *rng, char *dst, size_t n);
+
+/**
+ * Preenche dst com n letras minúsculas uniformes ('a' a 'z'), usando a melhor implementação
+ * disponível na CPU (escolhida uma única vez, em tempo de execução).
+ *
+ * Todas as implementações consomem o gerador da mesma forma e produzem exatamente a mesma saída
+ * para o mesmo estado inicial: cada número de 64 bits vira 4 letras (multiplicação de 16 bits
+ * com rejeição de Lemire), e as raras posições rejeitadas são sorteadas novamente ao final do bloco.
+ */
+void textkernel_fill_lowercase (prng_state *rng, char *dst, size_t n);
+
+/**
+ * Retorna a implementação para o conjunto de instruções pedido,
+ * ou NULL se ele não for suportado pela CPU ou pela compilação.
+ */
+textkernel_fill_fn textkernel_select (textkernel_isa isa);
+
+/**
+ * Retorna o melhor conjunto de instruções disponível nesta CPU.
+ */
+textkernel_isa textkernel_best_isa (void);
+
+/**
+ * Nome legível do conjunto de instruções ("scalar", "sse2", "avx2").
+ */
+const char * textkernel_isa_name (textkernel_isa isa);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,139 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+#include "corpus_file.h"
+
+using namespace std;
+
+static int failures = 0;
+
+#define CHECK(condition)                                                         \
+    do {                                                                         \
+        if (!(condition)) {                                                      \
+            fprintf(stderr, "%s:%d: falhou: %s\n", __FILE__, __LINE__, #condition); \
+            failures++;                                                          \
+        }                                                                        \
+    } while (0)
+
+
+/**
+ * Conteúdo de um arquivo de corpus válido com dois textos, gravado por corpus_file_write().
+ */
+static bool build_file(const string& path, vector<char>* contents) {
+    char arena[] = "primeiro\0segundo";
+    uint64_t offsets[] = {0, 9};
+    uint32_t lengths[] = {8, 7};
+    text_corpus corpus;
+    corpus.count = 2;
+    corpus.size = sizeof(arena);
+    corpus.offsets = offsets;
+    corpus.lengths = lengths;
+    corpus.arena = arena;
+    if (!corpus_file_write(path.c_str(), &corpus)) {
+        return false;
+    }
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    contents->clear();
+    char buffer[4096];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        contents->insert(contents->end(), buffer, buffer + read);
+    }
+    fclose(file);
+    return true;
+}
+
+
+static void write_file(const string& path, const vector<char>& contents) {
+    FILE* file = fopen(path.c_str(), "wb");
+    if (file) {
+        fwrite(contents.data(), 1, contents.size(), file);
+        fclose(file);
+    }
+}
+
+
+/**
+ * true se corpus_file_map() aceita o arquivo com este conteúdo.
+ */
+static bool accepted(const string& path, const vector<char>& contents) {
+    write_file(path, contents);
+    text_corpus* corpus = corpus_file_map(path.c_str());
+    corpus_file_unmap(corpus);
+    return corpus != nullptr;
+}
+
+
+int main() {
+    char directory[] = "/tmp/test_corpus_fileXXXXXX";
+    if (!mkdtemp(directory)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    string path = string(directory) + "/corpus.bin";
+
+    vector<char> valid;
+    CHECK(build_file(path, &valid));
+    const corpus_file_header* header = reinterpret_cast<const corpus_file_header*>(valid.data());
+    size_t blob_pos = header->blob_pos;
+    size_t offsets_pos = header->offsets_pos;
+    size_t lengths_pos = header->lengths_pos;
+
+    // Arquivo íntegro: os textos vêm do mapeamento, terminados por '\0'
+    text_corpus* corpus = corpus_file_map(path.c_str());
+    CHECK(corpus && corpus->count == 2);
+    if (corpus) {
+        CHECK(strcmp(corpus->arena + corpus->offsets[0], "primeiro") == 0);
+        CHECK(strcmp(corpus->arena + corpus->offsets[1], "segundo") == 0);
+        corpus_file_unmap(corpus);
+    }
+
+    // Terminador de um texto do meio sobrescrito
+    vector<char> contents = valid;
+    contents[blob_pos + 8] = 'X';
+    CHECK(!accepted(path, contents));
+
+    // Último byte do blob sobrescrito
+    contents = valid;
+    contents[blob_pos + 16] = 'X';
+    CHECK(!accepted(path, contents));
+
+    // Tamanho que avança sobre o texto seguinte
+    contents = valid;
+    uint32_t length = 12;
+    memcpy(&contents[lengths_pos], &length, sizeof(length));
+    CHECK(!accepted(path, contents));
+
+    // Posição fora do blob
+    contents = valid;
+    uint64_t offset = 1000;
+    memcpy(&contents[offsets_pos + sizeof(uint64_t)], &offset, sizeof(offset));
+    CHECK(!accepted(path, contents));
+
+    // Arquivo truncado no meio do blob
+    contents = valid;
+    contents.resize(blob_pos + 4);
+    CHECK(!accepted(path, contents));
+
+    // Magic diferente
+    contents = valid;
+    contents[0] = 'X';
+    CHECK(!accepted(path, contents));
+
+    unlink(path.c_str());
+    rmdir(directory);
+
+    if (failures > 0) {
+        fprintf(stderr, "%d verificações falharam\n", failures);
+        return 1;
+    }
+    printf("Arquivo de corpus: todas as verificações passaram\n");
+    return 0;
+}
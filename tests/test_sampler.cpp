@@ -0,0 +1,268 @@
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <deque>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+#include "backend.h"
+#include "lib_gentexts.h"
+#include "sampler.h"
+
+using namespace std;
+
+static const int TEST_CORPUS_TEXTS = 50;
+static const int TEST_REFRESHED_TEXTS = 20;
+static const uint64_t TEST_SEED = 7;
+static const int TEST_SHUFFLE_CYCLES = 200;
+static const int TEST_NO_REPEAT_DRAWS = 100000;
+static const int TEST_WEIGHTED_DRAWS = 20000000;
+// Desvio relativo máximo da frequência de cada texto em relação ao seu peso
+static const double TEST_WEIGHTED_TOLERANCE = 0.01;
+
+static int failures = 0;
+
+#define CHECK(condition)                                                         \
+    do {                                                                         \
+        if (!(condition)) {                                                      \
+            fprintf(stderr, "%s:%d: falhou: %s\n", __FILE__, __LINE__, #condition); \
+            failures++;                                                          \
+        }                                                                        \
+    } while (0)
+
+
+/**
+ * Corpus pequeno gerado pelo plugin gentexts, procurado no diretório do executável (como nos benchmarks).
+ */
+static bool setup_corpus() {
+    backend_set_seed(TEST_SEED);
+    backend_init();
+    backend_configure_corpus(TEST_CORPUS_TEXTS, 0);
+
+    char exe[PATH_MAX];
+    ssize_t length = readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+    if (length <= 0) {
+        return false;
+    }
+    string directory(exe, static_cast<size_t>(length));
+    directory.resize(directory.rfind('/') + 1);
+    if (backend_scan_generators(directory.c_str()) == 0 || !backend_select_generator("gentexts")) {
+        return false;
+    }
+    return get_corpus_count() == static_cast<size_t>(TEST_CORPUS_TEXTS);
+}
+
+
+/**
+ * Cada ciclo de n sorteios é uma permutação, e o primeiro de um ciclo não repete o último do anterior.
+ */
+static void test_shuffle_bag() {
+    size_t n = get_corpus_count();
+    sampler_config config;
+    config.mode = SAMPLER_SHUFFLE_BAG;
+    config.seed = 3;
+    text_sampler* sampler = sampler_create(&config);
+    CHECK(sampler);
+    if (!sampler) {
+        return;
+    }
+    uint32_t previous = UINT32_MAX;
+    for (int cycle = 0; cycle < TEST_SHUFFLE_CYCLES; cycle++) {
+        vector<bool> seen(n, false);
+        for (size_t i = 0; i < n; i++) {
+            uint32_t index;
+            CHECK(sampler_next_index(sampler, &index));
+            CHECK(index < n);
+            if (index >= n) {
+                continue;
+            }
+            CHECK(!seen[index]);
+            if (i == 0) {
+                CHECK(index != previous);
+            }
+            seen[index] = true;
+            previous = index;
+        }
+    }
+    sampler_destroy(sampler);
+}
+
+
+/**
+ * Nenhum texto se repete dentro da janela (limitada a n - 1), e todos continuam sendo sorteados.
+ */
+static void test_no_repeat() {
+    size_t n = get_corpus_count();
+    for (size_t window : {size_t(1), size_t(10), n - 1, 2 * n}) {
+        sampler_config config;
+        config.mode = SAMPLER_NO_REPEAT;
+        config.window = window;
+        config.seed = 5;
+        text_sampler* sampler = sampler_create(&config);
+        CHECK(sampler);
+        if (!sampler) {
+            continue;
+        }
+        size_t effective = min(window, n - 1);
+        deque<uint32_t> recent;
+        vector<int> counts(n, 0);
+        for (int i = 0; i < TEST_NO_REPEAT_DRAWS; i++) {
+            uint32_t index;
+            CHECK(sampler_next_index(sampler, &index));
+            if (index >= n) {
+                CHECK(index < n);
+                continue;
+            }
+            CHECK(find(recent.begin(), recent.end(), index) == recent.end());
+            recent.push_back(index);
+            if (recent.size() > effective) {
+                recent.pop_front();
+            }
+            counts[index]++;
+        }
+        CHECK(*min_element(counts.begin(), counts.end()) > 0);
+        sampler_destroy(sampler);
+    }
+}
+
+
+static double test_weight(uint32_t index) {
+    return index % 5 == 0 ? 0.0 : static_cast<double>(index % 7 + 1);
+}
+
+
+/**
+ * Frequências proporcionais aos pesos (textos de peso 0 nunca saem); todos os pesos 0 ou nenhuma
+ * função de peso são erros.
+ */
+static void test_weighted() {
+    size_t n = get_corpus_count();
+    sampler_config config;
+    config.mode = SAMPLER_WEIGHTED;
+    config.seed = 9;
+    config.weight = [](uint32_t index, text_view) { return test_weight(index); };
+    text_sampler* sampler = sampler_create(&config);
+    CHECK(sampler);
+    if (sampler) {
+        vector<double> counts(n, 0.0);
+        for (int i = 0; i < TEST_WEIGHTED_DRAWS; i++) {
+            uint32_t index;
+            CHECK(sampler_next_index(sampler, &index));
+            if (index < n) {
+                counts[index]++;
+            }
+        }
+        double total = 0;
+        for (size_t i = 0; i < n; i++) {
+            total += test_weight(static_cast<uint32_t>(i));
+        }
+        for (size_t i = 0; i < n; i++) {
+            double expected = test_weight(static_cast<uint32_t>(i)) / total * TEST_WEIGHTED_DRAWS;
+            if (expected == 0) {
+                CHECK(counts[i] == 0);
+            } else {
+                CHECK(fabs(counts[i] - expected) / expected < TEST_WEIGHTED_TOLERANCE);
+            }
+        }
+        sampler_destroy(sampler);
+    }
+
+    config.weight = [](uint32_t, text_view) { return 0.0; };
+    sampler = sampler_create(&config);
+    CHECK(sampler);
+    if (sampler) {
+        uint32_t index;
+        CHECK(!sampler_next_index(sampler, &index));
+        sampler_destroy(sampler);
+    }
+
+    config.weight = nullptr;
+    CHECK(sampler_create(&config) == nullptr);
+}
+
+
+/**
+ * A mesma semente dá a mesma sequência.
+ */
+static void test_reproducible() {
+    sampler_config config;
+    config.mode = SAMPLER_NO_REPEAT;
+    config.window = 5;
+    config.seed = 42;
+    text_sampler* first = sampler_create(&config);
+    text_sampler* second = sampler_create(&config);
+    CHECK(first && second);
+    if (first && second) {
+        uint32_t a[100];
+        uint32_t b[100];
+        CHECK(sampler_next_indices(first, 100, a) == 100);
+        CHECK(sampler_next_indices(second, 100, b) == 100);
+        CHECK(equal(a, a + 100, b));
+    }
+    sampler_destroy(first);
+    sampler_destroy(second);
+}
+
+
+/**
+ * Com o corpus trocado (backend_refresh_corpus), o estado é refeito: só saem índices do novo corpus.
+ * Executado por último, pois reduz o corpus.
+ */
+static void test_rebuild_on_refresh() {
+    for (sampler_mode mode : {SAMPLER_SHUFFLE_BAG, SAMPLER_NO_REPEAT, SAMPLER_WEIGHTED}) {
+        backend_configure_corpus(TEST_CORPUS_TEXTS, 0);
+        CHECK(backend_refresh_corpus());
+        sampler_config config;
+        config.mode = mode;
+        config.window = 30;
+        config.weight = [](uint32_t index, text_view) { return static_cast<double>(index + 1); };
+        text_sampler* sampler = sampler_create(&config);
+        CHECK(sampler);
+        if (!sampler) {
+            continue;
+        }
+        uint32_t index;
+        CHECK(sampler_next_index(sampler, &index));
+
+        backend_configure_corpus(TEST_REFRESHED_TEXTS, 0);
+        CHECK(backend_refresh_corpus());
+        CHECK(get_corpus_count() == static_cast<size_t>(TEST_REFRESHED_TEXTS));
+        vector<bool> seen(TEST_REFRESHED_TEXTS, false);
+        for (int i = 0; i < 100 * TEST_REFRESHED_TEXTS; i++) {
+            CHECK(sampler_next_index(sampler, &index));
+            CHECK(index < static_cast<uint32_t>(TEST_REFRESHED_TEXTS));
+            if (index < static_cast<uint32_t>(TEST_REFRESHED_TEXTS)) {
+                seen[index] = true;
+            }
+        }
+        CHECK(count(seen.begin(), seen.end(), true) == TEST_REFRESHED_TEXTS);
+        char buffer[GENTEXTS_MAX_TEXT_BYTES];
+        CHECK(sampler_next_into(sampler, buffer, sizeof(buffer)) > 0);
+        text_view view;
+        CHECK(sampler_next_view(sampler, &view));
+        sampler_destroy(sampler);
+    }
+}
+
+
+int main() {
+    if (!setup_corpus()) {
+        fprintf(stderr, "Corpus de teste indisponível (plugin gentexts no diretório do executável)\n");
+        return 1;
+    }
+    test_shuffle_bag();
+    test_no_repeat();
+    test_weighted();
+    test_reproducible();
+    test_rebuild_on_refresh();
+    backend_cleanup();
+
+    if (failures > 0) {
+        fprintf(stderr, "%d verificações falharam\n", failures);
+        return 1;
+    }
+    printf("Amostradores: todas as verificações passaram\n");
+    return 0;
+}
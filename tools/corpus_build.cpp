@@ -0,0 +1,42 @@
+#include <iostream>
+#include <cstdlib>
+
+#include "backend.h"
+
+using namespace std;
+
+/**
+ * Gera um corpus e o grava no formato binário mapeável (ver backend/corpus_file.h).
+ *
+ * Uso: corpus_build <arquivo> [num_textos] [semente] [threads]
+ * - num_textos: 0 usa o padrão da biblioteca
+ * - semente: a mesma semente produz o mesmo corpus
+ * - threads: 0 usa todos os processadores (o resultado não depende da quantidade)
+ *
+ * O arquivo gerado pode ser carregado pela aplicação com a variável GENTEXTS_CORPUS_FILE.
+ */
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argc > 5) {
+        cerr << "Uso: " << argv[0] << " <arquivo> [num_textos] [semente] [threads]" << endl;
+        return 1;
+    }
+
+    int num_texts = argc > 2 ? atoi(argv[2]) : 0;
+    uint64_t seed = argc > 3 ? strtoull(argv[3], nullptr, 10) : 0;
+    int num_threads = argc > 4 ? atoi(argv[4]) : 0;
+
+    backend_set_seed(seed);
+    backend_init();
+    backend_configure_corpus(num_texts, num_threads);
+
+    size_t count = get_corpus_count();
+    if (count == 0 || !backend_save_corpus_file(argv[1])) {
+        cerr << "Falha ao gerar ou gravar o corpus" << endl;
+        backend_cleanup();
+        return 1;
+    }
+
+    cout << "Corpus com " << count << " textos gravado em " << argv[1] << endl;
+    backend_cleanup();
+    return 0;
+}
@@ -0,0 +1,329 @@
+#include <iostream>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "scheduler.h"
+
+using namespace std;
+
+struct load_options {
+    string unix_path;
+    string tcp_host;
+    int tcp_port = 0;
+    int connections = 8;
+    int threads = 0;
+    int depth = 16;             // Requisições em voo por conexão (pipelining)
+    int batch = 1;              // n de "TEXT <n>"
+    bool time = false;          // Pede TIME em vez de textos
+    double seconds = 5.0;
+};
+
+struct load_conn {
+    int fd = -1;
+    string out;                 // Requisições ainda não enviadas
+    vector<int64_t> sent_at;    // Instante de envio das requisições em voo (fila circular)
+    size_t head = 0;
+    size_t inflight = 0;
+    string header;              // Linha de cabeçalho da resposta atual, se chegou incompleta
+    size_t remaining = 0;       // Linhas de texto que faltam na resposta atual
+    bool writable_wait = false;
+};
+
+struct load_result {
+    vector<uint32_t> latencies_ns;
+    uint64_t texts = 0;
+    uint64_t bytes = 0;
+    uint64_t errors = 0;
+    bool failed = false;
+};
+
+
+static int connect_server(const load_options& options) {
+    int fd;
+    if (!options.unix_path.empty()) {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, options.unix_path.c_str(), sizeof(addr.sun_path) - 1);
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            close(fd);
+            fd = -1;
+        }
+    } else {
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(options.tcp_port));
+        inet_pton(AF_INET, options.tcp_host.c_str(), &addr.sin_addr);
+        fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            close(fd);
+            fd = -1;
+        }
+        if (fd >= 0) {
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        }
+    }
+    if (fd < 0) {
+        cerr << "Erro ao conectar ao servidor: " << strerror(errno) << endl;
+    }
+    return fd;
+}
+
+
+static void queue_request(load_conn& conn, const string& request, int64_t now) {
+    conn.out += request;
+    conn.sent_at[(conn.head + conn.inflight) % conn.sent_at.size()] = now;
+    conn.inflight++;
+}
+
+
+static bool flush_requests(load_conn& conn) {
+    while (!conn.out.empty()) {
+        ssize_t sent = send(conn.fd, conn.out.data(), conn.out.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        conn.out.erase(0, static_cast<size_t>(sent));
+    }
+    return true;
+}
+
+
+/**
+ * Consome as respostas recebidas, registrando a latência de cada uma completa.
+ * Retorna quantas respostas terminaram.
+ */
+static size_t consume(load_conn& conn, const char* data, size_t length, int64_t now, load_result& result) {
+    size_t completed = 0;
+    const char* end = data + length;
+    while (data < end) {
+        const char* newline = static_cast<const char*>(memchr(data, '\n', static_cast<size_t>(end - data)));
+        if (!newline) {
+            if (conn.remaining == 0) {
+                conn.header.append(data, static_cast<size_t>(end - data));
+            }
+            break;
+        }
+        bool done = false;
+        if (conn.remaining == 0) {
+            conn.header.append(data, static_cast<size_t>(newline - data));
+            if (conn.header[0] == '*') {
+                conn.remaining = strtoull(conn.header.c_str() + 1, nullptr, 10);
+                result.texts += conn.remaining;
+                done = conn.remaining == 0;
+            } else {
+                result.errors += conn.header[0] == '-';
+                done = true;
+            }
+            conn.header.clear();
+        } else {
+            done = --conn.remaining == 0;
+        }
+        data = newline + 1;
+        if (done && conn.inflight > 0) {
+            int64_t latency = now - conn.sent_at[conn.head];
+            result.latencies_ns.push_back(static_cast<uint32_t>(min<int64_t>(latency, UINT32_MAX)));
+            conn.head = (conn.head + 1) % conn.sent_at.size();
+            conn.inflight--;
+            completed++;
+        }
+    }
+    return completed;
+}
+
+
+/**
+ * Uma thread do gerador: mantém `depth` requisições em voo em cada uma das suas conexões
+ * e repõe uma requisição a cada resposta completa, até o fim do tempo.
+ */
+static void run_client(const load_options& options, int connections, int64_t deadline, load_result* result) {
+    string request = options.time ? "TIME\n" : (options.batch == 1 ? "TEXT\n" : "TEXT " + to_string(options.batch) + "\n");
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    vector<load_conn> conns(static_cast<size_t>(connections));
+    int64_t now = monotonic_now_ns();
+    for (size_t i = 0; i < conns.size(); i++) {
+        load_conn& conn = conns[i];
+        conn.fd = connect_server(options);
+        if (conn.fd < 0) {
+            result->failed = true;
+            continue;
+        }
+        conn.sent_at.resize(static_cast<size_t>(options.depth));
+        for (int j = 0; j < options.depth; j++) {
+            queue_request(conn, request, now);
+        }
+        flush_requests(conn);
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = i;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, conn.fd, &event);
+    }
+
+    vector<char> buffer(256 * 1024);
+    epoll_event events[64];
+    while (!result->failed && (now = monotonic_now_ns()) < deadline) {
+        int wait_ms = static_cast<int>((deadline - now) / 1000000) + 1;
+        int ready = epoll_wait(epoll_fd, events, 64, wait_ms);
+        if (ready < 0 && errno != EINTR) {
+            result->failed = true;
+            break;
+        }
+        for (int i = 0; i < ready; i++) {
+            load_conn& conn = conns[events[i].data.u64];
+            ssize_t received = recv(conn.fd, buffer.data(), buffer.size(), MSG_DONTWAIT);
+            if (received == 0 || (received < 0 && errno != EAGAIN && errno != EINTR)) {
+                cerr << "Conexão encerrada pelo servidor" << endl;
+                result->failed = true;
+                break;
+            }
+            if (received < 0) {
+                received = 0;
+            }
+            now = monotonic_now_ns();
+            result->bytes += static_cast<uint64_t>(received);
+            size_t completed = consume(conn, buffer.data(), static_cast<size_t>(received), now, *result);
+            for (size_t j = 0; j < completed && now < deadline; j++) {
+                queue_request(conn, request, now);
+            }
+            flush_requests(conn);
+            // Requisições que não couberam no socket: espera ele aceitar mais
+            bool wait_write = !conn.out.empty();
+            if (wait_write != conn.writable_wait) {
+                epoll_event event{};
+                event.events = EPOLLIN | (wait_write ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+                event.data.u64 = events[i].data.u64;
+                epoll_ctl(epoll_fd, EPOLL_CTL_MOD, conn.fd, &event);
+                conn.writable_wait = wait_write;
+            }
+        }
+    }
+
+    for (load_conn& conn : conns) {
+        if (conn.fd >= 0) {
+            close(conn.fd);
+        }
+    }
+    close(epoll_fd);
+}
+
+
+static void usage(const char* program) {
+    cerr << "Uso: " << program << " (--unix <caminho> | --tcp <ip>:<porta>) [--connections <n>] [--threads <n>]"
+         << " [--depth <n>] [--batch <n>] [--seconds <s>] [--time]" << endl;
+}
+
+
+/**
+ * Gerador de carga do servidor de textos (text_server): abre várias conexões, mantém várias requisições
+ * em voo em cada uma e informa a vazão (requisições, textos e bytes por segundo) e os percentis da
+ * latência de cada requisição, do envio ao fim da resposta.
+ */
+int main(int argc, char* argv[]) {
+    load_options options;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--time") {
+            options.time = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        const char* value = argv[++i];
+        if (arg == "--unix") {
+            options.unix_path = value;
+        } else if (arg == "--tcp") {
+            const char* colon = strrchr(value, ':');
+            if (!colon) {
+                usage(argv[0]);
+                return 1;
+            }
+            options.tcp_host.assign(value, static_cast<size_t>(colon - value));
+            options.tcp_port = atoi(colon + 1);
+        } else if (arg == "--connections") {
+            options.connections = max(1, atoi(value));
+        } else if (arg == "--threads") {
+            options.threads = atoi(value);
+        } else if (arg == "--depth") {
+            options.depth = max(1, atoi(value));
+        } else if (arg == "--batch") {
+            options.batch = max(1, atoi(value));
+        } else if (arg == "--seconds") {
+            options.seconds = atof(value);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (options.unix_path.empty() == options.tcp_host.empty()) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (options.threads <= 0) {
+        options.threads = static_cast<int>(max(1u, thread::hardware_concurrency()));
+    }
+    options.threads = min(options.threads, options.connections);
+
+    int64_t start = monotonic_now_ns();
+    int64_t deadline = start + static_cast<int64_t>(options.seconds * 1e9);
+    vector<load_result> results(static_cast<size_t>(options.threads));
+    vector<thread> threads;
+    for (int i = 0; i < options.threads; i++) {
+        // Conexões distribuídas entre as threads o mais igualmente possível
+        int connections = options.connections / options.threads + (i < options.connections % options.threads);
+        threads.emplace_back(run_client, cref(options), connections, deadline, &results[static_cast<size_t>(i)]);
+    }
+    for (thread& runner : threads) {
+        runner.join();
+    }
+    double elapsed = static_cast<double>(monotonic_now_ns() - start) / 1e9;
+
+    vector<uint32_t> latencies;
+    uint64_t texts = 0;
+    uint64_t bytes = 0;
+    uint64_t errors = 0;
+    bool failed = false;
+    for (load_result& result : results) {
+        latencies.insert(latencies.end(), result.latencies_ns.begin(), result.latencies_ns.end());
+        texts += result.texts;
+        bytes += result.bytes;
+        errors += result.errors;
+        failed = failed || result.failed;
+    }
+    if (latencies.empty()) {
+        cerr << "Nenhuma resposta recebida" << endl;
+        return 1;
+    }
+    sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p) {
+        return latencies[min(latencies.size() - 1, static_cast<size_t>(p * static_cast<double>(latencies.size())))] / 1e3;
+    };
+
+    printf("%d conexões em %d threads, %d em voo por conexão, %s\n", options.connections, options.threads,
+           options.depth, options.time ? "TIME" : ("TEXT " + to_string(options.batch)).c_str());
+    printf("requisições: %zu (%.0f/s), textos: %llu (%.0f/s), %.1f MB/s, erros: %llu\n", latencies.size(),
+           static_cast<double>(latencies.size()) / elapsed, static_cast<unsigned long long>(texts),
+           static_cast<double>(texts) / elapsed, static_cast<double>(bytes) / elapsed / 1e6,
+           static_cast<unsigned long long>(errors));
+    printf("latência (us): p50 %.1f  p90 %.1f  p99 %.1f  p99.9 %.1f  max %.1f\n", percentile(0.50),
+           percentile(0.90), percentile(0.99), percentile(0.999), latencies.back() / 1e3);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,164 @@
+#include <iostream>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <pthread.h>
+
+#include "backend.h"
+#include "text_server.h"
+#include "trace.h"
+#include "metrics.h"
+
+using namespace std;
+
+// Nome do socket padrão, criado em $XDG_RUNTIME_DIR (privado do usuário) e não em /tmp
+static const char* DEFAULT_UNIX_NAME = "/gentexts.sock";
+
+static void usage(const char* program) {
+    cerr << "Uso: " << program << " [--unix <caminho>] [--tcp <ip>:<porta>] [--threads <n>] [--texts <n>]"
+         << " [--generators <diretório>] [--time-ttl <ms>] [--max-batch <n>]" << endl;
+}
+
+
+/**
+ * Serviço de textos sem interface gráfica: atende sorteios (unitários e em lote) e o horário remoto
+ * por socket Unix e/ou TCP (protocolo em backend/text_server.h), até receber SIGINT ou SIGTERM.
+ *
+ * - --unix: socket Unix (padrão $XDG_RUNTIME_DIR/gentexts.sock quando nenhum socket é informado)
+ * - --tcp: endereço IPv4 e porta TCP (porta 0 = escolhida pelo sistema)
+ * - --threads: threads de trabalho (0 = processadores)
+ * - --texts: tamanho do corpus gerado (0 = padrão da biblioteca)
+ * - --generators: diretório com os geradores (.so); usa o "gentexts" dele em vez de ../lib/libgentexts.so
+ * - --time-ttl: intervalo de sincronização do relógio remoto; 0 desativa TIME (sem acesso à rede)
+ *
+ * Também lê GENTEXTS_CORPUS_FILE, GENTEXTS_CORPUS_PACKED e GENTEXTS_TRACE, como o frontend.
+ */
+int main(int argc, char* argv[]) {
+    text_server_config config;
+    string tcp_host;
+    int num_texts = 0;
+    int64_t time_ttl_ms = 60000;
+    const char* generators = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        const char* value = argv[++i];
+        if (strcmp(argv[i - 1], "--unix") == 0) {
+            config.unix_path = value;
+        } else if (strcmp(argv[i - 1], "--tcp") == 0) {
+            const char* colon = strrchr(value, ':');
+            if (!colon) {
+                usage(argv[0]);
+                return 1;
+            }
+            tcp_host.assign(value, static_cast<size_t>(colon - value));
+            config.tcp_port = atoi(colon + 1);
+        } else if (strcmp(argv[i - 1], "--threads") == 0) {
+            config.threads = atoi(value);
+        } else if (strcmp(argv[i - 1], "--texts") == 0) {
+            num_texts = atoi(value);
+        } else if (strcmp(argv[i - 1], "--generators") == 0) {
+            generators = value;
+        } else if (strcmp(argv[i - 1], "--time-ttl") == 0) {
+            time_ttl_ms = atoll(value);
+        } else if (strcmp(argv[i - 1], "--max-batch") == 0) {
+            config.max_batch = static_cast<size_t>(strtoull(value, nullptr, 10));
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (!tcp_host.empty()) {
+        config.tcp_host = tcp_host.c_str();
+    }
+    string default_unix_path;
+    if (!config.unix_path && !config.tcp_host) {
+        const char* runtime_dir = getenv("XDG_RUNTIME_DIR");
+        if (!runtime_dir || !*runtime_dir) {
+            cerr << "XDG_RUNTIME_DIR não definido: informe --unix <caminho> ou --tcp <ip>:<porta>" << endl;
+            return 1;
+        }
+        default_unix_path = string(runtime_dir) + DEFAULT_UNIX_NAME;
+        config.unix_path = default_unix_path.c_str();
+    }
+
+    const char* trace_file = getenv("GENTEXTS_TRACE");
+    if (trace_file) {
+        trace_set_thread_name("main");
+        trace_enable(true);
+    }
+
+    // Os sinais de término são bloqueados antes de criar as threads (que herdam a máscara)
+    // e esperados com sigwait na thread principal
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    backend_init();
+
+    // Métricas no formato do Prometheus: atendidas em um socket Unix durante a execução e/ou gravadas
+    // em arquivo ao encerrar
+    const char* metrics_socket = getenv("GENTEXTS_METRICS_SOCKET");
+    if (metrics_socket) {
+        metrics_serve_start(metrics_socket);
+    }
+
+    backend_configure_corpus(num_texts, 0);
+    if (const char* corpus_file = getenv("GENTEXTS_CORPUS_FILE")) {
+        backend_configure_corpus_file(corpus_file);
+    }
+    if (const char* packed = getenv("GENTEXTS_CORPUS_PACKED")) {
+        backend_configure_corpus_packing(packed[0] == '1');
+    }
+    if (generators && backend_scan_generators(generators) > 0) {
+        backend_select_generator("gentexts");
+    }
+    if (time_ttl_ms > 0 && !backend_start_time_service(time_ttl_ms)) {
+        cerr << "Relógio remoto não sincronizou: TIME responde com erro até a próxima sincronização" << endl;
+    }
+
+    text_server* server = text_server_start(&config);
+    if (!server) {
+        backend_cleanup();
+        if (metrics_socket) {
+            metrics_serve_stop();
+        }
+        return 1;
+    }
+    cout << "Servidor de textos com " << get_corpus_count() << " textos";
+    if (config.unix_path) {
+        cout << " em " << config.unix_path;
+    }
+    if (config.tcp_host) {
+        cout << " em " << config.tcp_host << ":" << text_server_tcp_port(server);
+    }
+    cout << endl;
+
+    int signal_number = 0;
+    sigwait(&signals, &signal_number);
+
+    text_server_stats stats;
+    text_server_get_stats(server, &stats);
+    text_server_stop(server);
+    cout << "Encerrado (" << strsignal(signal_number) << "): " << stats.connections << " conexões, " << stats.requests
+         << " requisições, " << stats.texts << " textos, " << stats.errors << " erros" << endl;
+
+    backend_cleanup();
+    if (metrics_socket) {
+        metrics_serve_stop();
+    }
+    if (const char* metrics_file = getenv("GENTEXTS_METRICS_FILE")) {
+        metrics_write_file(metrics_file);
+    }
+    if (trace_file) {
+        trace_enable(false);
+        trace_export_chrome(trace_file);
+    }
+    return 0;
+}